@@ -0,0 +1,1214 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <stdio.h>   /* printf, fprintf, fopen */
+#include <stdlib.h>  /* malloc, free, qsort, strtoul */
+#include <string.h>  /* strcmp, strlen */
+#include <math.h>    /* fabs, frexp, ldexp */
+#include <time.h>    /* clock_gettime */
+#include <unistd.h>  /* sysconf */
+
+#include "calculator.h"
+#include "number.h"
+#include "lexer.h"
+#include "kernels.h"
+#include "expr_gen.h"
+
+#define DEFAULT_ROUNDS 5
+#define LEX_BLOCK 64
+#define INCREMENTAL_SIZES 4
+#define INCREMENTAL_EVALS 200   /* per round */
+#define KERNEL_VALUES 4096
+#define GRADIENT_EVALS 200      /* per round */
+#define GRADIENT_ROWS 256
+
+typedef struct bench_state
+{
+    const expr_corpus_t* corpus;
+    calc_ctx_t* ctx;
+    calc_program_t** programs;
+    calc_eval_func_t* jitted;
+} bench_state_t;
+
+typedef int (*bench_setup_func)(bench_state_t*);
+typedef status_t (*bench_call_func)(bench_state_t*, size_t);
+typedef void (*bench_teardown_func)(bench_state_t*);
+
+typedef struct bench_case
+{
+    const char* name;
+    bench_setup_func setup;
+    bench_call_func call;
+    bench_teardown_func teardown;
+} bench_case_t;
+
+typedef struct bench_result
+{
+    double exprs_per_sec;
+    double ns_per_byte;
+    double p50_ns;
+    double p99_ns;
+    double p999_ns;
+    size_t errors;
+} bench_result_t;
+
+static double NowNs(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec * 1e9 + now.tv_nsec;
+}
+
+static int NoSetup(bench_state_t* state)
+{
+    (void)state;
+
+    return 1;
+}
+
+static void NoTeardown(bench_state_t* state)
+{
+    (void)state;
+}
+
+static status_t CallCalculate(bench_state_t* state, size_t index)
+{
+    double ans = 0;
+
+    return Calculate(state->corpus->exprs[index], &ans);
+}
+
+static status_t CallCalculateExact(bench_state_t* state, size_t index)
+{
+    calc_number_t ans;
+
+    return CalculateExact(state->corpus->exprs[index], &ans);
+}
+
+static int SetupCtx(bench_state_t* state)
+{
+    state->ctx = CalcCtxCreate(NULL);
+
+    return NULL != state->ctx;
+}
+
+static status_t CallCalculateCtx(bench_state_t* state, size_t index)
+{
+    double ans = 0;
+
+    return CalculateCtx(state->ctx, state->corpus->exprs[index], &ans);
+}
+
+static void TeardownCtx(bench_state_t* state)
+{
+    CalcCtxDestroy(state->ctx);
+    state->ctx = NULL;
+}
+
+static status_t CallCompile(bench_state_t* state, size_t index)
+{
+    calc_program_t* program = NULL;
+    status_t status = CalcCompile(state->corpus->exprs[index], &program);
+
+    CalcProgramDestroy(program);
+
+    return status;
+}
+
+static void TeardownPrograms(bench_state_t* state)
+{
+    size_t i = 0;
+
+    for( ; NULL != state->programs && i < state->corpus->count; ++i)
+    {
+        CalcProgramDestroy(state->programs[i]);
+    }
+
+    free(state->programs);
+    state->programs = NULL;
+}
+
+static int SetupPrograms(bench_state_t* state)
+{
+    size_t i = 0;
+
+    state->programs = (calc_program_t**)calloc(state->corpus->count,
+                                                    sizeof(calc_program_t*));
+    if(NULL == state->programs)
+    {
+        return 0;
+    }
+
+    for( ; i < state->corpus->count; ++i)
+    {
+        if(FAILED_ALLOCATION == CalcCompile(state->corpus->exprs[i],
+                                                        &state->programs[i]))
+        {
+            TeardownPrograms(state);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static int SetupOptimizedPrograms(bench_state_t* state)
+{
+    size_t i = 0;
+
+    if(!SetupPrograms(state))
+    {
+        return 0;
+    }
+
+    for( ; i < state->corpus->count; ++i)
+    {
+        if(NULL != state->programs[i] &&
+            FAILED_ALLOCATION == CalcOptimize(state->programs[i], NULL))
+        {
+            TeardownPrograms(state);
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+static status_t CallEval(bench_state_t* state, size_t index)
+{
+    double ans = 0;
+
+    if(NULL == state->programs[index])
+    {
+        return INVALID_SYNTAX;
+    }
+
+    return CalcEval(state->programs[index], &ans);
+}
+
+static int SetupJit(bench_state_t* state)
+{
+    size_t i = 0;
+
+    if(!SetupOptimizedPrograms(state))
+    {
+        return 0;
+    }
+
+    state->jitted = (calc_eval_func_t*)malloc(state->corpus->count *
+                                                    sizeof(calc_eval_func_t));
+    if(NULL == state->jitted)
+    {
+        TeardownPrograms(state);
+        return 0;
+    }
+
+    for( ; i < state->corpus->count; ++i)
+    {
+        state->jitted[i] = NULL != state->programs[i] ?
+                                        CalcJit(state->programs[i]) : NULL;
+    }
+
+    return 1;
+}
+
+static status_t CallJit(bench_state_t* state, size_t index)
+{
+    double ans = 0;
+
+    if(NULL == state->jitted[index])
+    {
+        return INVALID_SYNTAX;
+    }
+
+    return state->jitted[index](state->programs[index], &ans);
+}
+
+static void TeardownJit(bench_state_t* state)
+{
+    free(state->jitted);
+    state->jitted = NULL;
+    TeardownPrograms(state);
+}
+
+static status_t CallLex(bench_state_t* state, size_t index)
+{
+    token_t tokens[LEX_BLOCK];
+    lexer_t lexer;
+    const char* expr = state->corpus->exprs[index];
+
+    LexerInit(&lexer, expr, strlen(expr));
+    while(0 != LexerNext(&lexer, tokens, LEX_BLOCK))
+    {
+    }
+
+    return SUCCESS;
+}
+
+static status_t CallValidate(bench_state_t* state, size_t index)
+{
+    const char* expr = state->corpus->exprs[index];
+
+    return CALC_VALID == CalcValidate(expr, strlen(expr)) ? SUCCESS :
+                                                            INVALID_SYNTAX;
+}
+
+static const bench_case_t bench_cases[] =
+{
+    {"lex", NoSetup, CallLex, NoTeardown},
+    {"validate", NoSetup, CallValidate, NoTeardown},
+    {"calculate", NoSetup, CallCalculate, NoTeardown},
+    {"calculate_exact", NoSetup, CallCalculateExact, NoTeardown},
+    {"calculate_ctx", SetupCtx, CallCalculateCtx, TeardownCtx},
+    {"compile", NoSetup, CallCompile, NoTeardown},
+    {"eval", SetupPrograms, CallEval, TeardownPrograms},
+    {"eval_optimized", SetupOptimizedPrograms, CallEval, TeardownPrograms},
+    {"jit", SetupJit, CallJit, TeardownJit}
+};
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+static double Percentile(const double* sorted, size_t count, double fraction)
+{
+    size_t index = (size_t)(fraction * (count - 1) + 0.5);
+
+    return sorted[index];
+}
+
+static int RunCase(const bench_case_t* bench_case, bench_state_t* state,
+                                    size_t rounds, bench_result_t* result)
+{
+    size_t count = state->corpus->count;
+    double* latencies = (double*)malloc(count * rounds * sizeof(double));
+    double start = 0;
+    double elapsed = 0;
+    size_t round = 0;
+    size_t i = 0;
+
+    if(NULL == latencies || !bench_case->setup(state))
+    {
+        free(latencies);
+        return 0;
+    }
+
+    /* warm-up, also counts the expressions the path rejects */
+    result->errors = 0;
+    for(i = 0; i < count; ++i)
+    {
+        result->errors += SUCCESS != bench_case->call(state, i);
+    }
+
+    /* throughput, without per-call timer overhead */
+    start = NowNs();
+    for(round = 0; round < rounds; ++round)
+    {
+        for(i = 0; i < count; ++i)
+        {
+            bench_case->call(state, i);
+        }
+    }
+    elapsed = NowNs() - start;
+
+    /* latency, timing every call */
+    for(round = 0; round < rounds; ++round)
+    {
+        for(i = 0; i < count; ++i)
+        {
+            start = NowNs();
+            bench_case->call(state, i);
+            latencies[round * count + i] = NowNs() - start;
+        }
+    }
+
+    bench_case->teardown(state);
+
+    qsort(latencies, count * rounds, sizeof(double), CompareDoubles);
+    result->exprs_per_sec = count * rounds / (elapsed / 1e9);
+    result->ns_per_byte = elapsed / (state->corpus->total_bytes * rounds);
+    result->p50_ns = Percentile(latencies, count * rounds, 0.5);
+    result->p99_ns = Percentile(latencies, count * rounds, 0.99);
+    result->p999_ns = Percentile(latencies, count * rounds, 0.999);
+    free(latencies);
+
+    return 1;
+}
+
+/* CalculateBatch over the whole corpus with 1 to max_threads threads */
+static int RunScaling(const expr_corpus_t* corpus, size_t rounds,
+                                            unsigned max_threads, FILE* csv)
+{
+    double* results = (double*)malloc(corpus->count * sizeof(double));
+    status_t* statuses = (status_t*)malloc(corpus->count * sizeof(status_t));
+    double start = 0;
+    double elapsed = 0;
+    double single = 0;
+    double rate = 0;
+    unsigned threads = 1;
+    size_t round = 0;
+
+    if(NULL == results || NULL == statuses)
+    {
+        free(results);
+        free(statuses);
+        return 0;
+    }
+
+    printf("%-16s %14s %10s %10s\n", "threads", "exprs/s", "ns/byte",
+                                                                "speedup");
+
+    for( ; threads <= max_threads; ++threads)
+    {
+        CalculateBatch((const char* const*)corpus->exprs, corpus->count,
+                                                results, statuses, threads);
+
+        start = NowNs();
+        for(round = 0; round < rounds; ++round)
+        {
+            CalculateBatch((const char* const*)corpus->exprs, corpus->count,
+                                                results, statuses, threads);
+        }
+        elapsed = NowNs() - start;
+
+        rate = corpus->count * rounds / (elapsed / 1e9);
+        single = 1 == threads ? rate : single;
+        printf("batch_t%-9u %14.0f %10.2f %10.2f\n", threads, rate,
+                    elapsed / (corpus->total_bytes * rounds), rate / single);
+
+        if(NULL != csv)
+        {
+            fprintf(csv, "batch_t%u,,%lu,,,%lu,%.0f,%.3f,,,,\n", threads,
+                (unsigned long)corpus->count,
+                (unsigned long)corpus->total_bytes, rate,
+                                    elapsed / (corpus->total_bytes * rounds));
+        }
+    }
+
+    free(results);
+    free(statuses);
+
+    return 1;
+}
+
+/* ParseNumber against strtod over a corpus of lone numbers */
+static int RunParse(const expr_gen_params_t* params, size_t rounds, FILE* csv)
+{
+    static const char* names[] = {"parse_number", "strtod"};
+    expr_corpus_t numbers;
+    size_t* lengths = NULL;
+    double start = 0;
+    double elapsed = 0;
+    double value = 0;
+    double expected = 0;
+    double sum = 0;
+    size_t mismatches = 0;
+    size_t round = 0;
+    size_t i = 0;
+    int parser = 0;
+
+    if(!ExprGenNumbers(params, &numbers))
+    {
+        return 0;
+    }
+
+    lengths = (size_t*)malloc(numbers.count * sizeof(size_t));
+    if(NULL == lengths)
+    {
+        ExprGenFreeCorpus(&numbers);
+        return 0;
+    }
+
+    for( ; i < numbers.count; ++i)
+    {
+        lengths[i] = strlen(numbers.exprs[i]);
+        ParseNumber(numbers.exprs[i], numbers.exprs[i] + lengths[i], &value);
+        expected = strtod(numbers.exprs[i], NULL);
+        mismatches += 0 != memcmp(&value, &expected, sizeof(double));
+    }
+
+    printf("numbers: %lu, %lu bytes, seed %lu, %lu differ from strtod\n",
+        (unsigned long)numbers.count, (unsigned long)numbers.total_bytes,
+                                params->seed, (unsigned long)mismatches);
+    printf("%-16s %14s %10s %10s\n", "parser", "numbers/s", "ns/number",
+                                                                "ns/byte");
+
+    for( ; parser < 2; ++parser)
+    {
+        start = NowNs();
+        for(round = 0; round < rounds; ++round)
+        {
+            for(i = 0; i < numbers.count; ++i)
+            {
+                if(0 == parser)
+                {
+                    ParseNumber(numbers.exprs[i],
+                                numbers.exprs[i] + lengths[i], &value);
+                }
+                else
+                {
+                    value = strtod(numbers.exprs[i], NULL);
+                }
+                sum += value;
+            }
+        }
+        elapsed = NowNs() - start;
+
+        printf("%-16s %14.0f %10.2f %10.2f\n", names[parser],
+                numbers.count * rounds / (elapsed / 1e9),
+                elapsed / (numbers.count * rounds),
+                                    elapsed / (numbers.total_bytes * rounds));
+
+        if(NULL != csv)
+        {
+            fprintf(csv, "%s,%lu,%lu,,,%lu,%.0f,%.3f,,,,%lu\n",
+                names[parser], params->seed, (unsigned long)numbers.count,
+                (unsigned long)numbers.total_bytes,
+                numbers.count * rounds / (elapsed / 1e9),
+                elapsed / (numbers.total_bytes * rounds),
+                                                (unsigned long)mismatches);
+        }
+    }
+
+    /* keeps the parsed values live */
+    if(sum != sum)
+    {
+        printf("nan in the corpus\n");
+    }
+
+    free(lengths);
+    ExprGenFreeCorpus(&numbers);
+
+    return 1;
+}
+
+/* Binds the next "changed" variables, round robin, to values that depend on
+   the evaluation so both runs see the same sequence */
+static void ChangeVariables(calc_program_t* program, size_t changed,
+                                                    size_t* next, size_t eval)
+{
+    size_t num_vars = CalcVariableCount(program);
+    size_t i = 0;
+
+    for( ; i < changed; ++i)
+    {
+        CalcSetVariableIndex(program, *next, 1 + (eval + i) % 8 * 0.125);
+        *next = *next + 1 == num_vars ? 0 : *next + 1;
+    }
+}
+
+static double TimeEvals(calc_program_t* program, size_t changed, size_t evals,
+                                                                int incremental)
+{
+    double start = NowNs();
+    double ans = 0;
+    size_t next = 0;
+    size_t eval = 0;
+
+    for( ; eval < evals; ++eval)
+    {
+        ChangeVariables(program, changed, &next, eval);
+        if(incremental)
+        {
+            CalcEvalIncremental(program, &ans);
+        }
+        else
+        {
+            CalcEval(program, &ans);
+        }
+    }
+
+    return (NowNs() - start) / evals;
+}
+
+/* CalcEvalIncremental against CalcEval on formulas of 1x, 4x, 16x and 64x
+   the length, changing a growing share of their variables before each
+   evaluation */
+static int RunIncremental(const expr_gen_params_t* params, size_t rounds,
+                                                                    FILE* csv)
+{
+    static const unsigned int percents[] = {0, 1, 10, 50, 100};
+    expr_gen_params_t formula = *params;
+    expr_corpus_t corpus;
+    calc_program_t* program = NULL;
+    size_t evals = INCREMENTAL_EVALS * rounds;
+    size_t num_vars = 0;
+    size_t changed = 0;
+    size_t mismatches = 0;
+    size_t next = 0;
+    size_t eval = 0;
+    double full = 0;
+    double incremental = 0;
+    double expected = 0;
+    double ans = 0;
+    size_t size = 0;
+    size_t i = 0;
+
+    printf("%-16s %8s %8s %8s %12s %12s %8s\n", "case", "bytes", "vars",
+                            "changed", "full ns", "incr ns", "speedup");
+
+    for( ; size < INCREMENTAL_SIZES; ++size)
+    {
+        formula.count = 1;
+        formula.length = params->length << (2 * size);
+        formula.max_length = 0;
+        formula.variables = 0 < params->variables ? params->variables :
+                                                        formula.length / 8 + 1;
+        if(!ExprGenCorpus(&formula, &corpus))
+        {
+            return 0;
+        }
+
+        if(SUCCESS != CalcCompile(corpus.exprs[0], &program))
+        {
+            ExprGenFreeCorpus(&corpus);
+            return 0;
+        }
+        num_vars = CalcVariableCount(program);
+
+        for(i = 0; i < sizeof(percents) / sizeof(percents[0]); ++i)
+        {
+            changed = num_vars * percents[i] / 100;
+            changed = 0 == changed ? 1 : changed;
+
+            /* both paths must agree on every evaluation */
+            mismatches = 0;
+            for(next = 0, eval = 0; eval < INCREMENTAL_EVALS; ++eval)
+            {
+                ChangeVariables(program, changed, &next, eval);
+                mismatches += CalcEval(program, &expected) !=
+                                CalcEvalIncremental(program, &ans) ||
+                                0 != memcmp(&expected, &ans, sizeof(double));
+            }
+
+            full = TimeEvals(program, changed, evals, 0);
+            incremental = TimeEvals(program, changed, evals, 1);
+            printf("incremental_%-4u %8lu %8lu %8lu %12.0f %12.0f %8.2f\n",
+                    percents[i], (unsigned long)corpus.total_bytes,
+                    (unsigned long)num_vars, (unsigned long)changed, full,
+                                            incremental, full / incremental);
+            if(0 != mismatches)
+            {
+                printf("  %lu results differ from CalcEval\n",
+                                                (unsigned long)mismatches);
+            }
+
+            if(NULL != csv)
+            {
+                fprintf(csv, "eval_full_%u,%lu,%lu,%lu,%lu,%lu,%.0f,%.3f,,,,"
+                    "\neval_incremental_%u,%lu,%lu,%lu,%lu,%lu,%.0f,%.3f,,,,"
+                    "%lu\n", percents[i], params->seed, (unsigned long)evals,
+                    (unsigned long)formula.length,
+                    (unsigned long)formula.max_depth,
+                    (unsigned long)corpus.total_bytes, 1e9 / full,
+                    full / corpus.total_bytes, percents[i], params->seed,
+                    (unsigned long)evals, (unsigned long)formula.length,
+                    (unsigned long)formula.max_depth,
+                    (unsigned long)corpus.total_bytes, 1e9 / incremental,
+                    incremental / corpus.total_bytes,
+                                                (unsigned long)mismatches);
+            }
+        }
+
+        CalcProgramDestroy(program);
+        ExprGenFreeCorpus(&corpus);
+    }
+
+    return 1;
+}
+
+/* The point gradients are taken at: variable i is bound to this */
+static double PointValue(size_t i)
+{
+    return 1 + i % 8 * 0.125;
+}
+
+/* |estimate - partial|, relative to the partial when it is above 1 */
+static double RelativeError(double partial, double estimate)
+{
+    return fabs(estimate - partial) / (fabs(partial) > 1 ? fabs(partial) : 1);
+}
+
+/* The partials by central differences: 2N + 1 evaluations, each variable
+   moved by h either way. Returns the status of the evaluation at the point */
+static status_t FiniteDifferences(calc_program_t* program, double* ans,
+                                                            double* gradient)
+{
+    size_t num_vars = CalcVariableCount(program);
+    double forward = 0;
+    double backward = 0;
+    double value = 0;
+    double h = 0;
+    size_t i = 0;
+    status_t status = CalcEval(program, ans);
+
+    for( ; i < num_vars && SUCCESS == status; ++i)
+    {
+        value = PointValue(i);
+        h = 1e-6 * value;
+        CalcSetVariableIndex(program, i, value + h);
+        status = CalcEval(program, &forward);
+        CalcSetVariableIndex(program, i, value - h);
+        status = SUCCESS == status ? CalcEval(program, &backward) : status;
+        CalcSetVariableIndex(program, i, value);
+        gradient[i] = (forward - backward) / (2 * h);
+    }
+
+    return status;
+}
+
+/* CalcEvalGradient and CalcEvalGradientColumns against central differences
+   on formulas of 1x, 4x, 16x and 64x the length. The error column is the
+   largest distance between the two gradients, relative to the partial */
+static int RunGradient(const expr_gen_params_t* params, size_t rounds,
+                                                                    FILE* csv)
+{
+    expr_gen_params_t formula = *params;
+    expr_corpus_t corpus;
+    calc_program_t* program = NULL;
+    double* values = NULL;
+    double* partials = NULL;
+    const double** columns = NULL;
+    double** gradients = NULL;
+    double* gradient = NULL;
+    double* estimate = NULL;
+    size_t evals = GRADIENT_EVALS * rounds;
+    size_t num_vars = 0;
+    size_t size = 0;
+    size_t eval = 0;
+    size_t i = 0;
+    double ans = 0;
+    double error = 0;
+    double start = 0;
+    double differences = 0;
+    double dual = 0;
+    double batched = 0;
+    status_t status = SUCCESS;
+
+    printf("%-16s %8s %8s %12s %12s %12s %8s %10s\n", "case", "bytes", "vars",
+                    "fd ns", "grad ns", "row ns", "speedup", "fd error");
+
+    for( ; size < INCREMENTAL_SIZES; ++size)
+    {
+        formula.count = 1;
+        formula.length = params->length << (2 * size);
+        formula.max_length = 0;
+        formula.variables = 0 < params->variables ? params->variables :
+                                                        formula.length / 8 + 1;
+        if(!ExprGenCorpus(&formula, &corpus))
+        {
+            return 0;
+        }
+
+        if(SUCCESS != CalcCompile(corpus.exprs[0], &program))
+        {
+            ExprGenFreeCorpus(&corpus);
+            return 0;
+        }
+        CalcOptimize(program, NULL);
+        num_vars = CalcVariableCount(program);
+
+        values = (double*)malloc((num_vars + 1) * GRADIENT_ROWS *
+                                                            sizeof(double));
+        partials = (double*)malloc((num_vars + 1) * GRADIENT_ROWS *
+                                                            sizeof(double));
+        columns = (const double**)malloc((num_vars + 1) * sizeof(double*));
+        gradients = (double**)malloc((num_vars + 1) * sizeof(double*));
+        gradient = (double*)malloc((num_vars + 1) * sizeof(double));
+        estimate = (double*)malloc((num_vars + 1) * sizeof(double));
+        if(NULL == values || NULL == partials || NULL == columns ||
+                NULL == gradients || NULL == gradient || NULL == estimate)
+        {
+            free(values);
+            free(partials);
+            free(columns);
+            free(gradients);
+            free(gradient);
+            free(estimate);
+            CalcProgramDestroy(program);
+            ExprGenFreeCorpus(&corpus);
+            return 0;
+        }
+
+        /* every row of the batch is the point of the single evaluations;
+           the last column of values takes the results */
+        for(i = 0; i < num_vars; ++i)
+        {
+            columns[i] = values + i * GRADIENT_ROWS;
+            gradients[i] = partials + i * GRADIENT_ROWS;
+            for(eval = 0; eval < GRADIENT_ROWS; ++eval)
+            {
+                values[i * GRADIENT_ROWS + eval] = PointValue(i);
+            }
+            CalcSetVariableIndex(program, i, PointValue(i));
+        }
+
+        status = CalcEvalGradient(program, &ans, gradient);
+        error = 0;
+        if(SUCCESS == status &&
+                        SUCCESS == FiniteDifferences(program, &ans, estimate))
+        {
+            for(i = 0; i < num_vars; ++i)
+            {
+                if(RelativeError(gradient[i], estimate[i]) > error)
+                {
+                    error = RelativeError(gradient[i], estimate[i]);
+                }
+            }
+        }
+
+        start = NowNs();
+        for(eval = 0; eval < evals; ++eval)
+        {
+            FiniteDifferences(program, &ans, estimate);
+        }
+        differences = (NowNs() - start) / evals;
+
+        start = NowNs();
+        for(eval = 0; eval < evals; ++eval)
+        {
+            CalcEvalGradient(program, &ans, gradient);
+        }
+        dual = (NowNs() - start) / evals;
+
+        start = NowNs();
+        for(eval = 0; eval < rounds; ++eval)
+        {
+            CalcEvalGradientColumns(program, columns, GRADIENT_ROWS,
+                    values + num_vars * GRADIENT_ROWS, gradients, NULL);
+        }
+        batched = (NowNs() - start) / (rounds * GRADIENT_ROWS);
+
+        printf("gradient_%-7lu %8lu %8lu %12.0f %12.0f %12.0f %8.2f %10.2g\n",
+                (unsigned long)size, (unsigned long)corpus.total_bytes,
+                (unsigned long)num_vars, differences, dual, batched,
+                                                    differences / dual, error);
+        if(SUCCESS != status)
+        {
+            printf("  the formula fails at the point\n");
+        }
+
+        if(NULL != csv)
+        {
+            fprintf(csv, "gradient_fd_%lu,%lu,%lu,%lu,%lu,%lu,%.0f,%.3f,,,,"
+                "\ngradient_dual_%lu,%lu,%lu,%lu,%lu,%lu,%.0f,%.3f,,,,\n",
+                (unsigned long)size, params->seed, (unsigned long)evals,
+                (unsigned long)formula.length,
+                (unsigned long)formula.max_depth,
+                (unsigned long)corpus.total_bytes, 1e9 / differences,
+                differences / corpus.total_bytes, (unsigned long)size,
+                params->seed, (unsigned long)evals,
+                (unsigned long)formula.length,
+                (unsigned long)formula.max_depth,
+                (unsigned long)corpus.total_bytes, 1e9 / dual,
+                                                dual / corpus.total_bytes);
+        }
+
+        free(values);
+        free(partials);
+        free(columns);
+        free(gradients);
+        free(gradient);
+        free(estimate);
+        CalcProgramDestroy(program);
+        ExprGenFreeCorpus(&corpus);
+    }
+
+    return 1;
+}
+
+/* Distance between two results in units in the last place of the first */
+static double Ulps(double expected, double actual)
+{
+    int exponent = 0;
+
+    if(expected == actual || (expected != expected && actual != actual))
+    {
+        return 0;
+    }
+
+    frexp(expected, &exponent);
+
+    return fabs(expected - actual) / ldexp(1, exponent - 53);
+}
+
+/* KernelApply at every level the CPU has against the scalar level, on
+   KERNEL_VALUES random operands per function in its usual range */
+static int RunKernels(const expr_gen_params_t* params, size_t rounds,
+                                                                    FILE* csv)
+{
+    static const char* names[NUM_OF_FUNCTIONS] =
+                            {"sqrt", "exp", "log", "sin", "cos", "min", "max"};
+    static const char* level_names[NUM_OF_KERNEL_LEVELS] =
+                                                    {"scalar", "sse2", "avx2"};
+    static const double lows[NUM_OF_FUNCTIONS] = {0, -700, 1e-300, -100,
+                                                            -100, -1, -1};
+    static const double highs[NUM_OF_FUNCTIONS] = {1e6, 700, 1e6, 100, 100,
+                                                                        1, 1};
+    double* a = NULL;
+    double* b = NULL;
+    double* expected = NULL;
+    double* results = NULL;
+    unsigned char* failed = NULL;
+    unsigned long state = 0 == params->seed ? 1 : params->seed;
+    kernel_level_t max_level = KernelSetLevel(NUM_OF_KERNEL_LEVELS);
+    kernel_level_t level = KERNEL_SCALAR;
+    double start = 0;
+    double elapsed = 0;
+    double max_ulps = 0;
+    size_t round = 0;
+    size_t i = 0;
+    int function = 0;
+
+    a = (double*)malloc(4 * KERNEL_VALUES * sizeof(double));
+    failed = (unsigned char*)malloc(KERNEL_VALUES);
+    if(NULL == a || NULL == failed)
+    {
+        free(a);
+        free(failed);
+        return 0;
+    }
+    b = a + KERNEL_VALUES;
+    expected = b + KERNEL_VALUES;
+    results = expected + KERNEL_VALUES;
+
+    printf("%-16s %8s %10s %10s\n", "case", "level", "ns/value", "max ulp");
+
+    for( ; function < NUM_OF_FUNCTIONS; ++function)
+    {
+        for(i = 0; i < 2 * KERNEL_VALUES; ++i)
+        {
+            /* xorshift32, as the corpus generator */
+            state ^= (state << 13) & 0xFFFFFFFFUL;
+            state ^= state >> 17;
+            state ^= (state << 5) & 0xFFFFFFFFUL;
+            a[i] = lows[function] + (highs[function] - lows[function]) *
+                                                (state / 4294967296.0);
+        }
+
+        KernelSetLevel(KERNEL_SCALAR);
+        memset(failed, 0, KERNEL_VALUES);
+        KernelApply((function_t)function, a, b, expected, failed,
+                                                            KERNEL_VALUES);
+
+        for(level = KERNEL_SCALAR; level <= max_level; ++level)
+        {
+            KernelSetLevel(level);
+            start = NowNs();
+            for(round = 0; round < rounds; ++round)
+            {
+                KernelApply((function_t)function, a, b, results, failed,
+                                                            KERNEL_VALUES);
+            }
+            elapsed = (NowNs() - start) / (rounds * KERNEL_VALUES);
+
+            for(max_ulps = 0, i = 0; i < KERNEL_VALUES; ++i)
+            {
+                max_ulps = Ulps(expected[i], results[i]) > max_ulps ?
+                                    Ulps(expected[i], results[i]) : max_ulps;
+            }
+
+            printf("kernel_%-9s %8s %10.2f %10.2f\n", names[function],
+                            level_names[level], elapsed, max_ulps);
+
+            if(NULL != csv)
+            {
+                fprintf(csv, "kernel_%s_%s,%lu,%lu,,,,%.0f,,,,,\n",
+                        names[function], level_names[level], params->seed,
+                        (unsigned long)KERNEL_VALUES, 1e9 / elapsed);
+            }
+        }
+    }
+
+    KernelSetLevel(max_level);
+    free(a);
+    free(failed);
+
+    return 1;
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr,
+        "usage: %s [--seed N] [--count N] [--length BYTES]\n"
+        "          [--max-length BYTES] [--depth N]\n"
+        "          [--mix +,-,*,/,^ weights e.g. 4,4,2,1,1]\n"
+        "          [--numbers int|dec|exp|mixed|precise] [--spaces PERCENT]\n"
+        "          [--rounds N] [--case NAME] [--csv FILE]\n"
+        "          [--scaling MAX_THREADS (0: online CPUs)] [--parse 1]\n"
+        "          [--lexer scalar|sse2|avx2] [--variables N]\n"
+        "          [--incremental 1] [--kernels 1] [--gradient 1]\n",
+                                                                        name);
+}
+
+static int ParseMix(const char* arg, expr_gen_params_t* params)
+{
+    char* end = NULL;
+    int op = 0;
+
+    for( ; op < NUM_OF_GEN_OPERATORS; ++op)
+    {
+        params->op_weights[op] = (unsigned int)strtoul(arg, &end, 10);
+        if(end == arg || (op + 1 < NUM_OF_GEN_OPERATORS && ',' != *end))
+        {
+            return 0;
+        }
+        arg = end + 1;
+    }
+
+    return '\0' == *end;
+}
+
+static int ParseNumbers(const char* arg, expr_gen_params_t* params)
+{
+    static const char* names[NUM_OF_NUMBER_FORMATS] = {"int", "dec", "exp",
+                                                        "mixed", "precise"};
+    int i = 0;
+
+    for( ; i < NUM_OF_NUMBER_FORMATS; ++i)
+    {
+        if(0 == strcmp(arg, names[i]))
+        {
+            params->numbers = (numbers_format_t)i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+static int ParseLexer(const char* arg, lexer_level_t* level)
+{
+    static const char* names[NUM_OF_LEXER_LEVELS] = {"scalar", "sse2", "avx2"};
+    int i = 0;
+
+    for( ; i < NUM_OF_LEXER_LEVELS; ++i)
+    {
+        if(0 == strcmp(arg, names[i]))
+        {
+            *level = (lexer_level_t)i;
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char* argv[])
+{
+    expr_gen_params_t params;
+    expr_corpus_t corpus;
+    bench_state_t state = {NULL, NULL, NULL, NULL};
+    bench_result_t result;
+    const char* only_case = NULL;
+    const char* csv_path = NULL;
+    FILE* csv = NULL;
+    size_t rounds = DEFAULT_ROUNDS;
+    lexer_level_t lexer_level = NUM_OF_LEXER_LEVELS;
+    long max_threads = -1;
+    int parse = 0;
+    int incremental = 0;
+    int kernels = 0;
+    int gradient = 0;
+    size_t i = 0;
+    int arg = 1;
+    int ok = 1;
+
+    ExprGenDefaults(&params);
+
+    for( ; arg + 1 < argc && ok; arg += 2)
+    {
+        if(0 == strcmp(argv[arg], "--seed"))
+        {
+            params.seed = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--count"))
+        {
+            params.count = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--length"))
+        {
+            params.length = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--max-length"))
+        {
+            params.max_length = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--scaling"))
+        {
+            max_threads = strtol(argv[arg + 1], NULL, 10);
+            max_threads = 0 >= max_threads ?
+                                sysconf(_SC_NPROCESSORS_ONLN) : max_threads;
+        }
+        else if(0 == strcmp(argv[arg], "--parse"))
+        {
+            parse = 0 != strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--incremental"))
+        {
+            incremental = 0 != strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--kernels"))
+        {
+            kernels = 0 != strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--gradient"))
+        {
+            gradient = 0 != strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--variables"))
+        {
+            params.variables = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--depth"))
+        {
+            params.max_depth = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--mix"))
+        {
+            ok = ParseMix(argv[arg + 1], &params);
+        }
+        else if(0 == strcmp(argv[arg], "--numbers"))
+        {
+            ok = ParseNumbers(argv[arg + 1], &params);
+        }
+        else if(0 == strcmp(argv[arg], "--spaces"))
+        {
+            params.space_percent = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--rounds"))
+        {
+            rounds = strtoul(argv[arg + 1], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--case"))
+        {
+            only_case = argv[arg + 1];
+        }
+        else if(0 == strcmp(argv[arg], "--lexer"))
+        {
+            ok = ParseLexer(argv[arg + 1], &lexer_level);
+        }
+        else if(0 == strcmp(argv[arg], "--csv"))
+        {
+            csv_path = argv[arg + 1];
+        }
+        else
+        {
+            ok = 0;
+        }
+    }
+
+    if(!ok || arg != argc || 0 == params.count || 0 == rounds)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    /* NUM_OF_LEXER_LEVELS picks the widest the CPU has */
+    if(lexer_level != LexerSetLevel(lexer_level) &&
+                                            NUM_OF_LEXER_LEVELS != lexer_level)
+    {
+        fprintf(stderr, "the CPU does not support the chosen lexer\n");
+        return 1;
+    }
+
+    if(NULL != csv_path)
+    {
+        csv = fopen(csv_path, "w");
+        if(NULL == csv)
+        {
+            perror(csv_path);
+            return 1;
+        }
+
+        fprintf(csv, "case,seed,count,length,depth,bytes,exprs_per_sec,"
+                            "ns_per_byte,p50_ns,p99_ns,p999_ns,errors\n");
+    }
+
+    if(parse || incremental || kernels || gradient)
+    {
+        ok = parse ? RunParse(&params, rounds, csv) :
+                incremental ? RunIncremental(&params, rounds, csv) :
+                gradient ? RunGradient(&params, rounds, csv) :
+                                        RunKernels(&params, rounds, csv);
+        if(NULL != csv)
+        {
+            fclose(csv);
+        }
+
+        return !ok;
+    }
+
+    if(!ExprGenCorpus(&params, &corpus))
+    {
+        fprintf(stderr, "failed to generate the corpus\n");
+        if(NULL != csv)
+        {
+            fclose(csv);
+        }
+        return 1;
+    }
+
+    if(0 < max_threads)
+    {
+        ok = RunScaling(&corpus, rounds, (unsigned)max_threads, csv);
+        if(NULL != csv)
+        {
+            fclose(csv);
+        }
+        ExprGenFreeCorpus(&corpus);
+
+        return !ok;
+    }
+
+    state.corpus = &corpus;
+    printf("corpus: %lu expressions, %lu bytes, seed %lu\n",
+            (unsigned long)corpus.count, (unsigned long)corpus.total_bytes,
+                                                                params.seed);
+    printf("%-16s %14s %10s %7s %10s %10s %10s %8s\n", "case", "exprs/s",
+                "ns/byte", "GB/s", "p50 ns", "p99 ns", "p999 ns", "errors");
+
+    for(i = 0; i < sizeof(bench_cases) / sizeof(bench_cases[0]); ++i)
+    {
+        if(NULL != only_case && 0 != strcmp(only_case, bench_cases[i].name))
+        {
+            continue;
+        }
+
+        if(!RunCase(&bench_cases[i], &state, rounds, &result))
+        {
+            fprintf(stderr, "%s: setup failed\n", bench_cases[i].name);
+            continue;
+        }
+
+        printf("%-16s %14.0f %10.2f %7.2f %10.0f %10.0f %10.0f %8lu\n",
+                bench_cases[i].name, result.exprs_per_sec, result.ns_per_byte,
+                1 / result.ns_per_byte, result.p50_ns, result.p99_ns,
+                                result.p999_ns, (unsigned long)result.errors);
+
+        if(NULL != csv)
+        {
+            fprintf(csv, "%s,%lu,%lu,%lu,%lu,%lu,%.0f,%.3f,%.0f,%.0f,%.0f,"
+                "%lu\n", bench_cases[i].name, params.seed,
+                (unsigned long)params.count, (unsigned long)params.length,
+                (unsigned long)params.max_depth,
+                (unsigned long)corpus.total_bytes, result.exprs_per_sec,
+                result.ns_per_byte, result.p50_ns, result.p99_ns,
+                                    result.p999_ns, (unsigned long)result.errors);
+        }
+    }
+
+    if(NULL != csv)
+    {
+        fclose(csv);
+    }
+
+    ExprGenFreeCorpus(&corpus);
+
+    return 0;
+}
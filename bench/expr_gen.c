@@ -0,0 +1,290 @@
+#include <stdlib.h>  /* malloc, free */
+#include <stdio.h>   /* sprintf */
+#include <string.h>  /* strlen, memcpy */
+
+#include "expr_gen.h"
+
+#define NUMBER_MAX_CHARS 32
+#define SLACK 64
+
+typedef struct generator
+{
+    const expr_gen_params_t* params;
+    unsigned long state;
+    char* buffer;
+    size_t len;
+    size_t limit;
+    unsigned int total_weight;
+} generator_t;
+
+static const char operator_chars[NUM_OF_GEN_OPERATORS] = {'+', '-', '*', '/',
+                                                                        '^'};
+
+/* xorshift32, kept to 32 bits so the corpus is the same on every platform */
+static unsigned long Random(generator_t* gen)
+{
+    unsigned long x = gen->state;
+
+    x ^= (x << 13) & 0xFFFFFFFFUL;
+    x ^= x >> 17;
+    x ^= (x << 5) & 0xFFFFFFFFUL;
+    gen->state = x;
+
+    return x;
+}
+
+static unsigned long RandomBelow(generator_t* gen, unsigned long bound)
+{
+    return Random(gen) % bound;
+}
+
+static void Put(generator_t* gen, char c)
+{
+    gen->buffer[gen->len++] = c;
+}
+
+static void PutSpaces(generator_t* gen)
+{
+    static const char spaces[] = {' ', ' ', ' ', '\t'};
+
+    while(RandomBelow(gen, 100) < gen->params->space_percent &&
+                                                    gen->len < gen->limit)
+    {
+        Put(gen, spaces[RandomBelow(gen, sizeof(spaces))]);
+    }
+}
+
+static void PutNumber(generator_t* gen)
+{
+    char number[NUMBER_MAX_CHARS];
+    numbers_format_t format = gen->params->numbers;
+    unsigned long integer = 1 + RandomBelow(gen, 999);
+
+    if(NUMBERS_MIXED == format)
+    {
+        format = (numbers_format_t)RandomBelow(gen, NUMBERS_MIXED);
+    }
+
+    switch(format)
+    {
+        case NUMBERS_DECIMAL:
+            sprintf(number, "%lu.%02lu", integer, RandomBelow(gen, 100));
+            break;
+
+        case NUMBERS_EXPONENT:
+            sprintf(number, "%lu.%lue%lu", 1 + RandomBelow(gen, 9),
+                                RandomBelow(gen, 100), RandomBelow(gen, 3));
+            break;
+
+        case NUMBERS_PRECISE:
+            sprintf(number, "%lu.%08lu%08lue%ld", 1 + RandomBelow(gen, 9),
+                    RandomBelow(gen, 100000000), RandomBelow(gen, 100000000),
+                                            (long)RandomBelow(gen, 61) - 30);
+            break;
+
+        default:
+            sprintf(number, "%lu", integer);
+            break;
+    }
+
+    memcpy(gen->buffer + gen->len, number, strlen(number));
+    gen->len += strlen(number);
+}
+
+static void PutVariable(generator_t* gen)
+{
+    char name[NUMBER_MAX_CHARS];
+
+    sprintf(name, "x%lu", RandomBelow(gen, gen->params->variables));
+    memcpy(gen->buffer + gen->len, name, strlen(name));
+    gen->len += strlen(name);
+}
+
+static gen_operator_t PickOperator(generator_t* gen)
+{
+    unsigned long pick = RandomBelow(gen, gen->total_weight);
+    int op = 0;
+
+    while(pick >= gen->params->op_weights[op])
+    {
+        pick -= gen->params->op_weights[op];
+        ++op;
+    }
+
+    return (gen_operator_t)op;
+}
+
+static void PutExpression(generator_t* gen, size_t depth, size_t budget);
+
+static void PutOperand(generator_t* gen, size_t depth, size_t budget)
+{
+    if(0 == RandomBelow(gen, 8))
+    {
+        Put(gen, '-');
+    }
+
+    if(depth < gen->params->max_depth && budget > 8 &&
+                                                    0 == RandomBelow(gen, 3))
+    {
+        Put(gen, '(');
+        PutSpaces(gen);
+        PutExpression(gen, depth + 1, budget / 2);
+        PutSpaces(gen);
+        Put(gen, ')');
+    }
+    else if(0 < gen->params->variables && 0 == RandomBelow(gen, 2))
+    {
+        PutVariable(gen);
+    }
+    else
+    {
+        PutNumber(gen);
+    }
+}
+
+static void PutExpression(generator_t* gen, size_t depth, size_t budget)
+{
+    size_t start = gen->len;
+    gen_operator_t op;
+
+    PutOperand(gen, depth, budget);
+
+    while(gen->len - start < budget && gen->len < gen->limit)
+    {
+        op = PickOperator(gen);
+        PutSpaces(gen);
+        Put(gen, operator_chars[op]);
+        PutSpaces(gen);
+
+        if(GEN_POWER == op)
+        {
+            /* small exponents keep results finite */
+            Put(gen, (char)('0' + RandomBelow(gen, 4)));
+        }
+        else
+        {
+            PutOperand(gen, depth, budget - (gen->len - start));
+        }
+    }
+}
+
+void ExprGenDefaults(expr_gen_params_t* params)
+{
+    int i = 0;
+
+    params->seed = 1;
+    params->count = 1000;
+    params->length = 64;
+    params->max_length = 0;
+    params->max_depth = 3;
+
+    for( ; i < NUM_OF_GEN_OPERATORS; ++i)
+    {
+        params->op_weights[i] = 1;
+    }
+
+    params->numbers = NUMBERS_MIXED;
+    params->space_percent = 30;
+    params->variables = 0;
+}
+
+int ExprGenCorpus(const expr_gen_params_t* params, expr_corpus_t* corpus)
+{
+    generator_t gen;
+    size_t longest = params->max_length > params->length ?
+                                        params->max_length : params->length;
+    size_t max_len = longest * 2 + params->max_depth * 4 + SLACK;
+    size_t length = 0;
+    size_t i = 0;
+    int op = 0;
+
+    gen.params = params;
+    gen.state = (params->seed & 0xFFFFFFFFUL) | 1;
+    gen.total_weight = 0;
+
+    for( ; op < NUM_OF_GEN_OPERATORS; ++op)
+    {
+        gen.total_weight += params->op_weights[op];
+    }
+
+    if(0 == gen.total_weight)
+    {
+        return 0;
+    }
+
+    corpus->exprs = (char**)malloc(params->count * sizeof(char*));
+    corpus->storage = (char*)malloc(params->count * (max_len + 1));
+    if(NULL == corpus->exprs || NULL == corpus->storage)
+    {
+        free(corpus->exprs);
+        free(corpus->storage);
+        return 0;
+    }
+
+    corpus->count = params->count;
+    corpus->total_bytes = 0;
+    gen.buffer = corpus->storage;
+    gen.len = 0;
+
+    for( ; i < params->count; ++i)
+    {
+        corpus->exprs[i] = gen.buffer + gen.len;
+        length = params->length;
+        if(longest > length)
+        {
+            length += RandomBelow(&gen, longest - length + 1);
+        }
+        gen.limit = gen.len + length + length / 2;
+
+        PutSpaces(&gen);
+        PutExpression(&gen, 0, length);
+        PutSpaces(&gen);
+
+        corpus->total_bytes += gen.buffer + gen.len - corpus->exprs[i];
+        Put(&gen, '\0');
+    }
+
+    return 1;
+}
+
+int ExprGenNumbers(const expr_gen_params_t* params, expr_corpus_t* corpus)
+{
+    generator_t gen;
+    size_t i = 0;
+
+    gen.params = params;
+    gen.state = (params->seed & 0xFFFFFFFFUL) | 1;
+
+    corpus->exprs = (char**)malloc(params->count * sizeof(char*));
+    corpus->storage = (char*)malloc(params->count * NUMBER_MAX_CHARS);
+    if(NULL == corpus->exprs || NULL == corpus->storage)
+    {
+        free(corpus->exprs);
+        free(corpus->storage);
+        return 0;
+    }
+
+    corpus->count = params->count;
+    corpus->total_bytes = 0;
+    gen.buffer = corpus->storage;
+    gen.len = 0;
+
+    for( ; i < params->count; ++i)
+    {
+        corpus->exprs[i] = gen.buffer + gen.len;
+        PutNumber(&gen);
+        corpus->total_bytes += gen.buffer + gen.len - corpus->exprs[i];
+        Put(&gen, '\0');
+    }
+
+    return 1;
+}
+
+void ExprGenFreeCorpus(expr_corpus_t* corpus)
+{
+    free(corpus->exprs);
+    free(corpus->storage);
+    corpus->exprs = NULL;
+    corpus->storage = NULL;
+    corpus->count = 0;
+}
@@ -0,0 +1,73 @@
+#ifndef __EXPR_GEN_H__
+#define __EXPR_GEN_H__
+
+#include <stddef.h> /* size_t */
+
+typedef enum
+{
+    NUMBERS_INTEGER,
+    NUMBERS_DECIMAL,
+    NUMBERS_EXPONENT,
+    NUMBERS_MIXED,              /* one of the three above per number */
+    NUMBERS_PRECISE,            /* 17 significant digits and an exponent */
+    NUM_OF_NUMBER_FORMATS
+} numbers_format_t;
+
+typedef enum
+{
+    GEN_PLUS,
+    GEN_MINUS,
+    GEN_MULT,
+    GEN_DIV,
+    GEN_POWER,
+    NUM_OF_GEN_OPERATORS
+} gen_operator_t;
+
+typedef struct expr_gen_params
+{
+    unsigned long seed;
+    size_t count;               /* expressions in the corpus */
+    size_t length;              /* approximate bytes per expression */
+    size_t max_length;          /* if above length, each expression picks a
+                                   length uniformly in [length, max_length] */
+    size_t max_depth;           /* bracket nesting */
+    unsigned int op_weights[NUM_OF_GEN_OPERATORS];
+    numbers_format_t numbers;
+    unsigned int space_percent; /* chance of whitespace between tokens */
+    size_t variables;           /* distinct variables x0, x1, ... (0: none) */
+} expr_gen_params_t;
+
+typedef struct expr_corpus
+{
+    char** exprs;
+    size_t count;
+    size_t total_bytes;
+    char* storage;
+} expr_corpus_t;
+
+/* @Desc: Fill params with the defaults (seed 1, 1000 expressions of about 64
+          bytes, depth 3, all operators, mixed numbers, 30% whitespace)
+   @params: params to fill*/
+
+void ExprGenDefaults(expr_gen_params_t* params);
+
+/* @Desc: Generate a corpus of valid expressions; the same params (including
+          the seed) always produce the same corpus
+   @params: generation params, corpus to fill
+   @return value: 1 on success, 0 on allocation failure*/
+
+int ExprGenCorpus(const expr_gen_params_t* params, expr_corpus_t* corpus);
+
+/* @Desc: Generate a corpus of lone numbers in the params' number format,
+          for parsing benchmarks (only seed, count and numbers are used)
+   @params: generation params, corpus to fill
+   @return value: 1 on success, 0 on allocation failure*/
+
+int ExprGenNumbers(const expr_gen_params_t* params, expr_corpus_t* corpus);
+
+/* @Desc: Free the memory of a corpus
+   @params: corpus to free*/
+
+void ExprGenFreeCorpus(expr_corpus_t* corpus);
+
+#endif      /* expr_gen.h */
@@ -0,0 +1,134 @@
+#ifndef __TYPED_STACK_H__
+#define __TYPED_STACK_H__
+
+#include <stddef.h> /* size_t */
+#include <stdlib.h> /* malloc, free */
+#include <string.h> /* memcpy */
+
+/* Typed stacks generated per element type, with inline push/pop/top access.
+   A stack starts on a small buffer embedded in the struct (so it must not be
+   copied or moved once initialized), and doubles its capacity on the heap
+   when a push finds it full. A stack on a caller-owned buffer never grows:
+   a push that finds it full fails, so the memory stays the caller's.
+
+   DEFINE_TYPED_STACK(DoubleStack, double_stack_t, double, 32) generates the
+   type double_stack_t and functions DoubleStackInit, DoubleStackPush, ... */
+
+#if defined(__GNUC__)
+#define TYPED_STACK_INLINE static __inline__
+#else
+#define TYPED_STACK_INLINE static
+#endif
+
+#define DEFINE_TYPED_STACK(NAME, STACK_TYPE, TYPE, INLINE_CAPACITY)            \
+                                                                               \
+typedef struct                                                                 \
+{                                                                              \
+    TYPE* data;                                                                \
+    size_t size;                                                               \
+    size_t capacity;                                                           \
+    int owns_data;                                                             \
+    int fixed;                  /* on a caller-owned buffer */                 \
+    TYPE inline_data[INLINE_CAPACITY];                                         \
+} STACK_TYPE;                                                                  \
+                                                                               \
+/* @Desc: Initialize an empty stack on its embedded buffer */                  \
+TYPED_STACK_INLINE void NAME##Init(STACK_TYPE* stack)                          \
+{                                                                              \
+    stack->data = stack->inline_data;                                          \
+    stack->size = 0;                                                           \
+    stack->capacity = INLINE_CAPACITY;                                         \
+    stack->owns_data = 0;                                                      \
+    stack->fixed = 0;                                                          \
+}                                                                              \
+                                                                               \
+/* @Desc: Initialize an empty stack on a caller-owned buffer it cannot grow */ \
+TYPED_STACK_INLINE void NAME##InitBuffer(STACK_TYPE* stack, TYPE* buffer,      \
+                                                            size_t capacity)   \
+{                                                                              \
+    stack->data = buffer;                                                      \
+    stack->size = 0;                                                           \
+    stack->capacity = capacity;                                                \
+    stack->owns_data = 0;                                                      \
+    stack->fixed = 1;                                                          \
+}                                                                              \
+                                                                               \
+/* @Desc: Free the heap buffer the stack may have grown into */                \
+TYPED_STACK_INLINE void NAME##Destroy(STACK_TYPE* stack)                       \
+{                                                                              \
+    if(stack->owns_data)                                                       \
+    {                                                                          \
+        free(stack->data);                                                     \
+    }                                                                          \
+                                                                               \
+    stack->data = NULL;                                                        \
+}                                                                              \
+                                                                               \
+/* @Desc: Double the capacity, @return value: 1 on success, 0 otherwise */     \
+TYPED_STACK_INLINE int NAME##Grow(STACK_TYPE* stack)                           \
+{                                                                              \
+    size_t capacity = 0 == stack->capacity ? 1 : stack->capacity * 2;          \
+    TYPE* data = NULL;                                                         \
+                                                                               \
+    if(stack->fixed)                                                           \
+    {                                                                          \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    data = (TYPE*)malloc(capacity * sizeof(TYPE));                             \
+    if(NULL == data)                                                           \
+    {                                                                          \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    memcpy(data, stack->data, stack->size * sizeof(TYPE));                     \
+    NAME##Destroy(stack);                                                      \
+    stack->data = data;                                                        \
+    stack->capacity = capacity;                                                \
+    stack->owns_data = 1;                                                      \
+                                                                               \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+/* @Desc: Push an element, @return value: 1 on success, 0 if it cannot grow */ \
+TYPED_STACK_INLINE int NAME##Push(STACK_TYPE* stack, TYPE element)             \
+{                                                                              \
+    if(stack->size == stack->capacity && !NAME##Grow(stack))                   \
+    {                                                                          \
+        return 0;                                                              \
+    }                                                                          \
+                                                                               \
+    stack->data[stack->size++] = element;                                      \
+                                                                               \
+    return 1;                                                                  \
+}                                                                              \
+                                                                               \
+/* @Desc: Remove and return the element on top of a non-empty stack */        \
+TYPED_STACK_INLINE TYPE NAME##Pop(STACK_TYPE* stack)                           \
+{                                                                              \
+    return stack->data[--stack->size];                                         \
+}                                                                              \
+                                                                               \
+/* @Desc: Return the element on top of a non-empty stack */                    \
+TYPED_STACK_INLINE TYPE NAME##Peek(const STACK_TYPE* stack)                    \
+{                                                                              \
+    return stack->data[stack->size - 1];                                       \
+}                                                                              \
+                                                                               \
+/* @Desc: Get a pointer to the element on top of a non-empty stack */          \
+TYPED_STACK_INLINE TYPE* NAME##Top(STACK_TYPE* stack)                          \
+{                                                                              \
+    return stack->data + stack->size - 1;                                      \
+}                                                                              \
+                                                                               \
+TYPED_STACK_INLINE size_t NAME##Size(const STACK_TYPE* stack)                  \
+{                                                                              \
+    return stack->size;                                                        \
+}                                                                              \
+                                                                               \
+TYPED_STACK_INLINE int NAME##IsEmpty(const STACK_TYPE* stack)                  \
+{                                                                              \
+    return 0 == stack->size;                                                   \
+}
+
+#endif  /*End of header guard*/
@@ -0,0 +1,44 @@
+#ifndef __CALC_CACHE_H__
+#define __CALC_CACHE_H__
+
+#include <stddef.h> /* size_t */
+
+#include "calculator.h"
+
+typedef struct calc_cache calc_cache_t;
+
+typedef struct calc_cache_stats
+{
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+} calc_cache_stats_t;
+
+/* @Desc: Create a thread-safe cache of Calculate results, holding at most
+          max_entries expressions (rounded up to a multiple of 8)
+   @params: maximum number of cached expressions
+   @return value: pointer to the new cache, NULL on allocation failure*/
+
+calc_cache_t* CalcCacheCreate(size_t max_entries);
+
+/* @Desc: Free a cache
+   @params: Pointer to the cache*/
+
+void CalcCacheDestroy(calc_cache_t* cache);
+
+/* @Desc: Same as Calculate, answered from the cache when an expression that
+          differs only in whitespace was calculated before. Failures
+          (MATH_ERROR, INVALID_SYNTAX) are cached too; FAILED_ALLOCATION is
+          not. Expressions longer than 108 characters once normalised
+          bypass the cache and count as misses
+   @params: Pointer to the cache, expression, pointer to store the result in
+   @return value: same as Calculate*/
+
+status_t CalculateCached(calc_cache_t* cache, const char* str, double* ans);
+
+/* @Desc: Get the hit, miss and eviction counts since the cache was created
+   @params: Pointer to the cache, stats to fill*/
+
+void CalcCacheGetStats(const calc_cache_t* cache, calc_cache_stats_t* stats);
+
+#endif      /* calc_cache.h */
@@ -0,0 +1,50 @@
+#ifndef __CALC_CSV_H__
+#define __CALC_CSV_H__
+
+#include <stddef.h> /* size_t */
+#include <stdio.h>  /* FILE */
+
+#include "calculator.h"
+
+typedef struct calc_csv_options
+{
+    char delimiter;             /* ',' if 0 */
+    int no_header;              /* the first row is data, and variable cN is
+                                   the Nth column (from 1) */
+    int only_result;            /* write the result column alone rather
+                                   than append it to every row */
+    const char* result_name;    /* its header, "result" if NULL */
+    size_t chunk_rows;          /* rows evaluated together, 4096 if 0 */
+} calc_csv_options_t;
+
+typedef struct calc_csv_report
+{
+    size_t rows;
+    size_t failed_rows;         /* math errors, cells that are not numbers
+                                   and rows missing a column */
+    size_t bytes;               /* read */
+} calc_csv_report_t;
+
+/* @Desc: Evaluate a compiled program on every row of a CSV stream. Each
+          variable is the column of the same name in the header row. Rows
+          are read in chunks: the cells of the variables' columns are
+          parsed into one array per variable, and CalcEvalColumns evaluates
+          the chunk. Every result is written as a new last column (%.17g,
+          nan for a failed row), after the header if there is one. Memory
+          is bounded by the chunk and the longest row, whatever the size of
+          the stream. Cells are numbers as the calculator reads them, with
+          an optional sign, surrounding blanks and surrounding quotes.
+          Quoted cells may hold delimiters and newlines. Blank lines are
+          skipped
+   @params: Pointer to the program, stream to read, stream to write,
+            options (NULL for the defaults), report to fill (may be NULL)
+   @return value: SUCCESS, MATH_ERROR if any row failed, INVALID_SYNTAX if
+                  a variable has no column (nothing is written),
+                  STREAM_ERROR if a stream cannot be read or written, or
+                  FAILED_ALLOCATION*/
+
+status_t CalcEvalCsv(const calc_program_t* program, FILE* input,
+                        FILE* output, const calc_csv_options_t* options,
+                                                calc_csv_report_t* report);
+
+#endif      /* calc_csv.h */
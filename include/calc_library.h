@@ -0,0 +1,100 @@
+#ifndef __CALC_LIBRARY_H__
+#define __CALC_LIBRARY_H__
+
+#include <stddef.h> /* size_t */
+
+#include "calculator.h"
+
+typedef struct calc_library calc_library_t;
+typedef struct calc_library_builder calc_library_builder_t;
+
+/* @Desc: Create an empty set of named formulas to write as a library file
+   @return value: pointer to the new builder, NULL on allocation failure*/
+
+calc_library_builder_t* CalcLibraryBuilderCreate(void);
+
+/* @Desc: Free a builder and its formulas
+   @params: Pointer to the builder*/
+
+void CalcLibraryBuilderDestroy(calc_library_builder_t* builder);
+
+/* @Desc: Compile and optimize a formula into the builder. Adding a name
+          again replaces its formula
+   @params: Pointer to the builder, name of the formula, expression
+   @return value: SUCCESS, INVALID_SYNTAX leaving the builder unchanged, or
+                  FAILED_ALLOCATION*/
+
+status_t CalcLibraryBuilderAdd(calc_library_builder_t* builder,
+                                        const char* name, const char* expr);
+
+/* @Desc: Write the builder's formulas as a library file: a versioned header
+          with a checksum, then the formulas sorted by name, one constant
+          pool, one instruction stream and one variable table. The file is
+          written next to path and renamed over it, so a reader never maps
+          a partial file
+   @params: Pointer to the builder, path of the file
+   @return value: SUCCESS, INVALID_LIBRARY if the file cannot be written or
+                  would reach 4 GB, or FAILED_ALLOCATION*/
+
+status_t CalcLibraryBuilderWrite(const calc_library_builder_t* builder,
+                                                            const char* path);
+
+/* @Desc: Map a library file and check it: its version, its checksum, and
+          every formula, so that any file that opens can be evaluated
+          safely. Nothing is parsed or allocated per formula
+   @params: path of the file, pointer to store the new library in
+   @return value: SUCCESS, INVALID_LIBRARY if the file cannot be mapped or
+                  fails a check (*library is then NULL), or
+                  FAILED_ALLOCATION*/
+
+status_t CalcLibraryOpen(const char* path, calc_library_t** library);
+
+/* @Desc: Unmap a library (NULL is ignored)
+   @params: Pointer to the library*/
+
+void CalcLibraryClose(calc_library_t* library);
+
+/* @Desc: Get the number of formulas in a library
+   @params: Pointer to the library
+   @return value: number of formulas*/
+
+size_t CalcLibraryCount(const calc_library_t* library);
+
+/* @Desc: Look up a formula by name, with a binary search
+   @params: Pointer to the library, name of the formula
+   @return value: index of the formula, CalcLibraryCount if there is none*/
+
+size_t CalcLibraryFind(const calc_library_t* library, const char* name);
+
+/* @Desc: Get the name of a formula
+   @params: Pointer to the library, index of the formula
+   @return value: its name, in the mapped file*/
+
+const char* CalcLibraryName(const calc_library_t* library, size_t index);
+
+/* @Desc: Get the number of variables of a formula
+   @params: Pointer to the library, index of the formula
+   @return value: number of variables*/
+
+size_t CalcLibraryVariableCount(const calc_library_t* library, size_t index);
+
+/* @Desc: Get the name of a variable of a formula, in the order of first
+          appearance, as with CalcVariableName
+   @params: Pointer to the library, index of the formula, index of the
+            variable
+   @return value: its name, in the mapped file*/
+
+const char* CalcLibraryVariableName(const calc_library_t* library,
+                                                size_t index, size_t var);
+
+/* @Desc: Evaluate a formula straight from the mapped file. Safe to call from
+          several threads at once
+   @params: Pointer to the library, index of the formula, values of its
+            variables (CalcLibraryVariableCount of them), pointer to store
+            the result in
+   @return value: same as CalcEval*/
+
+status_t CalcLibraryEval(const calc_library_t* library, size_t index,
+                                            const double* vars, double* ans);
+
+#endif      /* calc_library.h */
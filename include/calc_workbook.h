@@ -0,0 +1,61 @@
+#ifndef __CALC_WORKBOOK_H__
+#define __CALC_WORKBOOK_H__
+
+#include <stddef.h> /* size_t */
+
+#include "calculator.h"
+
+typedef struct calc_workbook calc_workbook_t;
+
+/* @Desc: Create an empty workbook of named cells
+   @return value: pointer to the new workbook, NULL on allocation failure*/
+
+calc_workbook_t* CalcWorkbookCreate(void);
+
+/* @Desc: Free a workbook and its cells
+   @params: Pointer to the workbook*/
+
+void CalcWorkbookDestroy(calc_workbook_t* workbook);
+
+/* @Desc: Define a cell as a formula, replacing any previous definition. The
+          formula's variables are references to other cells by name, which
+          may be defined later. The cell and everything that depends on it
+          are recomputed by the next CalcWorkbookEvaluate
+   @params: Pointer to the workbook, name of the cell, formula
+   @return value: SUCCESS, INVALID_SYNTAX leaving the cell unchanged, or
+                  FAILED_ALLOCATION*/
+
+status_t CalcWorkbookSet(calc_workbook_t* workbook, const char* name,
+                                                            const char* expr);
+
+/* @Desc: Define a cell as an input value, replacing any previous definition.
+          Only the cells that depend on it are recomputed, and only when the
+          value changed
+   @params: Pointer to the workbook, name of the cell, its value
+   @return value: SUCCESS or FAILED_ALLOCATION*/
+
+status_t CalcWorkbookSetValue(calc_workbook_t* workbook, const char* name,
+                                                                double value);
+
+/* @Desc: Recompute the cells changed since the last call and the cells that
+          depend on them, level by level of the dependency graph: a level
+          holds the cells whose references are all in lower levels, and its
+          cells are evaluated in parallel. A cell that references itself,
+          directly or not, or depends on such a cell, gets CYCLIC_REFERENCE;
+          a cell that depends on a failed cell gets its status
+   @params: Pointer to the workbook, number of threads (0 for one per online
+            CPU)
+   @return value: SUCCESS, CYCLIC_REFERENCE when some cells are in or after
+                  a cycle, or FAILED_ALLOCATION*/
+
+status_t CalcWorkbookEvaluate(calc_workbook_t* workbook, unsigned threads);
+
+/* @Desc: Get the value of a cell as of the last CalcWorkbookEvaluate
+   @params: Pointer to the workbook, name of the cell, pointer to store the
+            value in
+   @return value: status of the cell (INVALID_SYNTAX for undefined cells)*/
+
+status_t CalcWorkbookGet(const calc_workbook_t* workbook, const char* name,
+                                                                double* ans);
+
+#endif      /* calc_workbook.h */
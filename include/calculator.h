@@ -1,15 +1,326 @@
 #ifndef __CALCULATOR_H__
 #define __CALCULATOR_H__
 
+#include <stddef.h> /* size_t */
+
 typedef enum
 {
     SUCCESS = 0,
     MATH_ERROR = 1,
     INVALID_SYNTAX = 2,
-    FAILED_ALLOCATION = 3
+    FAILED_ALLOCATION = 3,
+    CYCLIC_REFERENCE = 4,   /* workbook cells that depend on themselves */
+    INVALID_LIBRARY = 5,    /* formula library files that cannot be read or
+                               written, or fail their checks */
+    STREAM_ERROR = 6        /* CSV streams that cannot be read or written */
 } status_t;
 
+typedef struct calc_program calc_program_t;
+typedef struct calc_ctx calc_ctx_t;
+typedef status_t (*calc_eval_func_t)(const calc_program_t* program,
+                                                                double* ans);
+
+typedef struct calc_allocator
+{
+    void* (*alloc)(size_t size, void* param);
+    void (*free)(void* ptr, void* param);
+    void* param;
+} calc_allocator_t;
+
+typedef struct calc_alloc_counters
+{
+    size_t allocations;
+    size_t frees;
+    size_t bytes_allocated;
+} calc_alloc_counters_t;
+
+typedef struct calc_number
+{
+    double real;            /* the result */
+    long integer;           /* the exact result, if is_integer */
+    int is_integer;
+} calc_number_t;
+
+typedef struct calc_opt_report
+{
+    size_t instructions_before;
+    size_t instructions_after;
+    long folded;            /* instructions removed by each pass, negative */
+    long simplified;        /* when a pass trades them for cheaper ones */
+    long strength_reduced;
+    long shared;
+} calc_opt_report_t;
+
+#define CALC_LATENCY_BUCKETS 144
+#define CALC_VALID ((size_t)-1)     /* CalcValidate found no error */
+#define CALC_VALIDATE_MAX_DEPTH 16384   /* nested brackets CalcValidate takes */
+
+/* operators in the order of calc_stats_t::operators */
+typedef enum
+{
+    CALC_ADD,
+    CALC_PLUS,      /* unary */
+    CALC_SUB,
+    CALC_NEG,
+    CALC_MUL,
+    CALC_DIV,
+    CALC_POW,
+    CALC_NUM_OF_OPERATORS
+} calc_operator_t;
+
+typedef struct calc_stats
+{
+    size_t calls;
+    size_t tokens;
+    size_t numbers;
+    size_t operators[CALC_NUM_OF_OPERATORS];    /* executed, by type */
+    size_t max_numbers_depth;
+    size_t max_operators_depth;
+    size_t whitespace_bytes;
+    size_t latency[CALC_LATENCY_BUCKETS];       /* calls by duration */
+} calc_stats_t;
+
 
 status_t Calculate(const char* str, double* ans);
 
-#endif      /* calculator.h */
\ No newline at end of file
+/* @Desc: Same as Calculate on the first len characters of str, which need
+          not be NUL-terminated. Nothing past str + len is ever read, so
+          expressions can be evaluated in place inside larger buffers
+   @params: expression, its length, pointer to store the result in
+   @return value: same as Calculate*/
+
+status_t CalculateN(const char* str, size_t len, double* ans);
+
+/* @Desc: Same as Calculate, but evaluated exactly on longs while every
+          number and every intermediate result is an integer that fits one.
+          From the first value that is not (a fraction, an overflow, a
+          division with a remainder, a negative exponent, a function other
+          than min and max), the expression goes on in doubles like
+          Calculate. Integers have no -0
+   @params: expression, pointer to store the result in: real always, and
+            integer when is_integer is set
+   @return value: same as Calculate*/
+
+status_t CalculateExact(const char* str, calc_number_t* ans);
+
+/* @Desc: Same as CalculateExact on the first len characters of str
+   @params: expression, its length, pointer to store the result in
+   @return value: same as Calculate*/
+
+status_t CalculateExactN(const char* str, size_t len, calc_number_t* ans);
+
+/* @Desc: Create an evaluation context that keeps its stacks between calls
+   @params: allocator for all of the context's memory, NULL for malloc/free
+   @return value: pointer to the new context, NULL on allocation failure*/
+
+calc_ctx_t* CalcCtxCreate(const calc_allocator_t* allocator);
+
+/* @Desc: Free a context and its stacks through its allocator
+   @params: Pointer to the context*/
+
+void CalcCtxDestroy(calc_ctx_t* ctx);
+
+/* @Desc: Grow the context's stacks ahead of time for expressions of up to
+          len characters
+   @params: Pointer to the context, expression length to prepare for
+   @return value: SUCCESS or FAILED_ALLOCATION*/
+
+status_t CalcCtxReserve(calc_ctx_t* ctx, size_t len);
+
+/* @Desc: Same as Calculate, reusing the context's stacks. Allocates only when
+          the expression is longer than any seen before by the context
+   @params: Pointer to the context, expression, pointer to store the result in
+   @return value: same as Calculate*/
+
+status_t CalculateCtx(calc_ctx_t* ctx, const char* str, double* ans);
+
+/* @Desc: Same as CalculateN, reusing the context's stacks
+   @params: Pointer to the context, expression, its length, pointer to store
+            the result in
+   @return value: same as Calculate*/
+
+status_t CalculateCtxN(calc_ctx_t* ctx, const char* str, size_t len,
+                                                                double* ans);
+
+/* @Desc: Get the allocations made by the context since its creation
+   @params: Pointer to the context, counters to fill*/
+
+void CalcCtxGetAllocCounters(const calc_ctx_t* ctx,
+                                            calc_alloc_counters_t* counters);
+
+/* @Desc: Get a snapshot of the evaluation statistics of a context, or with
+          NULL of every Calculate and CalculateN call made without one. They
+          are only collected when the library is built with -DCALC_STATS.
+          Lock-free: any thread may take a snapshot while the context is in
+          use; each counter is exact, but counters may be from different
+          calls
+   @params: Pointer to the context or NULL, stats to fill (all zero when
+            statistics are compiled out)
+   @return value: 1 when statistics are compiled in, 0 otherwise*/
+
+int CalcGetStats(const calc_ctx_t* ctx, calc_stats_t* stats);
+
+/* @Desc: Get the range of call durations counted in a latency bucket. The
+          buckets are log-linear: each power of two of nanoseconds is split
+          into four equal buckets, and the last one takes every longer call
+   @params: bucket index, smaller than CALC_LATENCY_BUCKETS
+   @return value: shortest duration in the bucket, in nanoseconds*/
+
+unsigned long CalcLatencyBucketFloor(size_t bucket);
+
+/* @Desc: Evaluate many expressions on a pool of threads with per-thread
+          work-stealing deques. Each expression gets the same result and
+          status Calculate would give it
+   @params: expressions, their number, arrays of n results and n statuses to
+            fill, number of threads (0 for one per online CPU)
+   @return value: SUCCESS once every expression was evaluated,
+                  FAILED_ALLOCATION if the pool could not be allocated*/
+
+status_t CalculateBatch(const char* const* exprs, size_t n, double* results,
+                                    status_t* statuses, unsigned threads);
+
+/* @Desc: Parse an expression once into a reusable postfix program. Names made
+          of letters, digits and '_' (not starting with a digit) are variables,
+          but for the functions sqrt, exp, log, sin, cos, min and max
+   @params: expression to compile, pointer to store the new program in
+   @return value: SUCCESS, INVALID_SYNTAX or FAILED_ALLOCATION*/
+
+status_t CalcCompile(const char* str, calc_program_t** program);
+
+/* @Desc: Check the syntax of an expression without evaluating it: only the
+          FSM's transitions are run, with a count of open brackets, so
+          nothing is allocated and no number is converted. An expression is
+          valid when CalcCompile would compile it and nests no more than
+          CALC_VALIDATE_MAX_DEPTH brackets; Calculate also rejects variables,
+          and may fail with MATH_ERROR before a syntax error
+   @params: expression, its length (it need not be NUL-terminated)
+   @return value: CALC_VALID, or the offset of the first character that
+                  cannot be read: the start of the token that breaks the
+                  syntax or opens one bracket too many, len when the
+                  expression ends too early*/
+
+size_t CalcValidate(const char* str, size_t len);
+
+/* @Desc: CalcValidate each of n expressions
+   @params: expressions, their lengths (NULL when they are NUL-terminated),
+            their number, array of n offsets to fill
+   @return value: number of invalid expressions*/
+
+size_t CalcValidateBatch(const char* const* exprs, const size_t* lens,
+                                                size_t n, size_t* offsets);
+
+/* @Desc: Evaluate a compiled program with its currently bound variables
+   @params: Pointer to the program, pointer to store the result in
+   @return value: SUCCESS, MATH_ERROR or FAILED_ALLOCATION*/
+
+status_t CalcEval(const calc_program_t* program, double* ans);
+
+/* @Desc: Translate a compiled program into native x86-64 code. The code is
+          kept with the program and freed with it, or when it is optimized;
+          the function returned must only be called with this program. On
+          other architectures, or if the code cannot be mapped, the function
+          returned is CalcEval
+   @params: Pointer to the program
+   @return value: function with the same results and statuses as CalcEval*/
+
+calc_eval_func_t CalcJit(calc_program_t* program);
+
+/* @Desc: Optimize a compiled program in place: fold constant
+          sub-expressions, drop double negations and identities (x*1, x/1,
+          x+0, x-0, x^1), turn x^2, x^3 and x^4 into multiplications and
+          compute repeated sub-expressions once. Results and statuses are the
+          same as before, except that x+0 gives x, so a -0 result keeps its
+          sign
+   @params: Pointer to the program, report to fill (NULL for none)
+   @return value: SUCCESS, FAILED_ALLOCATION leaving the program unchanged*/
+
+status_t CalcOptimize(calc_program_t* program, calc_opt_report_t* report);
+
+/* @Desc: Bind a value to a variable of the program (variables start at 0)
+   @params: Pointer to the program, name of the variable, value to bind
+   @return value: SUCCESS, INVALID_SYNTAX if the program has no such variable*/
+
+status_t CalcSetVariable(calc_program_t* program, const char* name,
+                                                                double value);
+
+/* @Desc: Same as CalcSetVariable, by the index of the variable, without
+          looking its name up
+   @params: Pointer to the program, index smaller than CalcVariableCount,
+            value to bind
+   @return value: SUCCESS, INVALID_SYNTAX if the program has no such variable*/
+
+status_t CalcSetVariableIndex(calc_program_t* program, size_t index,
+                                                                double value);
+
+/* @Desc: Same as CalcEval, but keeps the value of every sub-expression
+          between calls. The first call builds a dependency tree of the
+          program; from then on, binding a variable to a new value marks the
+          sub-expressions that depend on it, and only those are recomputed.
+          The tree is dropped when the program is optimized
+   @params: Pointer to the program, pointer to store the result in
+   @return value: SUCCESS, MATH_ERROR or FAILED_ALLOCATION*/
+
+status_t CalcEvalIncremental(calc_program_t* program, double* ans);
+
+/* @Desc: Evaluate a compiled program over many rows of variable values at
+          once, a block of rows per instruction. The functions run as SIMD
+          kernels (SSE2 or AVX2, whichever the CPU has): sqrt, min and max
+          give the results of CalcEval, exp, log, sin and cos are within
+          1 ulp of them. Everything else, and every status, is the same as
+          CalcEval row by row
+   @params: Pointer to the program, one column of rows values per variable
+            (in the order of CalcVariableName), number of rows, arrays of
+            rows results and rows statuses to fill (statuses may be NULL).
+            The result of a row that fails is unspecified
+   @return value: SUCCESS, MATH_ERROR if any row failed, FAILED_ALLOCATION*/
+
+status_t CalcEvalColumns(const calc_program_t* program,
+                        const double* const* columns, size_t rows,
+                        double* results, status_t* statuses);
+
+/* @Desc: Evaluate a compiled program and every partial derivative of it at
+          the bound variable values, in one pass of dual numbers (forward
+          mode). The value is the one CalcEval gives. Derivatives follow
+          the rules of each operator and function; a partial that does not
+          exist at the point (the base of a variable exponent below 0) is
+          NaN, and min and max take the partials of the operand they choose
+   @params: Pointer to the program, pointer to store the result in, array of
+            CalcVariableCount partials to fill (in the order of
+            CalcVariableName)
+   @return value: SUCCESS, MATH_ERROR (nothing is stored) or
+                  FAILED_ALLOCATION*/
+
+status_t CalcEvalGradient(const calc_program_t* program, double* ans,
+                                                            double* gradient);
+
+/* @Desc: Same as CalcEvalGradient over many rows of variable values at once,
+          the way CalcEvalColumns evaluates them
+   @params: Pointer to the program, one column of rows values per variable,
+            number of rows, array of rows results, one array of rows partials
+            per variable, array of rows statuses (may be NULL). The result
+            and partials of a row that fails are unspecified
+   @return value: SUCCESS, MATH_ERROR if any row failed, FAILED_ALLOCATION*/
+
+status_t CalcEvalGradientColumns(const calc_program_t* program,
+                        const double* const* columns, size_t rows,
+                        double* results, double* const* gradients,
+                        status_t* statuses);
+
+/* @Desc: Get the number of distinct variables referenced by the program
+   @params: Pointer to the program
+   @return value: number of variables*/
+
+size_t CalcVariableCount(const calc_program_t* program);
+
+/* @Desc: Get the name of a variable by its index (order of first appearance)
+   @params: Pointer to the program, index smaller than CalcVariableCount
+   @return value: name of the variable*/
+
+const char* CalcVariableName(const calc_program_t* program, size_t index);
+
+/* @Desc: Free a compiled program (NULL is ignored)
+   @params: Pointer to the program*/
+
+void CalcProgramDestroy(calc_program_t* program);
+
+#endif      /* calculator.h */
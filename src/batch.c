@@ -0,0 +1,233 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>   /* malloc, posix_memalign, free */
+#include <limits.h>   /* ULONG_MAX */
+#include <assert.h>   /* assert */
+#include <pthread.h>  /* pthread_create, pthread_join */
+#include <unistd.h>   /* sysconf */
+
+#include "calculator.h"
+
+#define TASKS_PER_WORKER 64
+#define CACHE_LINE 64
+#if ULONG_MAX > 0xFFFFFFFFUL
+#define RANGE_BITS 32
+#else
+#define RANGE_BITS 16
+#endif
+#define RANGE_MASK ((1UL << RANGE_BITS) - 1)
+
+/* A deque holds the task indices [top, bottom) packed in one word, so both
+   ends are updated by a single compare-and-swap. The owner takes tasks from
+   the bottom, thieves steal from the top. Each one fills a cache line of
+   an array aligned to CACHE_LINE, so no two workers' deques share one. */
+typedef struct deque
+{
+    unsigned long range;
+    char padding[CACHE_LINE - sizeof(unsigned long)];
+} deque_t;
+
+typedef struct batch
+{
+    const char* const* exprs;
+    size_t n;
+    double* results;
+    status_t* statuses;
+    size_t task_size;
+    unsigned workers;
+    deque_t* deques;
+} batch_t;
+
+typedef struct worker
+{
+    batch_t* batch;
+    unsigned id;
+    int started;
+    pthread_t thread;
+} worker_t;
+
+static unsigned long Pack(unsigned long top, unsigned long bottom)
+{
+    return (top << RANGE_BITS) | bottom;
+}
+
+static int TakeBottom(deque_t* deque, unsigned long* task)
+{
+    unsigned long range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    unsigned long top = 0;
+    unsigned long bottom = 0;
+
+    do
+    {
+        top = range >> RANGE_BITS;
+        bottom = range & RANGE_MASK;
+        if(top >= bottom)
+        {
+            return 0;
+        }
+    } while(!__atomic_compare_exchange_n(&deque->range, &range,
+                        Pack(top, bottom - 1), 0, __ATOMIC_ACQ_REL,
+                                                        __ATOMIC_ACQUIRE));
+
+    *task = bottom - 1;
+
+    return 1;
+}
+
+static int StealTop(deque_t* deque, unsigned long* task)
+{
+    unsigned long range = __atomic_load_n(&deque->range, __ATOMIC_ACQUIRE);
+    unsigned long top = 0;
+    unsigned long bottom = 0;
+
+    do
+    {
+        top = range >> RANGE_BITS;
+        bottom = range & RANGE_MASK;
+        if(top >= bottom)
+        {
+            return 0;
+        }
+    } while(!__atomic_compare_exchange_n(&deque->range, &range,
+                        Pack(top + 1, bottom), 0, __ATOMIC_ACQ_REL,
+                                                        __ATOMIC_ACQUIRE));
+
+    *task = top;
+
+    return 1;
+}
+
+static void RunTask(batch_t* batch, calc_ctx_t* ctx, unsigned long task)
+{
+    size_t i = task * batch->task_size;
+    size_t end = i + batch->task_size;
+
+    end = end > batch->n ? batch->n : end;
+
+    for( ; i < end; ++i)
+    {
+        batch->statuses[i] = NULL == ctx ?
+                        Calculate(batch->exprs[i], &batch->results[i]) :
+                        CalculateCtx(ctx, batch->exprs[i], &batch->results[i]);
+    }
+}
+
+static void* WorkerMain(void* arg)
+{
+    worker_t* worker = (worker_t*)arg;
+    batch_t* batch = worker->batch;
+    calc_ctx_t* ctx = CalcCtxCreate(NULL);
+    unsigned long task = 0;
+    unsigned victim = 0;
+    unsigned tried = 0;
+
+    while(TakeBottom(&batch->deques[worker->id], &task))
+    {
+        RunTask(batch, ctx, task);
+    }
+
+    /* own deque is empty: steal until every deque is */
+    for(victim = worker->id + 1; tried < batch->workers; ++victim)
+    {
+        victim %= batch->workers;
+        if(StealTop(&batch->deques[victim], &task))
+        {
+            RunTask(batch, ctx, task);
+            tried = 0;
+        }
+        else
+        {
+            ++tried;
+        }
+    }
+
+    if(NULL != ctx)
+    {
+        CalcCtxDestroy(ctx);
+    }
+
+    return NULL;
+}
+
+static unsigned OnlineCpus(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cpus < 1 ? 1 : (unsigned)cpus;
+}
+
+status_t CalculateBatch(const char* const* exprs, size_t n, double* results,
+                                    status_t* statuses, unsigned threads)
+{
+    batch_t batch;
+    worker_t* workers = NULL;
+    void* deques = NULL;
+    size_t tasks = 0;
+    unsigned i = 0;
+
+    assert(exprs || 0 == n);
+    assert(results || 0 == n);
+    assert(statuses || 0 == n);
+
+    threads = 0 == threads ? OnlineCpus() : threads;
+    threads = threads > n ? (unsigned)n : threads;
+    threads = 0 == threads ? 1 : threads;
+
+    batch.exprs = exprs;
+    batch.n = n;
+    batch.results = results;
+    batch.statuses = statuses;
+    batch.workers = threads;
+    batch.task_size = n / ((size_t)threads * TASKS_PER_WORKER);
+    batch.task_size = 0 == batch.task_size ? 1 : batch.task_size;
+    while((n + batch.task_size - 1) / batch.task_size > RANGE_MASK)
+    {
+        batch.task_size *= 2;
+    }
+    tasks = (n + batch.task_size - 1) / batch.task_size;
+
+    if(0 != posix_memalign(&deques, CACHE_LINE, threads * sizeof(deque_t)))
+    {
+        return FAILED_ALLOCATION;
+    }
+    batch.deques = (deque_t*)deques;
+    workers = (worker_t*)malloc(threads * sizeof(worker_t));
+    if(NULL == workers)
+    {
+        free(deques);
+        return FAILED_ALLOCATION;
+    }
+
+    /* every worker starts with an equal, contiguous share of the tasks */
+    for(i = 0; i < threads; ++i)
+    {
+        batch.deques[i].range = Pack(tasks * i / threads,
+                                                    tasks * (i + 1) / threads);
+        workers[i].batch = &batch;
+        workers[i].id = i;
+        workers[i].started = 0;
+    }
+
+    /* the calling thread is worker 0; work of threads that fail to start is
+       stolen by the others */
+    for(i = 1; i < threads; ++i)
+    {
+        workers[i].started = 0 == pthread_create(&workers[i].thread, NULL,
+                                                    WorkerMain, &workers[i]);
+    }
+
+    WorkerMain(&workers[0]);
+
+    for(i = 1; i < threads; ++i)
+    {
+        if(workers[i].started)
+        {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    free(workers);
+    free(batch.deques);
+
+    return SUCCESS;
+}
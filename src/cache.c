@@ -0,0 +1,323 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>   /* malloc, calloc, free */
+#include <string.h>   /* memcmp, memcpy */
+#include <assert.h>   /* assert */
+#include <pthread.h>  /* pthread_rwlock_t */
+
+#include "calc_cache.h"
+
+#define WAYS 8
+#define KEY_SIZE 108
+#define MAX_STRIPES 64
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+
+/* 128 bytes, two cache lines per entry */
+typedef struct entry
+{
+    unsigned long hash;
+    double value;
+    unsigned short key_len;     /* 0 for an empty slot */
+    unsigned char status;
+    unsigned char referenced;   /* CLOCK reference bit */
+    char key[KEY_SIZE];
+} entry_t;
+
+/* a set of WAYS entries, evicted among themselves by CLOCK */
+typedef struct bucket
+{
+    entry_t entries[WAYS];
+    unsigned int hand;
+} bucket_t;
+
+typedef struct stripe
+{
+    pthread_rwlock_t lock;
+    size_t hits;
+    size_t misses;
+    size_t evictions;
+    char padding[64];
+} stripe_t;
+
+struct calc_cache
+{
+    bucket_t* buckets;
+    size_t num_buckets;
+    stripe_t* stripes;
+    size_t num_stripes;
+};
+
+/* the lexer's classes, which do not depend on the locale */
+static int IsSpace(char c)
+{
+    return ' ' == c || ('\t' <= c && c <= '\r');
+}
+
+static int IsWordChar(char c)
+{
+    return ('0' <= c && c <= '9') || ('a' <= c && c <= 'z') ||
+                    ('A' <= c && c <= 'Z') || '_' == c || '.' == c;
+}
+
+static int IsExponentChar(char c)
+{
+    return 'e' == c || 'E' == c || 'p' == c || 'P' == c;
+}
+
+/* Whitespace between two characters is kept (as one space) only where
+   removing it could join two tokens: two word characters, or around the
+   sign of what could be read as an exponent ("1e +5", "1e+ 5").
+   Returns the key length, 0 if it is empty or does not fit in KEY_SIZE. */
+static size_t Normalize(const char* str, char* key)
+{
+    size_t len = 0;
+    int pending_space = 0;
+    char prev = '\0';
+    char prev_prev = '\0';
+
+    for( ; '\0' != *str; ++str)
+    {
+        if(IsSpace(*str))
+        {
+            pending_space = 0 < len;
+            continue;
+        }
+
+        if(pending_space &&
+            ((IsWordChar(prev) && IsWordChar(*str)) ||
+             (IsExponentChar(prev) && ('+' == *str || '-' == *str)) ||
+             (('+' == prev || '-' == prev) && IsExponentChar(prev_prev) &&
+                                                        IsWordChar(*str))))
+        {
+            if(len == KEY_SIZE)
+            {
+                return 0;
+            }
+            key[len++] = ' ';
+        }
+
+        if(len == KEY_SIZE)
+        {
+            return 0;
+        }
+
+        key[len++] = *str;
+        prev_prev = prev;
+        prev = *str;
+        pending_space = 0;
+    }
+
+    return len;
+}
+
+static unsigned long Hash(const char* key, size_t len)
+{
+    unsigned long hash = FNV_OFFSET;
+    size_t i = 0;
+
+    for( ; i < len; ++i)
+    {
+        hash = ((hash ^ (unsigned char)key[i]) * FNV_PRIME) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+static entry_t* Find(bucket_t* bucket, unsigned long hash, const char* key,
+                                                                size_t len)
+{
+    size_t i = 0;
+
+    for( ; i < WAYS; ++i)
+    {
+        entry_t* entry = &bucket->entries[i];
+
+        if(entry->hash == hash && entry->key_len == len &&
+                                            0 == memcmp(entry->key, key, len))
+        {
+            return entry;
+        }
+    }
+
+    return NULL;
+}
+
+/* CLOCK: take an empty slot, otherwise sweep the hand clearing reference
+   bits until an unreferenced entry is found */
+static entry_t* Victim(bucket_t* bucket, int* evicted)
+{
+    entry_t* entry = NULL;
+    size_t i = 0;
+
+    for( ; i < WAYS; ++i)
+    {
+        if(0 == bucket->entries[i].key_len)
+        {
+            *evicted = 0;
+            return &bucket->entries[i];
+        }
+    }
+
+    for(;;)
+    {
+        entry = &bucket->entries[bucket->hand];
+        bucket->hand = (bucket->hand + 1) % WAYS;
+
+        if(!__atomic_load_n(&entry->referenced, __ATOMIC_RELAXED))
+        {
+            *evicted = 1;
+            return entry;
+        }
+
+        __atomic_store_n(&entry->referenced, 0, __ATOMIC_RELAXED);
+    }
+}
+
+calc_cache_t* CalcCacheCreate(size_t max_entries)
+{
+    calc_cache_t* cache = (calc_cache_t*)malloc(sizeof(calc_cache_t));
+    size_t i = 0;
+
+    if(NULL == cache)
+    {
+        return NULL;
+    }
+
+    cache->num_buckets = (max_entries + WAYS - 1) / WAYS;
+    cache->num_buckets = 0 == cache->num_buckets ? 1 : cache->num_buckets;
+    cache->num_stripes = cache->num_buckets < MAX_STRIPES ?
+                                            cache->num_buckets : MAX_STRIPES;
+    cache->buckets = (bucket_t*)calloc(cache->num_buckets, sizeof(bucket_t));
+    cache->stripes = (stripe_t*)calloc(cache->num_stripes, sizeof(stripe_t));
+    if(NULL == cache->buckets || NULL == cache->stripes)
+    {
+        free(cache->buckets);
+        free(cache->stripes);
+        free(cache);
+        return NULL;
+    }
+
+    for( ; i < cache->num_stripes; ++i)
+    {
+        pthread_rwlock_init(&cache->stripes[i].lock, NULL);
+    }
+
+    return cache;
+}
+
+void CalcCacheDestroy(calc_cache_t* cache)
+{
+    size_t i = 0;
+
+    assert(cache);
+
+    for( ; i < cache->num_stripes; ++i)
+    {
+        pthread_rwlock_destroy(&cache->stripes[i].lock);
+    }
+
+    free(cache->buckets);
+    free(cache->stripes);
+    free(cache);
+}
+
+status_t CalculateCached(calc_cache_t* cache, const char* str, double* ans)
+{
+    char key[KEY_SIZE];
+    size_t len = 0;
+    unsigned long hash = 0;
+    bucket_t* bucket = NULL;
+    stripe_t* stripe = NULL;
+    entry_t* entry = NULL;
+    status_t status = SUCCESS;
+    double value = 0;
+    int evicted = 0;
+
+    assert(cache);
+    assert(str);
+    assert(ans);
+
+    /* empty and over-long expressions are not cached */
+    len = Normalize(str, key);
+    if(0 == len)
+    {
+        status = Calculate(str, ans);
+        __atomic_add_fetch(&cache->stripes[0].misses, 1, __ATOMIC_RELAXED);
+        return status;
+    }
+
+    hash = Hash(key, len);
+    bucket = &cache->buckets[hash % cache->num_buckets];
+    stripe = &cache->stripes[hash % cache->num_buckets % cache->num_stripes];
+
+    pthread_rwlock_rdlock(&stripe->lock);
+    entry = Find(bucket, hash, key, len);
+    if(NULL != entry)
+    {
+        __atomic_store_n(&entry->referenced, 1, __ATOMIC_RELAXED);
+        status = (status_t)entry->status;
+        value = entry->value;
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    if(NULL != entry)
+    {
+        __atomic_add_fetch(&stripe->hits, 1, __ATOMIC_RELAXED);
+        if(SUCCESS == status)
+        {
+            *ans = value;
+        }
+        return status;
+    }
+
+    __atomic_add_fetch(&stripe->misses, 1, __ATOMIC_RELAXED);
+    status = Calculate(str, &value);
+    if(FAILED_ALLOCATION == status)
+    {
+        return status;
+    }
+
+    pthread_rwlock_wrlock(&stripe->lock);
+    if(NULL == Find(bucket, hash, key, len))
+    {
+        entry = Victim(bucket, &evicted);
+        entry->hash = hash;
+        entry->value = value;
+        entry->key_len = (unsigned short)len;
+        entry->status = (unsigned char)status;
+        entry->referenced = 0;
+        memcpy(entry->key, key, len);
+        __atomic_add_fetch(&stripe->evictions, evicted, __ATOMIC_RELAXED);
+    }
+    pthread_rwlock_unlock(&stripe->lock);
+
+    if(SUCCESS == status)
+    {
+        *ans = value;
+    }
+
+    return status;
+}
+
+void CalcCacheGetStats(const calc_cache_t* cache, calc_cache_stats_t* stats)
+{
+    size_t i = 0;
+
+    assert(cache);
+    assert(stats);
+
+    stats->hits = 0;
+    stats->misses = 0;
+    stats->evictions = 0;
+
+    for( ; i < cache->num_stripes; ++i)
+    {
+        stats->hits += __atomic_load_n(&cache->stripes[i].hits,
+                                                            __ATOMIC_RELAXED);
+        stats->misses += __atomic_load_n(&cache->stripes[i].misses,
+                                                            __ATOMIC_RELAXED);
+        stats->evictions += __atomic_load_n(&cache->stripes[i].evictions,
+                                                            __ATOMIC_RELAXED);
+    }
+}
@@ -1,13 +1,30 @@
-#include <string.h>  /* strlen */
+#include <string.h>  /* strlen, memset */
 #include <assert.h>  /* assert */
-#include <ctype.h>   /* isspace */
-#include <stdlib.h>  /* strtod */
+#include <stdlib.h>  /* malloc, free */
 #include <stddef.h>  /* size_t */
+#include <limits.h>  /* LONG_MAX, LONG_MIN, CHAR_BIT */
 
 #include "calculator.h"
-#include "stack.h"
-
-#define ASCII_SIZE 255
+#include "typed_stack.h"
+#include "program.h"
+#include "power.h"
+#include "lexer.h"
+#include "stats.h"
+#include "functions.h"
+
+#define ASCII_SIZE 256
+#define MIN_CTX_CAPACITY 64
+#define INLINE_STACK_CAPACITY 32
+#define TOKEN_BLOCK 64
+#define MAX_EXACT_INTEGER 9007199254740992.0    /* 2^53 */
+#define BRACKET_BITS 2          /* per bracket kind CalcValidate keeps */
+
+/* -DCALC_STATS compiles in the counters read by CalcGetStats */
+#ifdef CALC_STATS
+#define STATS(statement) statement
+#else
+#define STATS(statement)
+#endif
 
 typedef enum
 {
@@ -15,6 +32,7 @@ typedef enum
     WAIT_FOR_OPERATOR,
     WAIT_FOR_NUMBER,
     ERROR,
+    WAIT_FOR_CALL,      /* a function name was read, '(' must follow */
     NUM_OF_STATE
 } State;
 
@@ -31,561 +49,1747 @@ typedef enum
     CLOSE_BRACKETS,
     OTHER,
     DIGIT,
+    LETTER,
+    COMMA,
+    FUNCTION,       /* a function name; on the stack, the call it opened */
     NUM_OF_INPUTS
 } Input;
 
-typedef status_t (*relations_handler)(Input, stack_t*, stack_t*);
-typedef status_t (*action_func)(const char**, stack_t*, stack_t*);
-typedef status_t (*operate_func)(stack_t*);
-typedef status_t (*finalize_state_func)(double*, stack_t*, stack_t*);
+typedef struct call
+{
+    function_t function;
+    int has_args;   /* a comma was read, so the call can be closed */
+} call_t;
 
-static State transition_LUT[NUM_OF_STATE][NUM_OF_INPUTS];
-static Input input_LUT[ASCII_SIZE];
-static action_func action_funcs[NUM_OF_STATE][NUM_OF_STATE];
-static relations_handler relations_LUT[NUM_OF_INPUTS][NUM_OF_INPUTS];
-static operate_func operation_funcs_LUT[NUM_OF_INPUTS];
-static Input repeat_input_LUT[NUM_OF_INPUTS];
-static finalize_state_func finalize_state_LUT[NUM_OF_STATE];
+DEFINE_TYPED_STACK(DoubleStack, double_stack_t, double, INLINE_STACK_CAPACITY)
+DEFINE_TYPED_STACK(OperatorStack, operator_stack_t, Input,
+                                                        INLINE_STACK_CAPACITY)
+DEFINE_TYPED_STACK(IntegerStack, integer_stack_t, long, INLINE_STACK_CAPACITY)
+DEFINE_TYPED_STACK(CallStack, call_stack_t, call_t, INLINE_STACK_CAPACITY)
 
-static void InitTransitionLUT(void)
+typedef struct calc
 {
-    size_t i = 0;
+    double_stack_t* numbers;
+    operator_stack_t* operators;
+    call_stack_t* calls;        /* one per FUNCTION on the operators stack */
+    calc_program_t* program;    /* NULL when evaluating in place */
+    integer_stack_t* integers;  /* the values while they are all integers,
+                                   NULL once one is not or when not exact */
+#ifdef CALC_STATS
+    stats_run_t run;
+#endif
+} calc_t;
+
+struct calc_ctx
+{
+    calc_allocator_t allocator;
+    calc_alloc_counters_t counters;
+    void* buffer;
+    size_t capacity;
+#ifdef CALC_STATS
+    calc_stats_t stats;
+#endif
+};
+
+#ifdef CALC_STATS
+static calc_stats_t global_stats;   /* calls made without a context */
+#endif
+
+typedef enum
+{
+    REJECT,
+    PUSH,
+    POP,
+    EXECUTE,
+    ARGUMENT,   /* a comma closes an argument of the call on top */
+    CALL_END,
+    NUM_OF_RELATIONS
+} Relation;
+
+/* All tables are read-only data, so Calculate is reentrant. The dense tables
+   hold small integer codes (one byte each) that index the handler tables. */
+
+#define OT OTHER
+#define DG DIGIT
+#define LT LETTER
+
+static const unsigned char input_LUT[ASCII_SIZE] =
+{
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0x00 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0x10 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OPEN_BRACKETS, CLOSE_BRACKETS,  /* 0x20 */
+    MULT, PLUS, COMMA, MINUS, DG, DIV,
+    DG, DG, DG, DG, DG, DG, DG, DG, DG, DG, OT, OT, OT, OT, OT, OT, /* 0x30 */
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, /* 0x40 */
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, POWER, LT,/*0x50*/
+    OT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, /* 0x60 */
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, OT, OT, OT, OT, OT, /* 0x70 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0x80 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0x90 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0xA0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0xB0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0xC0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0xD0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, /* 0xE0 */
+    OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT, OT  /* 0xF0 */
+};
+
+#undef OT
+#undef DG
+#undef LT
+
+static const unsigned char token_input_LUT[NUM_OF_TOKEN_KINDS] =
+{
+    DIGIT, LETTER, OTHER, OTHER     /* symbols are looked up in input_LUT */
+};
+
+static const unsigned char repeat_input_LUT[NUM_OF_INPUTS] =
+{
+    UNARY_PLUS, OTHER, UNARY_MINUS, OTHER, OTHER, OTHER, OTHER,
+    OPEN_BRACKETS, OTHER, OTHER, OTHER, OTHER, OTHER, OTHER
+};
+
+/* Row is the operator on top of the stack, column is the incoming input:
+   PLUS, UNARY_PLUS, MINUS, UNARY_MINUS, MULT, DIV, POWER, OPEN_BRACKETS,
+   CLOSE_BRACKETS, OTHER, DIGIT, LETTER, COMMA, FUNCTION */
+
+static const unsigned char relations_LUT[NUM_OF_INPUTS][NUM_OF_INPUTS] =
+{
+    /* PLUS */
+    {EXECUTE, PUSH, EXECUTE, PUSH, PUSH, PUSH, PUSH, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* UNARY_PLUS */
+    {EXECUTE, PUSH, EXECUTE, PUSH, EXECUTE, EXECUTE, PUSH, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* MINUS */
+    {EXECUTE, PUSH, EXECUTE, PUSH, PUSH, PUSH, PUSH, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* UNARY_MINUS */
+    {EXECUTE, PUSH, EXECUTE, PUSH, EXECUTE, EXECUTE, PUSH, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* MULT */
+    {EXECUTE, PUSH, EXECUTE, PUSH, EXECUTE, EXECUTE, PUSH, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* DIV */
+    {EXECUTE, PUSH, EXECUTE, PUSH, EXECUTE, EXECUTE, PUSH, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* POWER */
+    {EXECUTE, PUSH, EXECUTE, PUSH, EXECUTE, EXECUTE, EXECUTE, PUSH, EXECUTE,
+     REJECT, REJECT, REJECT, EXECUTE, PUSH},
+    /* OPEN_BRACKETS */
+    {PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, POP,
+     REJECT, REJECT, REJECT, REJECT, PUSH},
+    /* CLOSE_BRACKETS */
+    {REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT,
+     REJECT, REJECT, REJECT, REJECT, REJECT},
+    /* OTHER (bottom of the operators stack) */
+    {PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, REJECT,
+     REJECT, REJECT, REJECT, REJECT, PUSH},
+    /* DIGIT */
+    {REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT,
+     REJECT, REJECT, REJECT, REJECT, REJECT},
+    /* LETTER */
+    {REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT,
+     REJECT, REJECT, REJECT, REJECT, REJECT},
+    /* COMMA */
+    {REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT, REJECT,
+     REJECT, REJECT, REJECT, REJECT, REJECT},
+    /* FUNCTION (an open call, which brackets its arguments) */
+    {PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, PUSH, CALL_END,
+     REJECT, REJECT, REJECT, ARGUMENT, PUSH}
+};
+
+static const unsigned char opcode_LUT[NUM_OF_INPUTS] =
+{
+    OP_ADD, NUM_OF_OPCODES, OP_SUB, OP_NEG, OP_MUL, OP_DIV, OP_POW,
+    NUM_OF_OPCODES, NUM_OF_OPCODES, NUM_OF_OPCODES, NUM_OF_OPCODES,
+    NUM_OF_OPCODES, NUM_OF_OPCODES, NUM_OF_OPCODES
+};
 
-    transition_LUT[START][DIGIT] = WAIT_FOR_OPERATOR;
-    transition_LUT[START][PLUS] = WAIT_FOR_NUMBER;
-    transition_LUT[START][MINUS] = WAIT_FOR_NUMBER;
-    transition_LUT[START][MULT] = ERROR;
-    transition_LUT[START][DIV] = ERROR;
-    transition_LUT[START][POWER] = ERROR;
-    transition_LUT[START][OPEN_BRACKETS] = START;
-    transition_LUT[START][CLOSE_BRACKETS] = ERROR;
-    transition_LUT[START][OTHER] = ERROR;
+#ifdef CALC_STATS
 
-    transition_LUT[WAIT_FOR_OPERATOR][DIGIT] = ERROR;
-    transition_LUT[WAIT_FOR_OPERATOR][PLUS] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_OPERATOR][MINUS] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_OPERATOR][MULT] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_OPERATOR][DIV] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_OPERATOR][POWER] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_OPERATOR][OPEN_BRACKETS] = ERROR;
-    transition_LUT[WAIT_FOR_OPERATOR][CLOSE_BRACKETS] = WAIT_FOR_OPERATOR;
-    transition_LUT[WAIT_FOR_OPERATOR][OTHER] = ERROR;
+static const unsigned char stats_operator_LUT[NUM_OF_INPUTS] =
+{
+    CALC_ADD, CALC_PLUS, CALC_SUB, CALC_NEG, CALC_MUL, CALC_DIV, CALC_POW,
+    CALC_NUM_OF_OPERATORS, CALC_NUM_OF_OPERATORS, CALC_NUM_OF_OPERATORS,
+    CALC_NUM_OF_OPERATORS, CALC_NUM_OF_OPERATORS, CALC_NUM_OF_OPERATORS,
+    CALC_NUM_OF_OPERATORS
+};
 
-    transition_LUT[WAIT_FOR_NUMBER][DIGIT] = WAIT_FOR_OPERATOR;
-    transition_LUT[WAIT_FOR_NUMBER][PLUS] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_NUMBER][MINUS] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_NUMBER][MULT] = ERROR;
-    transition_LUT[WAIT_FOR_NUMBER][DIV] = ERROR;
-    transition_LUT[WAIT_FOR_NUMBER][POWER] = ERROR;
-    transition_LUT[WAIT_FOR_NUMBER][OPEN_BRACKETS] = WAIT_FOR_NUMBER;
-    transition_LUT[WAIT_FOR_NUMBER][CLOSE_BRACKETS] = ERROR;
-    transition_LUT[WAIT_FOR_NUMBER][OTHER] = ERROR; 
+static void CountOperator(stats_run_t* run, Input op)
+{
+    if(CALC_NUM_OF_OPERATORS != stats_operator_LUT[op])
+    {
+        ++run->operators[stats_operator_LUT[op]];
+    }
+}
 
-    for( ; i < NUM_OF_INPUTS; ++i)
+static void CountDepth(size_t* max_depth, size_t depth)
+{
+    if(depth > *max_depth)
     {
-        transition_LUT[ERROR][i] = ERROR;
+        *max_depth = depth;
     }
 }
 
-static void InitInputLUT(void)
+#endif      /* CALC_STATS */
+
+/* Row is the state, column is the incoming input. The table-driven core and
+   CalcValidate follow it; the threaded core has it in its jump targets */
+
+static const unsigned char transition_LUT[NUM_OF_STATE][NUM_OF_INPUTS] =
+{
+    /* START */
+    {WAIT_FOR_NUMBER, ERROR, WAIT_FOR_NUMBER, ERROR, ERROR, ERROR, ERROR,
+     START, ERROR, ERROR, WAIT_FOR_OPERATOR, WAIT_FOR_OPERATOR, ERROR,
+     WAIT_FOR_CALL},
+    /* WAIT_FOR_OPERATOR */
+    {WAIT_FOR_NUMBER, ERROR, WAIT_FOR_NUMBER, ERROR, WAIT_FOR_NUMBER,
+     WAIT_FOR_NUMBER, WAIT_FOR_NUMBER, ERROR, WAIT_FOR_OPERATOR, ERROR,
+     ERROR, ERROR, WAIT_FOR_NUMBER, ERROR},
+    /* WAIT_FOR_NUMBER */
+    {WAIT_FOR_NUMBER, ERROR, WAIT_FOR_NUMBER, ERROR, ERROR, ERROR, ERROR,
+     WAIT_FOR_NUMBER, ERROR, ERROR, WAIT_FOR_OPERATOR, WAIT_FOR_OPERATOR,
+     ERROR, WAIT_FOR_CALL},
+    /* ERROR */
+    {ERROR, ERROR, ERROR, ERROR, ERROR, ERROR, ERROR, ERROR, ERROR, ERROR,
+     ERROR, ERROR, ERROR, ERROR},
+    /* WAIT_FOR_CALL */
+    {ERROR, ERROR, ERROR, ERROR, ERROR, ERROR, ERROR, WAIT_FOR_NUMBER, ERROR,
+     ERROR, ERROR, ERROR, ERROR, ERROR}
+};
+
+/* -DCALC_FSM_TABLES builds the table-driven FSM core, where each token goes
+   through the action, relations and operation handler tables; by default
+   the threaded core further down is used */
+#ifdef CALC_FSM_TABLES
+
+typedef enum
+{
+    READ_OPERATOR,
+    READ_OPERAND,
+    REPEAT_NUMBER,
+    REPEAT_OPERATOR,
+    SYNTAX_ERROR,
+    READ_FUNCTION,
+    OPEN_CALL,
+    NUM_OF_ACTIONS
+} Action;
+
+typedef status_t (*relations_handler)(Input, calc_t*);
+typedef status_t (*action_func)(const token_t*, calc_t*);
+typedef status_t (*operate_func)(double_stack_t*);
+typedef status_t (*finalize_state_func)(double*, calc_t*);
+
+static const unsigned char action_LUT[NUM_OF_STATE][NUM_OF_STATE] =
+{
+    /* START */
+    {READ_OPERATOR, READ_OPERAND, REPEAT_OPERATOR, SYNTAX_ERROR,
+     READ_FUNCTION},
+    /* WAIT_FOR_OPERATOR */
+    {SYNTAX_ERROR, REPEAT_NUMBER, READ_OPERATOR, SYNTAX_ERROR, SYNTAX_ERROR},
+    /* WAIT_FOR_NUMBER */
+    {SYNTAX_ERROR, READ_OPERAND, REPEAT_OPERATOR, SYNTAX_ERROR,
+     READ_FUNCTION},
+    /* ERROR */
+    {SYNTAX_ERROR, SYNTAX_ERROR, SYNTAX_ERROR, SYNTAX_ERROR, SYNTAX_ERROR},
+    /* WAIT_FOR_CALL */
+    {SYNTAX_ERROR, SYNTAX_ERROR, OPEN_CALL, SYNTAX_ERROR, SYNTAX_ERROR}
+};
+
+static status_t HandleReadingOperator(const token_t* token, calc_t* calc);
+static status_t HandleReadingOperand(const token_t* token, calc_t* calc);
+static status_t HandleRepeatNumber(const token_t* token, calc_t* calc);
+static status_t HandleRepeatOperator(const token_t* token, calc_t* calc);
+static status_t HandleSyntaxError(const token_t* token, calc_t* calc);
+static status_t HandleReadingCall(const token_t* token, calc_t* calc);
+static status_t HandleOpenCall(const token_t* token, calc_t* calc);
+static status_t HandleInvalidSyntax(Input input, calc_t* calc);
+static status_t HandlePushOperator(Input input, calc_t* calc);
+static status_t HandlePopOperator(Input input, calc_t* calc);
+static status_t HandleExecuteOldOperator(Input input, calc_t* calc);
+static status_t HandleArgument(Input input, calc_t* calc);
+static status_t HandleCallEnd(Input input, calc_t* calc);
+static status_t AddHandler(double_stack_t* numbers);
+static status_t UnaryPlusHandler(double_stack_t* numbers);
+static status_t SubHandler(double_stack_t* numbers);
+static status_t UnaryMinusHandler(double_stack_t* numbers);
+static status_t MultiplyHandler(double_stack_t* numbers);
+static status_t DivideHandler(double_stack_t* numbers);
+static status_t PowerHandler(double_stack_t* numbers);
+static status_t OpenBracketErrorHandler(double_stack_t* numbers);
+static status_t FsmReject(double* ans, calc_t* calc);
+static status_t CalculateAll(double* ans, calc_t* calc);
+
+static const action_func action_funcs[NUM_OF_ACTIONS] =
+{
+    HandleReadingOperator,
+    HandleReadingOperand,
+    HandleRepeatNumber,
+    HandleRepeatOperator,
+    HandleSyntaxError,
+    HandleReadingCall,
+    HandleOpenCall
+};
+
+static const relations_handler relations_funcs[NUM_OF_RELATIONS] =
+{
+    HandleInvalidSyntax,
+    HandlePushOperator,
+    HandlePopOperator,
+    HandleExecuteOldOperator,
+    HandleArgument,
+    HandleCallEnd
+};
+
+static const operate_func operation_funcs_LUT[NUM_OF_INPUTS] =
+{
+    AddHandler,
+    UnaryPlusHandler,
+    SubHandler,
+    UnaryMinusHandler,
+    MultiplyHandler,
+    DivideHandler,
+    PowerHandler,
+    OpenBracketErrorHandler,    /* only brackets and calls are left open */
+    OpenBracketErrorHandler,
+    OpenBracketErrorHandler,
+    OpenBracketErrorHandler,
+    OpenBracketErrorHandler,
+    OpenBracketErrorHandler,
+    OpenBracketErrorHandler
+};
+
+static const finalize_state_func finalize_state_LUT[NUM_OF_STATE] =
+{
+    FsmReject,      /* START */
+    CalculateAll,   /* WAIT_FOR_OPERATOR */
+    FsmReject,      /* WAIT_FOR_NUMBER */
+    FsmReject,      /* ERROR */
+    FsmReject       /* WAIT_FOR_CALL */
+};
+
+#endif      /* CALC_FSM_TABLES */
+
+/* The FSM takes its tokens from here, one block at a time */
+static size_t LexTokens(lexer_t* lexer, token_t* tokens, calc_t* calc)
 {
+#ifdef CALC_STATS
+    const char* start = lexer->str;
+    size_t num_tokens = LexerNext(lexer, tokens, TOKEN_BLOCK);
     size_t i = 0;
 
-    for( ; i < ASCII_SIZE; ++i)
+    calc->run.tokens += num_tokens;
+    calc->run.whitespace_bytes += lexer->str - start;
+    for( ; i < num_tokens; ++i)
+    {
+        calc->run.whitespace_bytes -= tokens[i].end - tokens[i].start;
+    }
+
+    return num_tokens;
+#else
+    (void)calc;
+
+    return LexerNext(lexer, tokens, TOKEN_BLOCK);
+#endif
+}
+
+static Input TokenInput(const token_t* token)
+{
+    if(TOKEN_NAME == token->kind && NUM_OF_FUNCTIONS !=
+                FindFunction(token->start, token->end - token->start))
+    {
+        return FUNCTION;
+    }
+
+    return (Input)(TOKEN_SYMBOL == token->kind ?
+                                input_LUT[(unsigned char)*token->start] :
+                                            token_input_LUT[token->kind]);
+}
+
+/* A number is an integer if its value is; past 2^53 the value may be
+   rounded, so only plain digits that fit a long are */
+static int ParseInteger(const token_t* token, long* integer)
+{
+    const char* str = token->start;
+
+    if(token->value < MAX_EXACT_INTEGER && token->value < LONG_MAX)
     {
-        input_LUT[i] = OTHER;
+        *integer = (long)token->value;
+
+        return *integer == token->value;
     }
 
-    for(i = '0'; i <= '9'; ++i)
+    for(*integer = 0; str < token->end; ++str)
     {
-        input_LUT[i] = DIGIT;
+        if(*str < '0' || *str > '9' ||
+                            __builtin_mul_overflow(*integer, 10, integer) ||
+                        __builtin_add_overflow(*integer, *str - '0', integer))
+        {
+            return 0;
+        }
     }
 
-    input_LUT['.'] = DIGIT;
-    input_LUT['+'] = PLUS;
-    input_LUT['-'] = MINUS;
-    input_LUT['*'] = MULT;
-    input_LUT['/'] = DIV;
-    input_LUT['^'] = POWER;
-    input_LUT['('] = OPEN_BRACKETS;
-    input_LUT[')'] = CLOSE_BRACKETS;
+    return 1;
 }
 
-static void InitRepeatInputLUT(void)
+/* base ^ exponent by repeated squaring, 0 on overflow or a negative
+   exponent, which are left to Power */
+static int IntegerPower(long base, long exponent, long* result)
 {
+    *result = 1;
+    if(exponent < 0)
+    {
+        return 0;
+    }
+
+    while(exponent > 0)
+    {
+        if((exponent & 1) && __builtin_mul_overflow(*result, base, result))
+        {
+            return 0;
+        }
+
+        exponent >>= 1;
+        if(exponent > 0 && __builtin_mul_overflow(base, base, &base))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+/* @return value: 1 if op was applied exactly, 0 leaving the stack as it was
+                  on overflow, an inexact division or anything else Power
+                  and the double handlers have to decide */
+static int ApplyInteger(Input op, integer_stack_t* integers)
+{
+    long* left = NULL;
+    long right = 0;
+    long result = 0;
+    int exact = 0;
+
+    if(UNARY_PLUS == op)
+    {
+        return 1;
+    }
+
+    if(UNARY_MINUS == op)
+    {
+        left = IntegerStackTop(integers);
+        exact = LONG_MIN != *left;
+        *left = exact ? -*left : *left;
+
+        return exact;
+    }
+
+    if(IntegerStackSize(integers) < 2)
+    {
+        return 0;
+    }
+
+    right = IntegerStackPeek(integers);
+    left = IntegerStackTop(integers) - 1;
+
+    switch(op)
+    {
+        case PLUS:
+            exact = !__builtin_add_overflow(*left, right, &result);
+            break;
+
+        case MINUS:
+            exact = !__builtin_sub_overflow(*left, right, &result);
+            break;
+
+        case MULT:
+            exact = !__builtin_mul_overflow(*left, right, &result);
+            break;
+
+        case DIV:
+            exact = 0 != right && !(LONG_MIN == *left && -1 == right) &&
+                                                        0 == *left % right;
+            result = exact ? *left / right : 0;
+            break;
+
+        case POWER:
+            exact = IntegerPower(*left, right, &result);
+            break;
+
+        default:
+            break;
+    }
+
+    if(exact)
+    {
+        IntegerStackPop(integers);
+        *left = result;
+    }
+
+    return exact;
+}
+
+/* the first value that is not an integer moves every value to the
+   numbers stack, and evaluation goes on in doubles */
+static status_t LeaveIntegers(calc_t* calc)
+{
+    const integer_stack_t* integers = calc->integers;
     size_t i = 0;
 
-    for( ; i < NUM_OF_INPUTS; ++i)
+    calc->integers = NULL;
+    for( ; i < IntegerStackSize(integers); ++i)
     {
-        repeat_input_LUT[i] = OTHER;
+        if(!DoubleStackPush(calc->numbers, (double)integers->data[i]))
+        {
+            return FAILED_ALLOCATION;
+        }
     }
 
-    repeat_input_LUT[PLUS] = UNARY_PLUS;
-    repeat_input_LUT[MINUS] = UNARY_MINUS;
-    repeat_input_LUT[OPEN_BRACKETS] = OPEN_BRACKETS;
+    return SUCCESS;
 }
 
-static void StackPeekPop(stack_t* stack, void* element)
+static double Answer(const calc_t* calc)
 {
-    StackPeek(stack, element);
-    StackPop(stack);
+    return NULL != calc->integers ? (double)IntegerStackPeek(calc->integers) :
+                                            DoubleStackPeek(calc->numbers);
 }
 
-static status_t HandleReadingNumber(const char** str, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandleReadingNumber(const token_t* token, calc_t* calc)
 {
-    double result = 0;
-    char* runner;
-    (void)operators;
+    long integer = 0;
+    status_t status = SUCCESS;
 
-    result = strtod(*str, &runner);
-    StackPush(numbers, &result);
-    *str = runner;
+    STATS(++calc->run.numbers);
+
+    if(NULL != calc->program)
+    {
+        return ProgramEmitConstant(calc->program, token->value);
+    }
+
+    if(NULL != calc->integers)
+    {
+        if(ParseInteger(token, &integer))
+        {
+            if(!IntegerStackPush(calc->integers, integer))
+            {
+                return FAILED_ALLOCATION;
+            }
+            STATS(CountDepth(&calc->run.max_numbers_depth,
+                                        IntegerStackSize(calc->integers)));
+
+            return SUCCESS;
+        }
+
+        status = LeaveIntegers(calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+    }
+
+    if(!DoubleStackPush(calc->numbers, token->value))
+    {
+        return FAILED_ALLOCATION;
+    }
+    STATS(CountDepth(&calc->run.max_numbers_depth,
+                                            DoubleStackSize(calc->numbers)));
 
     return SUCCESS;
 }
 
-static status_t HandleReadingOperator(const char** str, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandleReadingVariable(const token_t* token, calc_t* calc)
 {
-    Input stack_top;
-    status_t status;
-    Input curr_input = input_LUT[(unsigned char)**str];
-    
-    StackPeek(operators, &stack_top);
-    status = relations_LUT[stack_top][curr_input](curr_input, numbers,
-                                                                    operators);
+    if(NULL == calc->program)
+    {
+        return INVALID_SYNTAX;
+    }
 
-    ++(*str);
+    return ProgramEmitVariable(calc->program, token->start,
+                                                    token->end - token->start);
+}
 
-    return status;
+/* the call goes on the calls stack, its FUNCTION marker on the operators
+   stack, where it brackets the arguments like '(' */
+static status_t HandleReadingCall(const token_t* token, calc_t* calc)
+{
+    call_t call;
+
+    call.function = FindFunction(token->start, token->end - token->start);
+    call.has_args = 0;
+    if(!CallStackPush(calc->calls, call) ||
+                                !OperatorStackPush(calc->operators, FUNCTION))
+    {
+        return FAILED_ALLOCATION;
+    }
+    STATS(CountDepth(&calc->run.max_operators_depth,
+                                    OperatorStackSize(calc->operators) - 1));
+
+    return SUCCESS;
 }
 
-static status_t HandleRepeatNumber(const char** str, stack_t* numbers,
-                                                            stack_t* operators)
+/* min and max of integers stay exact, the other functions leave them */
+static status_t ApplyCall(function_t function, calc_t* calc)
 {
-    Input stack_top;
-    Input curr_input = input_LUT[(unsigned char)**str];
+    long right = 0;
+    long* left = NULL;
+    double b = 0;
+    double* a = NULL;
+    status_t status = SUCCESS;
 
-    StackPeek(operators, &stack_top);
-    ++(*str);
+    if(NULL != calc->program)
+    {
+        return ProgramEmitOperator(calc->program,
+                                            (opcode_t)(OP_SQRT + function));
+    }
+
+    if(NULL != calc->integers)
+    {
+        if(FUNC_MIN == function || FUNC_MAX == function)
+        {
+            right = IntegerStackPop(calc->integers);
+            left = IntegerStackTop(calc->integers);
+            *left = (FUNC_MIN == function) == (right < *left) ? right : *left;
+
+            return SUCCESS;
+        }
 
-    return relations_LUT[stack_top][curr_input](curr_input, numbers, operators);
+        status = LeaveIntegers(calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+    }
+
+    if(2 == FunctionArity(function))
+    {
+        b = DoubleStackPop(calc->numbers);
+    }
+    a = DoubleStackTop(calc->numbers);
+
+    return FunctionImpl(function)(*a, b, a);
 }
 
-static status_t HandleRepeatOperator(const char** str, stack_t* numbers,
-                                                            stack_t* operators)
+/* min(a, b, c) is min(min(a, b), c): from the second comma on, the two
+   arguments before it are applied, so at most two are ever pending */
+static status_t HandleReadingComma(calc_t* calc)
 {
-    Input stack_top;
-    Input curr_input = repeat_input_LUT[input_LUT[(unsigned char)**str]];
+    call_t* call = CallStackTop(calc->calls);
+
+    if(1 == FunctionArity(call->function))
+    {
+        return INVALID_SYNTAX;
+    }
+
+    if(!call->has_args)
+    {
+        call->has_args = 1;
 
-    StackPeek(operators, &stack_top);
-    ++(*str);
+        return SUCCESS;
+    }
 
-    return relations_LUT[stack_top][curr_input](curr_input, numbers, operators);
+    return ApplyCall(call->function, calc);
 }
 
-static status_t HandleSyntaxError(const char** str, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandleClosingCall(calc_t* calc)
 {
-    (void)str;
-    (void)numbers;
-    (void)operators;
+    call_t call = CallStackPop(calc->calls);
 
-    return INVALID_SYNTAX;
+    OperatorStackPop(calc->operators);
+    if(2 == FunctionArity(call.function) && !call.has_args)
+    {
+        return INVALID_SYNTAX;
+    }
+
+    return ApplyCall(call.function, calc);
 }
 
-static void InitActionFuncs()
+#ifdef CALC_FSM_TABLES
+
+static status_t HandleReadingOperand(const token_t* token, calc_t* calc)
 {
-    action_funcs[START][START] = HandleReadingOperator;
-    action_funcs[START][WAIT_FOR_OPERATOR] = HandleReadingNumber;
-    action_funcs[START][WAIT_FOR_NUMBER] = HandleRepeatOperator;
-    action_funcs[START][ERROR] = HandleSyntaxError;
-    
-    action_funcs[WAIT_FOR_OPERATOR][START] = HandleSyntaxError;
-    action_funcs[WAIT_FOR_OPERATOR][WAIT_FOR_OPERATOR] = HandleRepeatNumber;
-    action_funcs[WAIT_FOR_OPERATOR][WAIT_FOR_NUMBER] = HandleReadingOperator;
-    action_funcs[WAIT_FOR_OPERATOR][ERROR] = HandleSyntaxError;
+    return TOKEN_NAME == token->kind ? HandleReadingVariable(token, calc) :
+                                            HandleReadingNumber(token, calc);
+}
 
-    action_funcs[WAIT_FOR_NUMBER][START] = HandleSyntaxError;
-    action_funcs[WAIT_FOR_NUMBER][WAIT_FOR_OPERATOR] = HandleReadingNumber;
-    action_funcs[WAIT_FOR_NUMBER][WAIT_FOR_NUMBER] = HandleRepeatOperator;
-    action_funcs[WAIT_FOR_NUMBER][ERROR] = HandleSyntaxError;
+static status_t HandleReadingOperator(const token_t* token, calc_t* calc)
+{
+    Input stack_top = OperatorStackPeek(calc->operators);
+    Input curr_input = TokenInput(token);
 
-    action_funcs[ERROR][START] = HandleSyntaxError;
-    action_funcs[ERROR][WAIT_FOR_OPERATOR] = HandleSyntaxError;
-    action_funcs[ERROR][WAIT_FOR_NUMBER] = HandleSyntaxError;
-    action_funcs[ERROR][ERROR] = HandleSyntaxError;
+    return relations_funcs[relations_LUT[stack_top][curr_input]](curr_input,
+                                                                        calc);
 }
 
-static status_t HandleInvalidSyntax(Input input, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandleRepeatNumber(const token_t* token, calc_t* calc)
+{
+    Input stack_top = OperatorStackPeek(calc->operators);
+    Input curr_input = TokenInput(token);
+
+    return relations_funcs[relations_LUT[stack_top][curr_input]](curr_input,
+                                                                        calc);
+}
+
+static status_t HandleRepeatOperator(const token_t* token, calc_t* calc)
+{
+    Input stack_top = OperatorStackPeek(calc->operators);
+    Input curr_input = (Input)repeat_input_LUT[TokenInput(token)];
+
+    return relations_funcs[relations_LUT[stack_top][curr_input]](curr_input,
+                                                                        calc);
+}
+
+static status_t HandleSyntaxError(const token_t* token, calc_t* calc)
+{
+    (void)token;
+    (void)calc;
+
+    return INVALID_SYNTAX;
+}
+
+static status_t HandleOpenCall(const token_t* token, calc_t* calc)
+{
+    (void)token;
+    (void)calc;
+
+    return SUCCESS;
+}
+
+static status_t HandleInvalidSyntax(Input input, calc_t* calc)
 {
     (void)input;
-    (void)numbers;
-    (void)operators;
+    (void)calc;
 
     return INVALID_SYNTAX;
 }
 
-static status_t HandlePushOperator(Input input, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandlePushOperator(Input input, calc_t* calc)
 {
-    (void)numbers;
-    StackPush(operators, &input);
+    if(!OperatorStackPush(calc->operators, input))
+    {
+        return FAILED_ALLOCATION;
+    }
+    STATS(CountDepth(&calc->run.max_operators_depth,
+                                    OperatorStackSize(calc->operators) - 1));
 
     return SUCCESS;
 }
 
-static status_t HandlePopOperator(Input input, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandlePopOperator(Input input, calc_t* calc)
 {
     (void)input;
-    (void)numbers;
-    StackPop(operators);
+    OperatorStackPop(calc->operators);
 
     return SUCCESS;
 }
 
-static status_t HandleExecuteOldOperator(Input input, stack_t* numbers,
-                                                            stack_t* operators)
+static status_t HandleArgument(Input input, calc_t* calc)
 {
-    Input curr_input;
-    status_t status;
-    StackPeekPop(operators, &curr_input);
-    status = operation_funcs_LUT[curr_input](numbers);
-    StackPeek(operators, &curr_input);
-    return status == SUCCESS ? relations_LUT[curr_input][input](input, numbers,
-                                                            operators) : status;
+    (void)input;
+
+    return HandleReadingComma(calc);
 }
 
-static void InitRelationshipLUT(void)
+static status_t HandleCallEnd(Input input, calc_t* calc)
 {
-    size_t i = 0;
-    size_t j = 0;
+    (void)input;
+
+    return HandleClosingCall(calc);
+}
+
+#endif      /* CALC_FSM_TABLES */
+
+static status_t EmitOperator(Input op, calc_t* calc)
+{
+    if(OPEN_BRACKETS == op || FUNCTION == op)
+    {
+        return INVALID_SYNTAX;
+    }
+
+    return UNARY_PLUS == op ? SUCCESS :
+                ProgramEmitOperator(calc->program, (opcode_t)opcode_LUT[op]);
+}
+
+#ifdef CALC_FSM_TABLES
+
+static status_t ExecuteOperator(Input op, calc_t* calc)
+{
+    status_t status = SUCCESS;
+
+    if(NULL != calc->program)
+    {
+        return EmitOperator(op, calc);
+    }
+    STATS(CountOperator(&calc->run, op));
 
-    for( ; i < NUM_OF_INPUTS; ++i)
+    if(NULL != calc->integers)
     {
-        for(j = 0; j < NUM_OF_INPUTS; ++j)
+        if(ApplyInteger(op, calc->integers))
         {
-            relations_LUT[i][j] = HandleInvalidSyntax;
+            return SUCCESS;
+        }
+
+        status = LeaveIntegers(calc);
+        if(SUCCESS != status)
+        {
+            return status;
         }
     }
 
-    relations_LUT[OTHER][PLUS] = HandlePushOperator;
-    relations_LUT[OTHER][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[OTHER][MINUS] = HandlePushOperator;
-    relations_LUT[OTHER][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[OTHER][MULT] = HandlePushOperator;
-    relations_LUT[OTHER][DIV] = HandlePushOperator;
-    relations_LUT[OTHER][POWER] = HandlePushOperator;
-    relations_LUT[OTHER][OPEN_BRACKETS] = HandlePushOperator;
-
-    relations_LUT[PLUS][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[PLUS][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[PLUS][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[PLUS][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[PLUS][MULT] = HandlePushOperator;
-    relations_LUT[PLUS][DIV] = HandlePushOperator;
-    relations_LUT[PLUS][POWER] = HandlePushOperator;
-    relations_LUT[PLUS][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[PLUS][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[UNARY_PLUS][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_PLUS][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[UNARY_PLUS][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_PLUS][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[UNARY_PLUS][MULT] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_PLUS][DIV] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_PLUS][POWER] = HandlePushOperator;
-    relations_LUT[UNARY_PLUS][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[UNARY_PLUS][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[MINUS][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[MINUS][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[MINUS][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[MINUS][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[MINUS][MULT] = HandlePushOperator;
-    relations_LUT[MINUS][DIV] = HandlePushOperator;
-    relations_LUT[MINUS][POWER] = HandlePushOperator;
-    relations_LUT[MINUS][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[MINUS][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[UNARY_MINUS][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_MINUS][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[UNARY_MINUS][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_MINUS][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[UNARY_MINUS][MULT] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_MINUS][DIV] = HandleExecuteOldOperator;
-    relations_LUT[UNARY_MINUS][POWER] = HandlePushOperator;
-    relations_LUT[UNARY_MINUS][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[UNARY_MINUS][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[MULT][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[MULT][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[MULT][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[MULT][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[MULT][MULT] = HandleExecuteOldOperator;
-    relations_LUT[MULT][DIV] = HandleExecuteOldOperator;
-    relations_LUT[MULT][POWER] = HandlePushOperator;
-    relations_LUT[MULT][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[MULT][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[DIV][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[DIV][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[DIV][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[DIV][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[DIV][MULT] = HandleExecuteOldOperator;
-    relations_LUT[DIV][DIV] = HandleExecuteOldOperator;
-    relations_LUT[DIV][POWER] = HandlePushOperator;
-    relations_LUT[DIV][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[DIV][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[POWER][PLUS] = HandleExecuteOldOperator;
-    relations_LUT[POWER][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[POWER][MINUS] = HandleExecuteOldOperator;
-    relations_LUT[POWER][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[POWER][MULT] = HandleExecuteOldOperator;
-    relations_LUT[POWER][DIV] = HandleExecuteOldOperator;
-    relations_LUT[POWER][POWER] = HandleExecuteOldOperator;
-    relations_LUT[POWER][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[POWER][CLOSE_BRACKETS] = HandleExecuteOldOperator;
-
-    relations_LUT[OPEN_BRACKETS][PLUS] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][UNARY_PLUS] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][MINUS] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][UNARY_MINUS] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][MULT] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][DIV] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][POWER] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][OPEN_BRACKETS] = HandlePushOperator;
-    relations_LUT[OPEN_BRACKETS][CLOSE_BRACKETS] = HandlePopOperator;
-}
-
-static status_t AddHandler(stack_t* numbers)
-{
-    double num1 = 0;
-    double num2 = 0;
-
-    StackPeekPop(numbers, &num1);
-    StackPeekPop(numbers, &num2);
-    num2 += num1;
-    StackPush(numbers, &num2);
+    return operation_funcs_LUT[op](calc->numbers);
+}
+
+static status_t HandleExecuteOldOperator(Input input, calc_t* calc)
+{
+    Input curr_input = OperatorStackPop(calc->operators);
+    status_t status;
+    status = ExecuteOperator(curr_input, calc);
+    curr_input = OperatorStackPeek(calc->operators);
+    return status == SUCCESS ?
+        relations_funcs[relations_LUT[curr_input][input]](input, calc) : status;
+}
+
+static status_t AddHandler(double_stack_t* numbers)
+{
+    double num = DoubleStackPop(numbers);
+
+    *DoubleStackTop(numbers) += num;
 
     return SUCCESS;
 }
 
-static status_t UnaryPlusHandler(stack_t* numbers)
+static status_t UnaryPlusHandler(double_stack_t* numbers)
 {
     (void)numbers;
     return SUCCESS;
 }
 
-static status_t SubHandler(stack_t* numbers)
+static status_t SubHandler(double_stack_t* numbers)
 {
-    double num1 = 0;
-    double num2 = 0;
+    double num = DoubleStackPop(numbers);
 
-    StackPeekPop(numbers, &num1);
-    StackPeekPop(numbers, &num2);
-    num2 -= num1;
-    StackPush(numbers, &num2);
+    *DoubleStackTop(numbers) -= num;
 
     return SUCCESS;
 }
 
-static status_t UnaryMinusHandler(stack_t* numbers)
+static status_t UnaryMinusHandler(double_stack_t* numbers)
 {
-    double num = 0;
+    *DoubleStackTop(numbers) *= -1;
 
-	StackPeekPop(numbers, &num);
-	num *= -1;
-	StackPush(numbers, &num);
-
-	return SUCCESS;
+    return SUCCESS;
 }
 
-static status_t MultiplyHandler(stack_t* numbers)
+static status_t MultiplyHandler(double_stack_t* numbers)
 {
-    double num1 = 0;
-    double num2 = 0;
+    double num = DoubleStackPop(numbers);
 
-    StackPeekPop(numbers, &num1);
-    StackPeekPop(numbers, &num2);
-    num2 *= num1;
-    StackPush(numbers, &num2);
+    *DoubleStackTop(numbers) *= num;
 
     return SUCCESS;
 }
 
-static status_t DivideHandler(stack_t* numbers)
+static status_t DivideHandler(double_stack_t* numbers)
 {
-    double num1 = 0;
-    double num2 = 0;
-
-    StackPeekPop(numbers, &num1);
-    StackPeekPop(numbers, &num2);
+    double num = DoubleStackPop(numbers);
 
-    if(num1 == 0)
+    if(num == 0)
     {
         return MATH_ERROR;
     }
 
-    num2 /= num1;
-    StackPush(numbers, &num2);
+    *DoubleStackTop(numbers) /= num;
 
     return SUCCESS;
 }
 
-static status_t PowerHandler(stack_t* numbers)
+static status_t PowerHandler(double_stack_t* numbers)
 {
-    double num1 = 0;
-    double num2 = 0;
-    double result = 1;
-    size_t i = 0;
+    double num = DoubleStackPop(numbers);
+    double* top = DoubleStackTop(numbers);
+
+    return Power(*top, num, top);
+}
+
+static status_t OpenBracketErrorHandler(double_stack_t* numbers)
+{
+    (void)numbers;
 
-    StackPeekPop(numbers, &num1);
-    StackPeekPop(numbers, &num2);
+    return INVALID_SYNTAX;
+}
 
-    if(num1 < 0 && num2 == 0)
+static status_t FsmReject(double* ans, calc_t* calc)
+{
+    (void)ans;
+    (void)calc;
+    return INVALID_SYNTAX;
+}
+
+static status_t CalculateAll(double* ans, calc_t* calc)
+{
+    status_t status = SUCCESS;
+    Input curr_input = OperatorStackPeek(calc->operators);
+
+    while(status == SUCCESS && curr_input != OTHER)
     {
-        return MATH_ERROR;
+        status = ExecuteOperator(curr_input, calc);
+        if(status != SUCCESS)
+        {
+            return status;
+        }
+
+        OperatorStackPop(calc->operators);
+        curr_input = OperatorStackPeek(calc->operators);
     }
 
-    num2 = num1 < 0 ? 1 / num2 : num2;
-	num1 = num1 < 0 ? -num1 : num1;
+    if(NULL == calc->program)
+    {
+        *ans = Answer(calc);
+    }
+    
+    return status;
+}
 
-    for( ; i < num1; ++i)
+/* The lexer hands the FSM a block of tokens at a time, so whitespace and
+   digits are never visited one character at a time here */
+static status_t RunFsm(const char* str, size_t len, double* ans,
+                                                                calc_t* calc)
+{
+    token_t tokens[TOKEN_BLOCK];
+    lexer_t lexer;
+    size_t num_tokens = 0;
+    size_t next = 0;
+    State state = START;
+    State prev_state;
+    status_t status = SUCCESS;
+    Input input = OTHER;
+
+    if(!OperatorStackPush(calc->operators, input))
     {
-        result *= num2;
+        return FAILED_ALLOCATION;
     }
 
-    StackPush(numbers, &result);
+    LexerInit(&lexer, str, len);
+    num_tokens = LexTokens(&lexer, tokens, calc);
 
-    return SUCCESS;
-}
+    while(next < num_tokens && state != ERROR && status == SUCCESS)
+    {
+        prev_state = state;
+        input = TokenInput(&tokens[next]);
+        state = (State)transition_LUT[state][input];
+        status = action_funcs[action_LUT[prev_state][state]](&tokens[next],
+                                                                        calc);
 
-static status_t OpenBracketErrorHandler(stack_t* numbers)
-{
-    (void)numbers;
+        if(++next == num_tokens)
+        {
+            num_tokens = LexTokens(&lexer, tokens, calc);
+            next = 0;
+        }
+    }
 
-    return INVALID_SYNTAX;
+    return status == SUCCESS ? finalize_state_LUT[state](ans, calc) : status;
 }
 
-static void InitOperationFuncs()
+#else
+
+/* The threaded core runs the same FSM inside one function: every state,
+   relation and operator is a jump target, the reduction recursion of the
+   table-driven core is a loop between ON_RELATION and the operators, and
+   nothing is called per token but the number and name readers */
+
+#ifndef CALC_FSM_SWITCH
+#define FSM_COMPUTED_GOTO
+#endif
+
+typedef enum
 {
-    operation_funcs_LUT[PLUS] = AddHandler;
-    operation_funcs_LUT[UNARY_PLUS] = UnaryPlusHandler;
-    operation_funcs_LUT[MINUS] = SubHandler;
-    operation_funcs_LUT[UNARY_MINUS] = UnaryMinusHandler;
-    operation_funcs_LUT[MULT] = MultiplyHandler;
-    operation_funcs_LUT[DIV] = DivideHandler;
-    operation_funcs_LUT[POWER] = PowerHandler;
-    operation_funcs_LUT[OPEN_BRACKETS] = OpenBracketErrorHandler;
-}
+    AWAIT_OPERAND,
+    AWAIT_OPERATOR,
+    AWAIT_CALL,
+    ON_NUMBER,
+    ON_NAME,
+    ON_FUNCTION,
+    ON_PREFIX,
+    ON_RELATION,
+    ON_PUSH,
+    ON_POP,
+    ON_EXECUTE,
+    ON_ARGUMENT,
+    ON_CALL_END,
+    ON_APPLY,
+    ON_FINISH,
+    ON_ADD,
+    ON_SUB,
+    ON_NEG,
+    ON_MUL,
+    ON_DIV,
+    ON_POW,
+    ON_NOTHING,
+    ON_SYNTAX_ERROR,
+    NUM_OF_TARGETS
+} Target;
+
+#define ERR ON_SYNTAX_ERROR
+
+/* START and WAIT_FOR_NUMBER: unary signs, '(', operands and calls */
+static const unsigned char operand_target_LUT[NUM_OF_INPUTS] =
+{
+    ON_PREFIX, ERR, ON_PREFIX, ERR, ERR, ERR, ERR, ON_PREFIX, ERR, ERR,
+    ON_NUMBER, ON_NAME, ERR, ON_FUNCTION
+};
 
-static status_t FsmReject(double* ans, stack_t* numbers, stack_t* operators)
+/* WAIT_FOR_OPERATOR: binary operators, ')' and ',' */
+static const unsigned char operator_target_LUT[NUM_OF_INPUTS] =
 {
-    (void)ans;
-    (void)numbers;
-    (void)operators;
-    return INVALID_SYNTAX;
-}
+    ON_RELATION, ERR, ON_RELATION, ERR, ON_RELATION, ON_RELATION,
+    ON_RELATION, ERR, ON_RELATION, ERR, ERR, ERR, ON_RELATION, ERR
+};
+
+static const unsigned char relation_target_LUT[NUM_OF_RELATIONS] =
+{
+    ERR, ON_PUSH, ON_POP, ON_EXECUTE, ON_ARGUMENT, ON_CALL_END
+};
 
-static status_t CalculateAll(double* ans, stack_t* numbers, stack_t* operators)
+static const unsigned char operation_target_LUT[NUM_OF_INPUTS] =
+{
+    ON_ADD, ON_NOTHING, ON_SUB, ON_NEG, ON_MUL, ON_DIV, ON_POW, ERR, ERR,
+    ERR, ERR, ERR, ERR, ERR
+};
+
+#undef ERR
+
+#ifdef FSM_COMPUTED_GOTO
+#define TARGET(target) target##_LABEL:
+#define JUMP(target) goto target##_LABEL
+#define DISPATCH(index) __extension__ ({ goto *labels[index]; })
+#else
+#define TARGET(target) case target:
+#define JUMP(target) { next_target = target; continue; }
+#define DISPATCH(index) { next_target = (Target)(index); continue; }
+#endif
+
+static status_t RunFsm(const char* str, size_t len, double* ans,
+                                                                calc_t* calc)
 {
+#ifdef FSM_COMPUTED_GOTO
+    static const void* const labels[NUM_OF_TARGETS] =
+    {
+        __extension__ &&AWAIT_OPERAND_LABEL,
+        __extension__ &&AWAIT_OPERATOR_LABEL,
+        __extension__ &&AWAIT_CALL_LABEL,
+        __extension__ &&ON_NUMBER_LABEL,
+        __extension__ &&ON_NAME_LABEL,
+        __extension__ &&ON_FUNCTION_LABEL,
+        __extension__ &&ON_PREFIX_LABEL,
+        __extension__ &&ON_RELATION_LABEL,
+        __extension__ &&ON_PUSH_LABEL,
+        __extension__ &&ON_POP_LABEL,
+        __extension__ &&ON_EXECUTE_LABEL,
+        __extension__ &&ON_ARGUMENT_LABEL,
+        __extension__ &&ON_CALL_END_LABEL,
+        __extension__ &&ON_APPLY_LABEL,
+        __extension__ &&ON_FINISH_LABEL,
+        __extension__ &&ON_ADD_LABEL,
+        __extension__ &&ON_SUB_LABEL,
+        __extension__ &&ON_NEG_LABEL,
+        __extension__ &&ON_MUL_LABEL,
+        __extension__ &&ON_DIV_LABEL,
+        __extension__ &&ON_POW_LABEL,
+        __extension__ &&ON_NOTHING_LABEL,
+        __extension__ &&ON_SYNTAX_ERROR_LABEL
+    };
+#else
+    Target next_target = AWAIT_OPERAND;
+#endif
+    token_t tokens[TOKEN_BLOCK];
+    lexer_t lexer;
+    const token_t* token = NULL;
+    size_t num_tokens = 0;
+    size_t next = 0;
+    Input input = OTHER;
+    Input op = OTHER;
+    Target resume = ON_RELATION;    /* where ON_APPLY continues */
+    double num = 0;
+    double* top = NULL;
     status_t status = SUCCESS;
-    Input curr_input;
 
-    StackPeek(operators, &curr_input);
+    if(!OperatorStackPush(calc->operators, OTHER))
+    {
+        return FAILED_ALLOCATION;
+    }
 
-    while(status == SUCCESS && curr_input != OTHER)
+    LexerInit(&lexer, str, len);
+    num_tokens = LexTokens(&lexer, tokens, calc);
+
+#ifndef FSM_COMPUTED_GOTO
+    for(;;)
+    {
+    switch(next_target)
     {
-        status = operation_funcs_LUT[curr_input](numbers);
-        if(status == MATH_ERROR)
+#endif
+
+    TARGET(AWAIT_OPERAND)
+        if(next == num_tokens)
+        {
+            num_tokens = LexTokens(&lexer, tokens, calc);
+            next = 0;
+            if(0 == num_tokens)
+            {
+                return INVALID_SYNTAX;
+            }
+        }
+
+        token = &tokens[next++];
+        input = TokenInput(token);
+        DISPATCH(operand_target_LUT[input]);
+
+    TARGET(AWAIT_OPERATOR)
+        if(next == num_tokens)
+        {
+            num_tokens = LexTokens(&lexer, tokens, calc);
+            next = 0;
+            if(0 == num_tokens)
+            {
+                JUMP(ON_FINISH);
+            }
+        }
+
+        token = &tokens[next++];
+        input = TokenInput(token);
+        DISPATCH(operator_target_LUT[input]);
+
+    /* after a function name, only its '(' */
+    TARGET(AWAIT_CALL)
+        if(next == num_tokens)
+        {
+            num_tokens = LexTokens(&lexer, tokens, calc);
+            next = 0;
+            if(0 == num_tokens)
+            {
+                return INVALID_SYNTAX;
+            }
+        }
+
+        token = &tokens[next++];
+        if(OPEN_BRACKETS != TokenInput(token))
+        {
+            return INVALID_SYNTAX;
+        }
+        JUMP(AWAIT_OPERAND);
+
+    TARGET(ON_NUMBER)
+        status = HandleReadingNumber(token, calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+        JUMP(AWAIT_OPERATOR);
+
+    TARGET(ON_NAME)
+        status = HandleReadingVariable(token, calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+        JUMP(AWAIT_OPERATOR);
+
+    TARGET(ON_FUNCTION)
+        status = HandleReadingCall(token, calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+        JUMP(AWAIT_CALL);
+
+    TARGET(ON_PREFIX)
+        input = (Input)repeat_input_LUT[input];
+        JUMP(ON_RELATION);
+
+    /* the operator on top of the stack against the incoming one */
+    TARGET(ON_RELATION)
+        op = OperatorStackPeek(calc->operators);
+        DISPATCH(relation_target_LUT[relations_LUT[op][input]]);
+
+    TARGET(ON_PUSH)
+        if(!OperatorStackPush(calc->operators, input))
+        {
+            return FAILED_ALLOCATION;
+        }
+        STATS(CountDepth(&calc->run.max_operators_depth,
+                                    OperatorStackSize(calc->operators) - 1));
+        JUMP(AWAIT_OPERAND);
+
+    TARGET(ON_POP)
+        OperatorStackPop(calc->operators);
+        JUMP(AWAIT_OPERATOR);
+
+    TARGET(ON_EXECUTE)
+        op = OperatorStackPop(calc->operators);
+        resume = ON_RELATION;
+        JUMP(ON_APPLY);
+
+    TARGET(ON_ARGUMENT)
+        status = HandleReadingComma(calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+        JUMP(AWAIT_OPERAND);
+
+    TARGET(ON_CALL_END)
+        status = HandleClosingCall(calc);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+        JUMP(AWAIT_OPERATOR);
+
+    TARGET(ON_APPLY)
+        if(NULL != calc->program)
+        {
+            status = EmitOperator(op, calc);
+            if(SUCCESS != status)
+            {
+                return status;
+            }
+            DISPATCH(resume);
+        }
+        STATS(CountOperator(&calc->run, op));
+        if(NULL != calc->integers)
+        {
+            if(ApplyInteger(op, calc->integers))
+            {
+                DISPATCH(resume);
+            }
+
+            status = LeaveIntegers(calc);
+            if(SUCCESS != status)
+            {
+                return status;
+            }
+        }
+        DISPATCH(operation_target_LUT[op]);
+
+    /* end of input: apply what is left down to the bottom marker */
+    TARGET(ON_FINISH)
+        op = OperatorStackPop(calc->operators);
+        if(OTHER == op)
+        {
+            if(NULL == calc->program)
+            {
+                *ans = Answer(calc);
+            }
+            return SUCCESS;
+        }
+        resume = ON_FINISH;
+        JUMP(ON_APPLY);
+
+    TARGET(ON_ADD)
+        num = DoubleStackPop(calc->numbers);
+        *DoubleStackTop(calc->numbers) += num;
+        DISPATCH(resume);
+
+    TARGET(ON_SUB)
+        num = DoubleStackPop(calc->numbers);
+        *DoubleStackTop(calc->numbers) -= num;
+        DISPATCH(resume);
+
+    TARGET(ON_NEG)
+        *DoubleStackTop(calc->numbers) *= -1;
+        DISPATCH(resume);
+
+    TARGET(ON_MUL)
+        num = DoubleStackPop(calc->numbers);
+        *DoubleStackTop(calc->numbers) *= num;
+        DISPATCH(resume);
+
+    TARGET(ON_DIV)
+        num = DoubleStackPop(calc->numbers);
+        if(num == 0)
         {
             return MATH_ERROR;
         }
+        *DoubleStackTop(calc->numbers) /= num;
+        DISPATCH(resume);
+
+    TARGET(ON_POW)
+        num = DoubleStackPop(calc->numbers);
+        top = DoubleStackTop(calc->numbers);
+        status = Power(*top, num, top);
+        if(SUCCESS != status)
+        {
+            return status;
+        }
+        DISPATCH(resume);
+
+    TARGET(ON_NOTHING)
+        DISPATCH(resume);
 
-        StackPop(operators);
-        StackPeek(operators, &curr_input);
+    TARGET(ON_SYNTAX_ERROR)
+        return INVALID_SYNTAX;
+
+#ifndef FSM_COMPUTED_GOTO
+    default:
+        return INVALID_SYNTAX;
+    }
+    }
+#endif
+}
+
+#undef TARGET
+#undef JUMP
+#undef DISPATCH
+
+#endif      /* CALC_FSM_TABLES */
+
+#ifdef CALC_STATS
+
+static status_t RunMeasured(const char* str, size_t len, double* ans,
+                            calc_t* calc, calc_stats_t* stats, int shared)
+{
+    unsigned long start = StatsNow();
+    status_t status = SUCCESS;
+
+    StatsRunInit(&calc->run);
+    status = RunFsm(str, len, ans, calc);
+    if(NULL != stats)
+    {
+        StatsRecord(stats, &calc->run, StatsNow() - start, shared);
     }
 
-    StackPeek(numbers, ans);
-    
     return status;
 }
 
-static void InitFinalizeLUT()
+#define RUN_FSM(str, len, ans, calc, stats, shared)                           \
+                                RunMeasured(str, len, ans, calc, stats, shared)
+#else
+#define RUN_FSM(str, len, ans, calc, stats, shared) RunFsm(str, len, ans, calc)
+#endif
+
+static void* DefaultAlloc(size_t size, void* param)
 {
-    finalize_state_LUT[START] = FsmReject;
-    finalize_state_LUT[WAIT_FOR_OPERATOR] = CalculateAll;
-    finalize_state_LUT[WAIT_FOR_NUMBER] = FsmReject;
-    finalize_state_LUT[ERROR] = FsmReject;
+    (void)param;
+
+    return malloc(size);
 }
 
-static void InitLUTs(void)
+static void DefaultFree(void* ptr, void* param)
 {
-    InitTransitionLUT();
-    InitInputLUT();
-    InitActionFuncs();
-    InitRelationshipLUT();
-    InitOperationFuncs();
-    InitFinalizeLUT();
-    InitRepeatInputLUT();
+    (void)param;
+
+    free(ptr);
 }
 
-status_t Calculate(const char* str, double* ans)
+static void CtxInit(calc_ctx_t* ctx, const calc_allocator_t* allocator)
 {
-    stack_t* numbers_stack = NULL;
-    stack_t* operators_stack = NULL;
-    State state = START;
-    State prev_state;
-    status_t status = SUCCESS;
-    Input input = OTHER;
+    ctx->allocator.alloc = DefaultAlloc;
+    ctx->allocator.free = DefaultFree;
+    ctx->allocator.param = NULL;
+
+    if(NULL != allocator)
+    {
+        ctx->allocator = *allocator;
+    }
+
+    ctx->counters.allocations = 0;
+    ctx->counters.frees = 0;
+    ctx->counters.bytes_allocated = 0;
+    ctx->buffer = NULL;
+    ctx->capacity = 0;
+    STATS(memset(&ctx->stats, 0, sizeof(calc_stats_t)));
+}
+
+static void CtxRelease(calc_ctx_t* ctx)
+{
+    if(NULL != ctx->buffer)
+    {
+        ctx->allocator.free(ctx->buffer, ctx->allocator.param);
+        ++ctx->counters.frees;
+        ctx->buffer = NULL;
+        ctx->capacity = 0;
+    }
+}
+
+calc_ctx_t* CalcCtxCreate(const calc_allocator_t* allocator)
+{
+    calc_ctx_t* ctx = NULL;
+
+    if(NULL == allocator)
+    {
+        ctx = (calc_ctx_t*)malloc(sizeof(calc_ctx_t));
+    }
+    else
+    {
+        ctx = (calc_ctx_t*)allocator->alloc(sizeof(calc_ctx_t),
+                                                            allocator->param);
+    }
 
+    if(NULL == ctx)
+    {
+        return NULL;
+    }
+
+    CtxInit(ctx, allocator);
+    ++ctx->counters.allocations;
+    ctx->counters.bytes_allocated += sizeof(calc_ctx_t);
+
+    return ctx;
+}
+
+void CalcCtxDestroy(calc_ctx_t* ctx)
+{
+    assert(ctx);
+
+    CtxRelease(ctx);
+    ctx->allocator.free(ctx, ctx->allocator.param);
+}
+
+status_t CalcCtxReserve(calc_ctx_t* ctx, size_t len)
+{
+    size_t capacity = ctx->capacity;
+    size_t size = 0;
+    void* buffer = NULL;
+
+    assert(ctx);
+
+    /* one extra operator slot for the bottom-of-stack marker */
+    if(len < capacity)
+    {
+        return SUCCESS;
+    }
+
+    while(capacity <= len)
+    {
+        capacity = 0 == capacity ? MIN_CTX_CAPACITY : capacity * 2;
+    }
+
+    size = capacity * (sizeof(double) + sizeof(call_t) + sizeof(Input));
+    buffer = ctx->allocator.alloc(size, ctx->allocator.param);
+    if(NULL == buffer)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    CtxRelease(ctx);
+    ctx->buffer = buffer;
+    ctx->capacity = capacity;
+    ++ctx->counters.allocations;
+    ctx->counters.bytes_allocated += size;
+
+    return SUCCESS;
+}
+
+void CalcCtxGetAllocCounters(const calc_ctx_t* ctx,
+                                            calc_alloc_counters_t* counters)
+{
+    assert(ctx);
+    assert(counters);
+
+    *counters = ctx->counters;
+}
+
+int CalcGetStats(const calc_ctx_t* ctx, calc_stats_t* stats)
+{
+    assert(stats);
+
+#ifdef CALC_STATS
+    StatsRead(NULL == ctx ? &global_stats : &ctx->stats, stats);
+
+    return 1;
+#else
+    (void)ctx;
+    memset(stats, 0, sizeof(calc_stats_t));
+
+    return 0;
+#endif
+}
+
+status_t CalculateCtx(calc_ctx_t* ctx, const char* str, double* ans)
+{
     assert(str);
+
+    return CalculateCtxN(ctx, str, strlen(str), ans);
+}
+
+status_t CalculateCtxN(calc_ctx_t* ctx, const char* str, size_t len,
+                                                                double* ans)
+{
+    double_stack_t numbers;
+    operator_stack_t operators;
+    call_stack_t calls;
+    calc_t calc;
+    status_t status = SUCCESS;
+
+    assert(ctx);
+    assert(str || 0 == len);
     assert(ans);
 
-    numbers_stack = StackCreate(strlen(str), sizeof(double));
-    if(numbers_stack == NULL)
+    status = CalcCtxReserve(ctx, len);
+    if(status != SUCCESS)
     {
-        return FAILED_ALLOCATION;
+        return status;
     }
 
-    operators_stack = StackCreate(strlen(str), sizeof(Input));
-    if(operators_stack == NULL)
+    DoubleStackInitBuffer(&numbers, (double*)ctx->buffer, ctx->capacity);
+    CallStackInitBuffer(&calls,
+            (call_t*)((double*)ctx->buffer + ctx->capacity), ctx->capacity);
+    OperatorStackInitBuffer(&operators,
+            (Input*)(calls.data + ctx->capacity), ctx->capacity);
+    calc.numbers = &numbers;
+    calc.operators = &operators;
+    calc.calls = &calls;
+    calc.program = NULL;
+    calc.integers = NULL;
+
+    return RUN_FSM(str, len, ans, &calc, &ctx->stats, 0);
+}
+
+status_t Calculate(const char* str, double* ans)
+{
+    assert(str);
+
+    return CalculateN(str, strlen(str), ans);
+}
+
+status_t CalculateN(const char* str, size_t len, double* ans)
+{
+    double_stack_t numbers;
+    operator_stack_t operators;
+    call_stack_t calls;
+    calc_t calc;
+    status_t status = SUCCESS;
+
+    assert(str || 0 == len);
+    assert(ans);
+
+    DoubleStackInit(&numbers);
+    OperatorStackInit(&operators);
+    CallStackInit(&calls);
+    calc.numbers = &numbers;
+    calc.operators = &operators;
+    calc.calls = &calls;
+    calc.program = NULL;
+    calc.integers = NULL;
+
+    status = RUN_FSM(str, len, ans, &calc, &global_stats, 1);
+    DoubleStackDestroy(&numbers);
+    OperatorStackDestroy(&operators);
+    CallStackDestroy(&calls);
+
+    return status;
+}
+
+status_t CalculateExact(const char* str, calc_number_t* ans)
+{
+    assert(str);
+
+    return CalculateExactN(str, strlen(str), ans);
+}
+
+status_t CalculateExactN(const char* str, size_t len, calc_number_t* ans)
+{
+    double_stack_t numbers;
+    operator_stack_t operators;
+    call_stack_t calls;
+    integer_stack_t integers;
+    calc_t calc;
+    status_t status = SUCCESS;
+
+    assert(str || 0 == len);
+    assert(ans);
+
+    DoubleStackInit(&numbers);
+    OperatorStackInit(&operators);
+    CallStackInit(&calls);
+    IntegerStackInit(&integers);
+    calc.numbers = &numbers;
+    calc.operators = &operators;
+    calc.calls = &calls;
+    calc.program = NULL;
+    calc.integers = &integers;
+
+    status = RUN_FSM(str, len, &ans->real, &calc, &global_stats, 1);
+    ans->is_integer = SUCCESS == status && NULL != calc.integers;
+    ans->integer = ans->is_integer ? IntegerStackPeek(&integers) : 0;
+
+    DoubleStackDestroy(&numbers);
+    OperatorStackDestroy(&operators);
+    CallStackDestroy(&calls);
+    IntegerStackDestroy(&integers);
+
+    return status;
+}
+
+status_t CalcCompile(const char* str, calc_program_t** program)
+{
+    operator_stack_t operators;
+    call_stack_t calls;
+    calc_t calc;
+    status_t status = SUCCESS;
+
+    assert(str);
+    assert(program);
+
+    calc.numbers = NULL;
+    calc.integers = NULL;
+    calc.program = ProgramCreate();
+    if(calc.program == NULL)
     {
-        StackDestroy(numbers_stack);
         return FAILED_ALLOCATION;
     }
 
-    InitLUTs();
-    StackPush(operators_stack, &input);
+    OperatorStackInit(&operators);
+    CallStackInit(&calls);
+    calc.operators = &operators;
+    calc.calls = &calls;
 
-    while(isspace(*str))
+    status = RUN_FSM(str, strlen(str), NULL, &calc, NULL, 0);
+    OperatorStackDestroy(&operators);
+    CallStackDestroy(&calls);
+
+    if(status != SUCCESS)
     {
-        ++str;
+        CalcProgramDestroy(calc.program);
+        calc.program = NULL;
     }
 
-    while(*str != '\0' && state != ERROR && status != MATH_ERROR)
-    {
-        prev_state = state;
-        input = input_LUT[(unsigned char)*str];
-        state = transition_LUT[state][input];
-        status = action_funcs[prev_state][state](&str, numbers_stack,
-                                                            operators_stack);
+    *program = calc.program;
 
-        while(isspace(*str))
+    return status;
+}
+
+/* what an open bracket lets a comma and its ')' do */
+typedef enum
+{
+    PLAIN_BRACKET,
+    UNARY_CALL,
+    BINARY_CALL,        /* no comma yet, so it cannot be closed */
+    BINARY_CALL_ARGS,
+    NUM_OF_BRACKETS
+} Bracket;
+
+static Bracket CallBracket(const token_t* token)
+{
+    function_t function = FindFunction(token->start,
+                                                    token->end - token->start);
+
+    return 2 == FunctionArity(function) ? BINARY_CALL : UNARY_CALL;
+}
+
+/* the kinds of the enclosing brackets, BRACKET_BITS each */
+static void SetBracket(unsigned char* brackets, size_t level, Bracket bracket)
+{
+    unsigned int shift = level % (CHAR_BIT / BRACKET_BITS) * BRACKET_BITS;
+    unsigned char* byte = &brackets[level / (CHAR_BIT / BRACKET_BITS)];
+
+    *byte = (unsigned char)((*byte & ~(3U << shift)) |
+                                            ((unsigned int)bracket << shift));
+}
+
+static Bracket GetBracket(const unsigned char* brackets, size_t level)
+{
+    unsigned int shift = level % (CHAR_BIT / BRACKET_BITS) * BRACKET_BITS;
+
+    return (Bracket)(brackets[level / (CHAR_BIT / BRACKET_BITS)] >> shift & 3);
+}
+
+/* Only the transitions are run; brackets are counted, and the kind of the
+   innermost one is enough to check commas and ')' */
+size_t CalcValidate(const char* str, size_t len)
+{
+    unsigned char brackets[CALC_VALIDATE_MAX_DEPTH * BRACKET_BITS / CHAR_BIT];
+    token_t tokens[TOKEN_BLOCK];
+    lexer_t lexer;
+    const token_t* token = NULL;
+    size_t num_tokens = 0;
+    size_t depth = 0;
+    size_t next = 0;
+    State state = START;
+    State prev_state = START;
+    Input input = OTHER;
+    Bracket bracket = PLAIN_BRACKET;    /* the innermost open one */
+    Bracket call = PLAIN_BRACKET;       /* the one a function name opens */
+
+    assert(str || 0 == len);
+
+    LexerInitScan(&lexer, str, len);
+    while(0 != (num_tokens = LexerNext(&lexer, tokens, TOKEN_BLOCK)))
+    {
+        for(next = 0; next < num_tokens; ++next)
         {
-            ++str;
+            token = &tokens[next];
+            input = TokenInput(token);
+            prev_state = state;
+            state = (State)transition_LUT[state][input];
+            if(ERROR == state)
+            {
+                return token->start - str;
+            }
+
+            switch(input)
+            {
+                case FUNCTION:
+                    call = CallBracket(token);
+                    break;
+
+                case OPEN_BRACKETS:
+                    if(CALC_VALIDATE_MAX_DEPTH == depth)
+                    {
+                        return token->start - str;
+                    }
+                    if(0 < depth)
+                    {
+                        SetBracket(brackets, depth - 1, bracket);
+                    }
+                    bracket = WAIT_FOR_CALL == prev_state ? call :
+                                                                PLAIN_BRACKET;
+                    ++depth;
+                    break;
+
+                case COMMA:
+                    if(0 == depth || PLAIN_BRACKET == bracket ||
+                                                        UNARY_CALL == bracket)
+                    {
+                        return token->start - str;
+                    }
+                    bracket = BINARY_CALL_ARGS;
+                    break;
+
+                case CLOSE_BRACKETS:
+                    if(0 == depth || BINARY_CALL == bracket)
+                    {
+                        return token->start - str;
+                    }
+                    --depth;
+                    if(0 < depth)
+                    {
+                        bracket = GetBracket(brackets, depth - 1);
+                    }
+                    break;
+
+                default:
+                    break;
+            }
         }
     }
 
-    status = status == SUCCESS ? finalize_state_LUT[state](ans, numbers_stack,
-                                            operators_stack) : status;
-    StackDestroy(numbers_stack);
-    StackDestroy(operators_stack);
+    return WAIT_FOR_OPERATOR == state && 0 == depth ? CALC_VALID : len;
+}
 
-    return status;
-}
\ No newline at end of file
+size_t CalcValidateBatch(const char* const* exprs, const size_t* lens,
+                                                size_t n, size_t* offsets)
+{
+    size_t invalid = 0;
+    size_t i = 0;
+
+    assert(exprs || 0 == n);
+    assert(offsets || 0 == n);
+
+    for( ; i < n; ++i)
+    {
+        offsets[i] = CalcValidate(exprs[i], NULL != lens ? lens[i] :
+                                                            strlen(exprs[i]));
+        invalid += CALC_VALID != offsets[i];
+    }
+
+    return invalid;
+}
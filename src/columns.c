@@ -0,0 +1,201 @@
+#include <stdlib.h>  /* malloc, free */
+#include <string.h>  /* memcpy, memset */
+#include <assert.h>  /* assert */
+
+#include "program.h"
+#include "power.h"
+#include "kernels.h"
+
+#define BLOCK_ROWS 256
+
+/* Runs the program on rows [first, first + count) at once: every slot of
+   the values stack is a column of BLOCK_ROWS values. A row that fails is
+   flagged and carried along; Power skips it, as CalcEval would have
+   stopped there */
+static void ExecuteBlock(const calc_program_t* program,
+                        const double* const* columns, size_t first,
+                        size_t count, double* stack, unsigned char* failed)
+{
+    const instruction_t* ip = program->code;
+    const instruction_t* end = ip + program->code_size;
+    double* temps = stack + program->max_depth * BLOCK_ROWS;
+    double* left = NULL;
+    double* right = NULL;
+    size_t top = 0;
+    size_t i = 0;
+
+    for( ; ip < end; ++ip)
+    {
+        /* the slot pushed next, and the top one under it */
+        right = stack + top * BLOCK_ROWS;
+        left = 0 < top ? right - BLOCK_ROWS : NULL;
+
+        switch(ip->opcode)
+        {
+            case OP_CONST:
+                for(i = 0; i < count; ++i)
+                {
+                    right[i] = program->constants[ip->operand];
+                }
+                ++top;
+                break;
+
+            case OP_VAR:
+                memcpy(right, columns[ip->operand] + first,
+                                                    count * sizeof(double));
+                ++top;
+                break;
+
+            case OP_ADD:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                for(i = 0; i < count; ++i)
+                {
+                    left[i] += right[i];
+                }
+                break;
+
+            case OP_SUB:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                for(i = 0; i < count; ++i)
+                {
+                    left[i] -= right[i];
+                }
+                break;
+
+            case OP_NEG:
+                for(i = 0; i < count; ++i)
+                {
+                    left[i] *= -1;
+                }
+                break;
+
+            case OP_MUL:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                for(i = 0; i < count; ++i)
+                {
+                    left[i] *= right[i];
+                }
+                break;
+
+            case OP_DIV:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                for(i = 0; i < count; ++i)
+                {
+                    failed[i] |= right[i] == 0;
+                    left[i] /= right[i];
+                }
+                break;
+
+            case OP_POW:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                for(i = 0; i < count; ++i)
+                {
+                    if(!failed[i] && SUCCESS != Power(left[i], right[i],
+                                                                &left[i]))
+                    {
+                        failed[i] = 1;
+                    }
+                }
+                break;
+
+            case OP_POWMUL:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                for(i = 0; i < count; ++i)
+                {
+                    failed[i] |= SUCCESS != PowerMultiply(left[i], right[i],
+                                                                    &left[i]);
+                }
+                break;
+
+            case OP_SQRT:
+            case OP_EXP:
+            case OP_LOG:
+            case OP_SIN:
+            case OP_COS:
+                KernelApply((function_t)(ip->opcode - OP_SQRT), left, NULL,
+                                                        left, failed, count);
+                break;
+
+            case OP_MIN:
+            case OP_MAX:
+                --top;
+                right = left;
+                left -= BLOCK_ROWS;
+                KernelApply((function_t)(ip->opcode - OP_SQRT), left, right,
+                                                        left, failed, count);
+                break;
+
+            case OP_DUP:
+                memcpy(right, left, count * sizeof(double));
+                ++top;
+                break;
+
+            case OP_STORE:
+                memcpy(temps + ip->operand * BLOCK_ROWS, left,
+                                                    count * sizeof(double));
+                break;
+
+            case OP_LOAD:
+                memcpy(right, temps + ip->operand * BLOCK_ROWS,
+                                                    count * sizeof(double));
+                ++top;
+                break;
+        }
+    }
+}
+
+status_t CalcEvalColumns(const calc_program_t* program,
+                        const double* const* columns, size_t rows,
+                        double* results, status_t* statuses)
+{
+    unsigned char failed[BLOCK_ROWS];
+    double* stack = NULL;
+    size_t first = 0;
+    size_t count = 0;
+    size_t i = 0;
+    status_t status = SUCCESS;
+
+    assert(program);
+    assert(columns || 0 == program->num_vars);
+    assert(results || 0 == rows);
+
+    stack = (double*)malloc((program->max_depth + program->num_temps) *
+                                            BLOCK_ROWS * sizeof(double));
+    if(NULL == stack)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; first < rows; first += count)
+    {
+        count = rows - first < BLOCK_ROWS ? rows - first : BLOCK_ROWS;
+        memset(failed, 0, count);
+        ExecuteBlock(program, columns, first, count, stack, failed);
+
+        for(i = 0; i < count; ++i)
+        {
+            results[first + i] = stack[i];
+            if(NULL != statuses)
+            {
+                statuses[first + i] = failed[i] ? MATH_ERROR : SUCCESS;
+            }
+            status = failed[i] ? MATH_ERROR : status;
+        }
+    }
+
+    free(stack);
+
+    return status;
+}
@@ -0,0 +1,576 @@
+#include <stdio.h>   /* fread, fwrite, ferror, fflush */
+#include <stdlib.h>  /* malloc, realloc, free */
+#include <string.h>  /* memchr, memcmp, memcpy, memmove, memset, strlen,
+                        strcpy */
+#include <assert.h>  /* assert */
+
+#include "calc_csv.h"
+#include "number.h"
+
+#define BUFFER_SIZE (1 << 20)
+#define OUTPUT_SIZE (1 << 20)
+#define DEFAULT_CHUNK_ROWS 4096
+#define MAX_RESULT_SIZE 32
+#define NO_VARIABLE ((size_t)-1)
+
+typedef struct field
+{
+    const char* start;
+    const char* end;
+} field_t;
+
+typedef struct csv
+{
+    const calc_program_t* program;
+    FILE* output;
+    char delimiter;
+    int only_result;
+    size_t num_vars;
+    size_t* var_of_column;      /* NO_VARIABLE for the columns not read */
+    size_t num_columns;         /* read, the ones after are skipped */
+    field_t* fields;            /* of the row being split, per variable */
+    size_t chunk_rows;
+    size_t num_rows;            /* in the chunk */
+    double* values;             /* chunk_rows per variable */
+    const double** columns;
+    double* results;
+    status_t* statuses;
+    unsigned char* unparsed;    /* rows with a cell that is not a number */
+    field_t* rows;              /* text of the chunk's rows */
+    char* out;
+    size_t out_used;
+    int write_failed;
+    calc_csv_report_t report;
+} csv_t;
+
+/* the newline ending the row at str, NULL if it is not in [str, end) */
+static const char* FindRowEnd(const char* str, const char* end)
+{
+    const char* newline = (const char*)memchr(str, '\n', end - str);
+    int quoted = 0;
+
+    /* a quoted newline belongs to the row */
+    if(NULL == memchr(str, '"', (NULL == newline ? end : newline) - str))
+    {
+        return newline;
+    }
+
+    for( ; str < end; ++str)
+    {
+        if('"' == *str)
+        {
+            quoted = !quoted;
+        }
+        else if('\n' == *str && !quoted)
+        {
+            return str;
+        }
+    }
+
+    return NULL;
+}
+
+/* the delimiter ending the field at str, or the end of the row */
+static const char* FindFieldEnd(const char* str, const char* end,
+                                                            char delimiter)
+{
+    const char* found = NULL;
+    int quoted = 0;
+
+    if(str < end && '"' == *str)
+    {
+        for( ; str < end && (quoted || delimiter != *str); ++str)
+        {
+            quoted ^= '"' == *str;
+        }
+        return str;
+    }
+
+    found = (const char*)memchr(str, delimiter, end - str);
+
+    return NULL == found ? end : found;
+}
+
+/* strips blanks, then one pair of quotes and the blanks inside it */
+static void Unquote(const char** start, const char** end)
+{
+    int i = 0;
+
+    for( ; i < 2; ++i)
+    {
+        while(*start < *end && (' ' == **start || '\t' == **start))
+        {
+            ++*start;
+        }
+        while(*end > *start && (' ' == (*end)[-1] || '\t' == (*end)[-1]))
+        {
+            --*end;
+        }
+
+        if(1 == i || *end - *start < 2 || '"' != **start ||
+                                                        '"' != (*end)[-1])
+        {
+            break;
+        }
+        ++*start;
+        --*end;
+    }
+}
+
+static int ParseCell(const char* start, const char* end, double* value)
+{
+    const char* number = NULL;
+    int negative = 0;
+
+    Unquote(&start, &end);
+    if(start < end && ('-' == *start || '+' == *start))
+    {
+        negative = '-' == *start;
+        ++start;
+    }
+
+    number = ParseNumber(start, end, value);
+    if(number == start || number != end)
+    {
+        return 0;
+    }
+
+    *value = negative ? -*value : *value;
+
+    return 1;
+}
+
+static int SetColumn(csv_t* csv, size_t var, size_t column)
+{
+    size_t* var_of_column = NULL;
+    size_t i = csv->num_columns;
+
+    if(column >= csv->num_columns)
+    {
+        var_of_column = (size_t*)realloc(csv->var_of_column,
+                                            (column + 1) * sizeof(size_t));
+        if(NULL == var_of_column)
+        {
+            return 0;
+        }
+
+        csv->var_of_column = var_of_column;
+        csv->num_columns = column + 1;
+        for( ; i < csv->num_columns; ++i)
+        {
+            var_of_column[i] = NO_VARIABLE;
+        }
+    }
+
+    if(NO_VARIABLE == csv->var_of_column[column])
+    {
+        csv->var_of_column[column] = var;
+    }
+
+    return 1;
+}
+
+/* cN is column N, from 1 */
+static status_t MapByNumber(csv_t* csv)
+{
+    const char* name = NULL;
+    size_t column = 0;
+    size_t var = 0;
+
+    for( ; var < csv->num_vars; ++var)
+    {
+        name = CalcVariableName(csv->program, var);
+        column = 0;
+        if('c' != *name || '\0' == name[1])
+        {
+            return INVALID_SYNTAX;
+        }
+        for(++name; '0' <= *name && *name <= '9'; ++name)
+        {
+            column = column * 10 + (*name - '0');
+        }
+        if('\0' != *name || 0 == column)
+        {
+            return INVALID_SYNTAX;
+        }
+
+        if(!SetColumn(csv, var, column - 1))
+        {
+            return FAILED_ALLOCATION;
+        }
+    }
+
+    return SUCCESS;
+}
+
+/* each variable is the first column named after it */
+static status_t MapByHeader(csv_t* csv, const char* str, const char* end)
+{
+    const char* field_end = NULL;
+    const char* name_start = NULL;
+    const char* name_end = NULL;
+    const char* name = NULL;
+    size_t column = 0;
+    size_t var = 0;
+
+    for( ; ; ++column)
+    {
+        field_end = FindFieldEnd(str, end, csv->delimiter);
+        name_start = str;
+        name_end = field_end;
+        Unquote(&name_start, &name_end);
+
+        for(var = 0; var < csv->num_vars; ++var)
+        {
+            name = CalcVariableName(csv->program, var);
+            if(strlen(name) == (size_t)(name_end - name_start) &&
+                        0 == memcmp(name, name_start, name_end - name_start) &&
+                                            !SetColumn(csv, var, column))
+            {
+                return FAILED_ALLOCATION;
+            }
+        }
+
+        if(field_end == end)
+        {
+            break;
+        }
+        str = field_end + 1;
+    }
+
+    for(var = 0; var < csv->num_vars; ++var)
+    {
+        for(column = 0; column < csv->num_columns &&
+                                var != csv->var_of_column[column]; ++column)
+        {
+        }
+        if(column == csv->num_columns)
+        {
+            return INVALID_SYNTAX;
+        }
+    }
+
+    return SUCCESS;
+}
+
+static void FlushOutput(csv_t* csv)
+{
+    if(0 < csv->out_used &&
+            fwrite(csv->out, 1, csv->out_used, csv->output) != csv->out_used)
+    {
+        csv->write_failed = 1;
+    }
+
+    csv->out_used = 0;
+}
+
+static void Put(csv_t* csv, const char* data, size_t size)
+{
+    if(csv->out_used + size > OUTPUT_SIZE)
+    {
+        FlushOutput(csv);
+    }
+
+    if(size > OUTPUT_SIZE)
+    {
+        csv->write_failed |= fwrite(data, 1, size, csv->output) != size;
+        return;
+    }
+
+    memcpy(csv->out + csv->out_used, data, size);
+    csv->out_used += size;
+}
+
+static void PutRow(csv_t* csv, const char* start, const char* end,
+                                                        const char* result)
+{
+    if(!csv->only_result)
+    {
+        Put(csv, start, end - start);
+        Put(csv, &csv->delimiter, 1);
+    }
+
+    Put(csv, result, strlen(result));
+    Put(csv, "\n", 1);
+}
+
+/* evaluates the rows of the chunk and writes them */
+static status_t FlushChunk(csv_t* csv)
+{
+    char result[MAX_RESULT_SIZE];
+    status_t status = SUCCESS;
+    size_t i = 0;
+
+    if(0 == csv->num_rows)
+    {
+        return SUCCESS;
+    }
+
+    if(FAILED_ALLOCATION == CalcEvalColumns(csv->program, csv->columns,
+                            csv->num_rows, csv->results, csv->statuses))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; i < csv->num_rows; ++i)
+    {
+        status = csv->unparsed[i] ? INVALID_SYNTAX : csv->statuses[i];
+        if(SUCCESS == status)
+        {
+            FormatNumber(csv->results[i], result);
+        }
+        else
+        {
+            strcpy(result, "nan");
+            ++csv->report.failed_rows;
+        }
+
+        PutRow(csv, csv->rows[i].start, csv->rows[i].end, result);
+    }
+
+    csv->report.rows += csv->num_rows;
+    csv->num_rows = 0;
+
+    return SUCCESS;
+}
+
+/* parses the cells of the variables' columns into the chunk */
+static status_t AddRow(csv_t* csv, const char* str, const char* end)
+{
+    const char* field_end = NULL;
+    size_t row = csv->num_rows;
+    size_t column = 0;
+    size_t var = 0;
+    double* value = NULL;
+
+    for( ; var < csv->num_vars; ++var)
+    {
+        csv->fields[var].start = NULL;
+    }
+
+    csv->rows[row].start = str;
+    csv->rows[row].end = end;
+    for( ; column < csv->num_columns; ++column)
+    {
+        field_end = FindFieldEnd(str, end, csv->delimiter);
+        var = csv->var_of_column[column];
+        if(NO_VARIABLE != var)
+        {
+            csv->fields[var].start = str;
+            csv->fields[var].end = field_end;
+        }
+
+        if(field_end == end)
+        {
+            break;
+        }
+        str = field_end + 1;
+    }
+
+    csv->unparsed[row] = 0;
+    for(var = 0; var < csv->num_vars; ++var)
+    {
+        value = &csv->values[var * csv->chunk_rows + row];
+        if(NULL == csv->fields[var].start || !ParseCell(csv->fields[var].start,
+                                                csv->fields[var].end, value))
+        {
+            csv->unparsed[row] = 1;
+            *value = 0;
+        }
+    }
+
+    ++csv->num_rows;
+
+    return csv->num_rows == csv->chunk_rows ? FlushChunk(csv) : SUCCESS;
+}
+
+static int Allocate(csv_t* csv)
+{
+    size_t var = 0;
+
+    csv->fields = (field_t*)malloc((csv->num_vars + 1) * sizeof(field_t));
+    csv->values = (double*)malloc((csv->num_vars + 1) * csv->chunk_rows *
+                                                            sizeof(double));
+    csv->columns = (const double**)malloc((csv->num_vars + 1) *
+                                                        sizeof(double*));
+    csv->results = (double*)malloc(csv->chunk_rows * sizeof(double));
+    csv->statuses = (status_t*)malloc(csv->chunk_rows * sizeof(status_t));
+    csv->unparsed = (unsigned char*)malloc(csv->chunk_rows);
+    csv->rows = (field_t*)malloc(csv->chunk_rows * sizeof(field_t));
+    csv->out = (char*)malloc(OUTPUT_SIZE);
+    if(NULL == csv->fields || NULL == csv->values || NULL == csv->columns ||
+            NULL == csv->results || NULL == csv->statuses ||
+            NULL == csv->unparsed || NULL == csv->rows || NULL == csv->out)
+    {
+        return 0;
+    }
+
+    for( ; var < csv->num_vars; ++var)
+    {
+        csv->columns[var] = csv->values + var * csv->chunk_rows;
+    }
+
+    return 1;
+}
+
+static void Free(csv_t* csv)
+{
+    free(csv->var_of_column);
+    free(csv->fields);
+    free(csv->values);
+    free(csv->columns);
+    free(csv->results);
+    free(csv->statuses);
+    free(csv->unparsed);
+    free(csv->rows);
+    free(csv->out);
+}
+
+/* Reads the stream into a buffer that only grows to hold the longest row:
+   every complete row in it is added to the chunk, the chunk is flushed
+   while the rows it points to are still there, and the incomplete row
+   left is moved to the front before reading more */
+static status_t Stream(csv_t* csv, FILE* input, const char* result_name,
+                                                                int header)
+{
+    char* buffer = (char*)malloc(BUFFER_SIZE);
+    char* grown = NULL;
+    size_t capacity = BUFFER_SIZE;
+    size_t used = 0;
+    size_t wanted = 0;
+    size_t num_read = 0;
+    const char* str = NULL;
+    const char* end = NULL;
+    const char* newline = NULL;
+    const char* row_end = NULL;
+    int at_eof = 0;
+    status_t status = NULL == buffer ? FAILED_ALLOCATION : SUCCESS;
+
+    while(SUCCESS == status && !at_eof)
+    {
+        if(used == capacity)
+        {
+            grown = (char*)realloc(buffer, 2 * capacity);
+            if(NULL == grown)
+            {
+                status = FAILED_ALLOCATION;
+                break;
+            }
+            buffer = grown;
+            capacity *= 2;
+        }
+
+        wanted = capacity - used;
+        num_read = fread(buffer + used, 1, wanted, input);
+        csv->report.bytes += num_read;
+        used += num_read;
+        if(num_read < wanted)
+        {
+            if(ferror(input))
+            {
+                status = STREAM_ERROR;
+                break;
+            }
+            at_eof = 1;
+        }
+
+        str = buffer;
+        end = buffer + used;
+        while(SUCCESS == status && str < end &&
+                    (NULL != (newline = FindRowEnd(str, end)) || at_eof))
+        {
+            row_end = NULL == newline ? end : newline;
+            if(row_end > str && '\r' == row_end[-1])
+            {
+                --row_end;
+            }
+
+            if(header)
+            {
+                status = MapByHeader(csv, str, row_end);
+                if(SUCCESS == status)
+                {
+                    PutRow(csv, str, row_end, result_name);
+                }
+                header = 0;
+            }
+            else if(row_end > str)
+            {
+                status = AddRow(csv, str, row_end);
+            }
+
+            str = NULL == newline ? end : newline + 1;
+        }
+
+        if(SUCCESS == status)
+        {
+            status = FlushChunk(csv);
+        }
+
+        used = end - str;
+        memmove(buffer, str, used);
+    }
+
+    /* a stream without a header row has no column for any variable */
+    if(SUCCESS == status && header && 0 < csv->num_vars)
+    {
+        status = INVALID_SYNTAX;
+    }
+
+    free(buffer);
+
+    return status;
+}
+
+status_t CalcEvalCsv(const calc_program_t* program, FILE* input,
+                        FILE* output, const calc_csv_options_t* options,
+                                                calc_csv_report_t* report)
+{
+    static const calc_csv_options_t defaults = {0, 0, 0, NULL, 0};
+    csv_t csv;
+    status_t status = SUCCESS;
+
+    assert(program);
+    assert(input);
+    assert(output);
+
+    options = NULL == options ? &defaults : options;
+    memset(&csv, 0, sizeof(csv));
+    csv.program = program;
+    csv.output = output;
+    csv.delimiter = 0 == options->delimiter ? ',' : options->delimiter;
+    csv.only_result = options->only_result;
+    csv.num_vars = CalcVariableCount(program);
+    csv.chunk_rows = 0 == options->chunk_rows ? DEFAULT_CHUNK_ROWS :
+                                                        options->chunk_rows;
+
+    status = Allocate(&csv) ? SUCCESS : FAILED_ALLOCATION;
+    if(SUCCESS == status && options->no_header)
+    {
+        status = MapByNumber(&csv);
+    }
+    if(SUCCESS == status)
+    {
+        status = Stream(&csv, input, NULL == options->result_name ?
+                            "result" : options->result_name,
+                                                    !options->no_header);
+    }
+
+    FlushOutput(&csv);
+    if(SUCCESS == status && (csv.write_failed || 0 != fflush(output)))
+    {
+        status = STREAM_ERROR;
+    }
+    if(SUCCESS == status && 0 < csv.report.failed_rows)
+    {
+        status = MATH_ERROR;
+    }
+
+    if(NULL != report)
+    {
+        *report = csv.report;
+    }
+    Free(&csv);
+
+    return status;
+}
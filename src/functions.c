@@ -0,0 +1,121 @@
+#include <math.h>    /* sqrt, exp, log, sin, cos */
+#include <string.h>  /* strncmp */
+#include <assert.h>  /* assert */
+
+#include "functions.h"
+#include "power.h"
+
+typedef struct function_entry
+{
+    const char* name;
+    size_t len;
+    unsigned int arity;
+    function_impl_t impl;
+} function_entry_t;
+
+static status_t Sqrt(double a, double b, double* result)
+{
+    (void)b;
+    if(a < 0)
+    {
+        return MATH_ERROR;
+    }
+
+    *result = sqrt(a);
+
+    return SUCCESS;
+}
+
+static status_t Exp(double a, double b, double* result)
+{
+    (void)b;
+    *result = exp(a);
+
+    return IsFinite(a) && !IsFinite(*result) ? MATH_ERROR : SUCCESS;
+}
+
+static status_t Log(double a, double b, double* result)
+{
+    (void)b;
+    if(a <= 0)
+    {
+        return MATH_ERROR;
+    }
+
+    *result = log(a);
+
+    return SUCCESS;
+}
+
+static status_t Sin(double a, double b, double* result)
+{
+    (void)b;
+    *result = sin(a);
+
+    return SUCCESS;
+}
+
+static status_t Cos(double a, double b, double* result)
+{
+    (void)b;
+    *result = cos(a);
+
+    return SUCCESS;
+}
+
+static status_t Min(double a, double b, double* result)
+{
+    *result = a < b ? a : b;
+
+    return SUCCESS;
+}
+
+static status_t Max(double a, double b, double* result)
+{
+    *result = a > b ? a : b;
+
+    return SUCCESS;
+}
+
+static const function_entry_t functions_LUT[NUM_OF_FUNCTIONS] =
+{
+    {"sqrt", 4, 1, Sqrt},
+    {"exp", 3, 1, Exp},
+    {"log", 3, 1, Log},
+    {"sin", 3, 1, Sin},
+    {"cos", 3, 1, Cos},
+    {"min", 3, 2, Min},
+    {"max", 3, 2, Max}
+};
+
+function_t FindFunction(const char* name, size_t len)
+{
+    size_t i = 0;
+
+    assert(name);
+
+    for( ; i < NUM_OF_FUNCTIONS; ++i)
+    {
+        if(len == functions_LUT[i].len &&
+                                0 == strncmp(name, functions_LUT[i].name, len))
+        {
+            break;
+        }
+    }
+
+    return (function_t)i;
+}
+
+unsigned int FunctionArity(function_t function)
+{
+    assert(function < NUM_OF_FUNCTIONS);
+
+    return functions_LUT[function].arity;
+}
+
+function_impl_t FunctionImpl(function_t function)
+{
+    assert(function < NUM_OF_FUNCTIONS);
+
+    return functions_LUT[function].impl;
+}
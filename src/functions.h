@@ -0,0 +1,48 @@
+#ifndef __FUNCTIONS_H__
+#define __FUNCTIONS_H__
+
+#include <stddef.h> /* size_t */
+
+#include "calculator.h"
+
+/* in the order of their opcodes, OP_SQRT .. OP_MAX */
+typedef enum
+{
+    FUNC_SQRT,
+    FUNC_EXP,
+    FUNC_LOG,
+    FUNC_SIN,
+    FUNC_COS,
+    FUNC_MIN,
+    FUNC_MAX,
+    NUM_OF_FUNCTIONS
+} function_t;
+
+/* Power's signature; functions of one argument ignore the second */
+typedef status_t (*function_impl_t)(double a, double b, double* result);
+
+/* @Desc: Look up a function by name. Function names are reserved: they are
+          never read as variables
+   @params: name, its length
+   @return value: the function, NUM_OF_FUNCTIONS if there is none*/
+
+function_t FindFunction(const char* name, size_t len);
+
+/* @Desc: Get the number of operands a function takes. min and max take two
+          or more arguments, applied two at a time from the left
+   @params: function
+   @return value: 1 or 2*/
+
+unsigned int FunctionArity(function_t function);
+
+/* @Desc: Get the scalar implementation of a function, shared by the
+          in-place evaluator, compiled programs and the JIT. sqrt of a
+          negative number, log of a non-positive one and exp of a finite
+          number that overflows are MATH_ERROR; NaN goes through. min and max
+          are a < b ? a : b and a > b ? a : b, so a NaN in either gives b
+   @params: function
+   @return value: the implementation*/
+
+function_impl_t FunctionImpl(function_t function);
+
+#endif      /* functions.h */
@@ -0,0 +1,504 @@
+#include <stdlib.h>  /* malloc, free */
+#include <string.h>  /* memcpy, memset */
+#include <assert.h>  /* assert */
+#include <math.h>    /* pow, log, sin, cos */
+
+#include "program.h"
+#include "power.h"
+#include "functions.h"
+
+#define BLOCK_ROWS 256
+#define MAX_BLOCK_VALUES (1 << 16)  /* doubles, to stay in the L2 cache */
+
+/* Every slot of the values stack (and every temporary) is a dual number:
+   width = num_vars + 1 arrays of stride lanes, the value then one partial
+   derivative per variable. A lane is one point: a row of the columns, or
+   the program's own variables */
+typedef struct dual_block
+{
+    const calc_program_t* program;
+    const double* const* columns;
+    size_t first;               /* row of the columns in lane 0 */
+    size_t count;               /* lanes in use */
+    size_t stride;
+    size_t width;
+    double* stack;
+    double* temps;
+    unsigned char* failed;
+} dual_block_t;
+
+/* tangent * factor, where a zero tangent stays zero even if factor is
+   infinite or NaN: a partial only depends on the operands it came from */
+static double Chain(double tangent, double factor)
+{
+    return 0 == tangent ? 0 : tangent * factor;
+}
+
+static double* Slot(const dual_block_t* block, double* base, size_t index)
+{
+    return base + index * block->width * block->stride;
+}
+
+static void Push(dual_block_t* block, double* slot, const double* values,
+                                                        size_t unit_tangent)
+{
+    size_t i = 0;
+
+    memcpy(slot, values, block->count * sizeof(double));
+    memset(slot + block->stride, 0,
+                    (block->width - 1) * block->stride * sizeof(double));
+
+    if(0 != unit_tangent)
+    {
+        for( ; i < block->count; ++i)
+        {
+            slot[unit_tangent * block->stride + i] = 1;
+        }
+    }
+}
+
+/* left + sign * right, value and tangents alike; the lanes past count
+   were never pushed */
+static void Add(dual_block_t* block, double* left, const double* right,
+                                                                double sign)
+{
+    size_t k = 0;
+    size_t i = 0;
+
+    for( ; k < block->width; ++k)
+    {
+        for(i = 0; i < block->count; ++i)
+        {
+            left[k * block->stride + i] += sign * right[k * block->stride + i];
+        }
+    }
+}
+
+static void Negate(dual_block_t* block, double* left)
+{
+    size_t k = 0;
+    size_t i = 0;
+
+    for( ; k < block->width; ++k)
+    {
+        for(i = 0; i < block->count; ++i)
+        {
+            left[k * block->stride + i] *= -1;
+        }
+    }
+}
+
+/* the rules that need the values of both operands, for every tangent */
+static void Multiply(dual_block_t* block, double* left, double* right,
+                                                            int checked)
+{
+    double* left_tangent = NULL;
+    double* right_tangent = NULL;
+    size_t k = 1;
+    size_t i = 0;
+
+    for( ; k < block->width; ++k)
+    {
+        left_tangent = left + k * block->stride;
+        right_tangent = right + k * block->stride;
+        for(i = 0; i < block->count; ++i)
+        {
+            left_tangent[i] = Chain(left_tangent[i], right[i]) +
+                                            Chain(right_tangent[i], left[i]);
+        }
+    }
+
+    for(i = 0; i < block->count; ++i)
+    {
+        if(checked)
+        {
+            block->failed[i] |= SUCCESS != PowerMultiply(left[i], right[i],
+                                                                    &left[i]);
+        }
+        else
+        {
+            left[i] *= right[i];
+        }
+    }
+}
+
+static void Divide(dual_block_t* block, double* left, double* right)
+{
+    double* left_tangent = NULL;
+    double* right_tangent = NULL;
+    size_t k = 1;
+    size_t i = 0;
+
+    for(i = 0; i < block->count; ++i)
+    {
+        block->failed[i] |= right[i] == 0;
+        left[i] /= right[i];
+    }
+
+    /* (a / b)' = a' / b - (a / b) * b' / b */
+    for( ; k < block->width; ++k)
+    {
+        left_tangent = left + k * block->stride;
+        right_tangent = right + k * block->stride;
+        for(i = 0; i < block->count; ++i)
+        {
+            left_tangent[i] = Chain(left_tangent[i], 1 / right[i]) -
+                                Chain(right_tangent[i], left[i] / right[i]);
+        }
+    }
+}
+
+/* (a ^ b)' = b * a ^ (b - 1) * a' + log(a) * a ^ b * b'. The second term
+   does not exist for a < 0, and is 0 for a = 0 (its limit from above) */
+static void Raise(dual_block_t* block, double* left, double* right)
+{
+    const double zero = 0;
+    double value = 0;
+    double by_base = 0;
+    double by_exponent = 0;
+    size_t k = 1;
+    size_t i = 0;
+
+    for( ; i < block->count; ++i)
+    {
+        if(block->failed[i] || SUCCESS != Power(left[i], right[i], &value))
+        {
+            block->failed[i] = 1;
+            continue;
+        }
+
+        by_base = right[i] * pow(left[i], right[i] - 1);
+        by_exponent = left[i] > 0 ? log(left[i]) * value :
+                                    left[i] == 0 ? 0 : zero / zero;
+        for(k = 1; k < block->width; ++k)
+        {
+            left[k * block->stride + i] =
+                        Chain(left[k * block->stride + i], by_base) +
+                        Chain(right[k * block->stride + i], by_exponent);
+        }
+        left[i] = value;
+    }
+}
+
+static void Apply(dual_block_t* block, function_t function, double* left,
+                                                                double* right)
+{
+    function_impl_t impl = FunctionImpl(function);
+    double value = 0;
+    double factor = 0;
+    int take_left = 0;
+    size_t k = 1;
+    size_t i = 0;
+
+    for( ; i < block->count; ++i)
+    {
+        if(SUCCESS != impl(left[i], NULL == right ? 0 : right[i], &value))
+        {
+            block->failed[i] = 1;
+            continue;
+        }
+
+        switch(function)
+        {
+            case FUNC_SQRT:
+                factor = 0.5 / value;
+                break;
+
+            case FUNC_EXP:
+                factor = value;
+                break;
+
+            case FUNC_LOG:
+                factor = 1 / left[i];
+                break;
+
+            case FUNC_SIN:
+                factor = cos(left[i]);
+                break;
+
+            case FUNC_COS:
+                factor = -sin(left[i]);
+                break;
+
+            default:
+                /* min and max: the partials of the operand chosen */
+                take_left = FUNC_MIN == function ? left[i] < right[i] :
+                                                        left[i] > right[i];
+                for(k = 1; k < block->width && !take_left; ++k)
+                {
+                    left[k * block->stride + i] =
+                                                right[k * block->stride + i];
+                }
+                left[i] = value;
+                continue;
+        }
+
+        for(k = 1; k < block->width; ++k)
+        {
+            left[k * block->stride + i] =
+                                Chain(left[k * block->stride + i], factor);
+        }
+        left[i] = value;
+    }
+}
+
+static void ExecuteBlock(dual_block_t* block)
+{
+    const calc_program_t* program = block->program;
+    const instruction_t* ip = program->code;
+    const instruction_t* end = ip + program->code_size;
+    const size_t slot_size = block->width * block->stride;
+    double constant[BLOCK_ROWS];
+    double* left = NULL;
+    double* right = NULL;
+    size_t top = 0;
+    size_t i = 0;
+
+    for( ; ip < end; ++ip)
+    {
+        /* the slot pushed next, and the top one under it */
+        right = Slot(block, block->stack, top);
+        left = 0 < top ? right - slot_size : NULL;
+
+        switch(ip->opcode)
+        {
+            case OP_CONST:
+                for(i = 0; i < block->count; ++i)
+                {
+                    constant[i] = program->constants[ip->operand];
+                }
+                Push(block, right, constant, 0);
+                ++top;
+                break;
+
+            case OP_VAR:
+                Push(block, right, block->columns[ip->operand] + block->first,
+                                                            ip->operand + 1);
+                ++top;
+                break;
+
+            case OP_ADD:
+                --top;
+                right = left;
+                left -= slot_size;
+                Add(block, left, right, 1);
+                break;
+
+            case OP_SUB:
+                --top;
+                right = left;
+                left -= slot_size;
+                Add(block, left, right, -1);
+                break;
+
+            case OP_NEG:
+                Negate(block, left);
+                break;
+
+            case OP_MUL:
+            case OP_POWMUL:
+                --top;
+                right = left;
+                left -= slot_size;
+                Multiply(block, left, right, OP_POWMUL == ip->opcode);
+                break;
+
+            case OP_DIV:
+                --top;
+                right = left;
+                left -= slot_size;
+                Divide(block, left, right);
+                break;
+
+            case OP_POW:
+                --top;
+                right = left;
+                left -= slot_size;
+                Raise(block, left, right);
+                break;
+
+            case OP_SQRT:
+            case OP_EXP:
+            case OP_LOG:
+            case OP_SIN:
+            case OP_COS:
+                Apply(block, (function_t)(ip->opcode - OP_SQRT), left, NULL);
+                break;
+
+            case OP_MIN:
+            case OP_MAX:
+                --top;
+                right = left;
+                left -= slot_size;
+                Apply(block, (function_t)(ip->opcode - OP_SQRT), left, right);
+                break;
+
+            case OP_DUP:
+                memcpy(right, left, slot_size * sizeof(double));
+                ++top;
+                break;
+
+            case OP_STORE:
+                memcpy(Slot(block, block->temps, ip->operand), left,
+                                                slot_size * sizeof(double));
+                break;
+
+            case OP_LOAD:
+                memcpy(right, Slot(block, block->temps, ip->operand),
+                                                slot_size * sizeof(double));
+                ++top;
+                break;
+        }
+    }
+}
+
+/* lanes per block, fewer when there are many variables */
+static size_t BlockStride(const calc_program_t* program, size_t rows)
+{
+    size_t slots = program->max_depth + program->num_temps;
+    size_t stride = rows < BLOCK_ROWS ? rows : BLOCK_ROWS;
+
+    while(1 < stride && slots * (program->num_vars + 1) * stride >
+                                                            MAX_BLOCK_VALUES)
+    {
+        stride /= 2;
+    }
+
+    return 0 == stride ? 1 : stride;
+}
+
+static int InitBlock(dual_block_t* block, const calc_program_t* program,
+                            const double* const* columns, size_t stride)
+{
+    size_t slots = program->max_depth + program->num_temps;
+
+    block->program = program;
+    block->columns = columns;
+    block->first = 0;
+    block->count = 0;
+    block->stride = stride;
+    block->width = program->num_vars + 1;
+    block->stack = (double*)malloc(slots * block->width * stride *
+                                                            sizeof(double));
+    block->temps = Slot(block, block->stack, program->max_depth);
+    block->failed = (unsigned char*)malloc(stride);
+
+    if(NULL == block->stack || NULL == block->failed)
+    {
+        free(block->stack);
+        free(block->failed);
+        return 0;
+    }
+
+    return 1;
+}
+
+static void FreeBlock(dual_block_t* block)
+{
+    free(block->stack);
+    free(block->failed);
+}
+
+status_t CalcEvalGradient(const calc_program_t* program, double* ans,
+                                                            double* gradient)
+{
+    dual_block_t block;
+    const double** columns = NULL;
+    size_t i = 0;
+    status_t status = SUCCESS;
+
+    assert(program);
+    assert(ans);
+    assert(gradient || 0 == program->num_vars);
+
+    /* one lane, whose columns are the program's variables */
+    columns = (const double**)malloc((program->num_vars + 1) *
+                                                        sizeof(double*));
+    if(NULL == columns)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; i < program->num_vars; ++i)
+    {
+        columns[i] = program->var_values + i;
+    }
+
+    if(!InitBlock(&block, program, columns, 1))
+    {
+        free(columns);
+        return FAILED_ALLOCATION;
+    }
+
+    block.count = 1;
+    block.failed[0] = 0;
+    ExecuteBlock(&block);
+
+    if(block.failed[0])
+    {
+        status = MATH_ERROR;
+    }
+    else
+    {
+        *ans = block.stack[0];
+        for(i = 0; i < program->num_vars; ++i)
+        {
+            gradient[i] = block.stack[i + 1];
+        }
+    }
+
+    FreeBlock(&block);
+    free(columns);
+
+    return status;
+}
+
+status_t CalcEvalGradientColumns(const calc_program_t* program,
+                        const double* const* columns, size_t rows,
+                        double* results, double* const* gradients,
+                        status_t* statuses)
+{
+    dual_block_t block;
+    size_t first = 0;
+    size_t i = 0;
+    size_t k = 0;
+    status_t status = SUCCESS;
+
+    assert(program);
+    assert(columns || 0 == program->num_vars);
+    assert(results || 0 == rows);
+    assert(gradients || 0 == program->num_vars);
+
+    if(!InitBlock(&block, program, columns, BlockStride(program, rows)))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; first < rows; first += block.count)
+    {
+        block.first = first;
+        block.count = rows - first < block.stride ? rows - first :
+                                                                block.stride;
+        memset(block.failed, 0, block.count);
+        ExecuteBlock(&block);
+
+        for(i = 0; i < block.count; ++i)
+        {
+            results[first + i] = block.stack[i];
+            for(k = 0; k < program->num_vars; ++k)
+            {
+                gradients[k][first + i] =
+                                    block.stack[(k + 1) * block.stride + i];
+            }
+            if(NULL != statuses)
+            {
+                statuses[first + i] = block.failed[i] ? MATH_ERROR : SUCCESS;
+            }
+            status = block.failed[i] ? MATH_ERROR : status;
+        }
+    }
+
+    FreeBlock(&block);
+
+    return status;
+}
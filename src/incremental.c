@@ -0,0 +1,409 @@
+#include <stdlib.h>  /* malloc, calloc, free */
+#include <string.h>  /* memset */
+#include <assert.h>  /* assert */
+
+#include "program.h"
+#include "power.h"
+#include "functions.h"
+
+#define NO_NODE ((size_t)-1)
+#define WORD_BITS (8 * sizeof(unsigned long))
+
+/* One node per value of the program, children before their parents, as in
+   the optimizer. OP_DUP, OP_STORE and OP_LOAD make no node: they hand the
+   same node to several parents, and every use of a variable is one node */
+typedef struct node
+{
+    unsigned int opcode;
+    unsigned int operand;   /* constant or variable index */
+    size_t left;            /* NO_NODE for leaves */
+    size_t right;           /* NO_NODE for leaves, OP_NEG and functions of
+                               one argument */
+} node_t;
+
+struct dependency_tree
+{
+    node_t* nodes;
+    size_t num_nodes;
+    size_t root;
+    double* values;         /* cached value of every node */
+    unsigned char* failed;  /* math error in the node or below it */
+    size_t* first_parent;   /* parents of node i are parents[first_parent[i]]
+                               up to parents[first_parent[i + 1]] */
+    size_t* parents;
+    size_t* var_nodes;      /* node of each variable, NO_NODE if unused */
+    size_t* pending;        /* nodes to mark, while marking */
+    unsigned long* dirty;   /* one bit per node to recompute */
+};
+
+/* the same operations CalcEval runs */
+static status_t Compute(unsigned int opcode, double a, double b,
+                                                            double* result)
+{
+    switch(opcode)
+    {
+        case OP_ADD:
+            *result = a + b;
+            break;
+
+        case OP_SUB:
+            *result = a - b;
+            break;
+
+        case OP_NEG:
+            *result = a * -1;
+            break;
+
+        case OP_MUL:
+            *result = a * b;
+            break;
+
+        case OP_DIV:
+            if(b == 0)
+            {
+                return MATH_ERROR;
+            }
+            *result = a / b;
+            break;
+
+        case OP_POW:
+            return Power(a, b, result);
+
+        case OP_POWMUL:
+            return PowerMultiply(a, b, result);
+
+        case OP_SQRT:
+        case OP_EXP:
+        case OP_LOG:
+        case OP_SIN:
+        case OP_COS:
+        case OP_MIN:
+        case OP_MAX:
+            return FunctionImpl((function_t)(opcode - OP_SQRT))(a, b, result);
+
+        default:
+            return MATH_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+static size_t AddNode(dependency_tree_t* tree, unsigned int opcode,
+                            unsigned int operand, size_t left, size_t right)
+{
+    node_t* node = tree->nodes + tree->num_nodes;
+
+    node->opcode = opcode;
+    node->operand = operand;
+    node->left = left;
+    node->right = right;
+
+    return tree->num_nodes++;
+}
+
+/* replays the values stack of the program on node indices */
+static void BuildNodes(dependency_tree_t* tree, const calc_program_t* program,
+                                                size_t* stack, size_t* temps)
+{
+    const instruction_t* ip = program->code;
+    const instruction_t* end = ip + program->code_size;
+    size_t top = 0;
+
+    for( ; ip < end; ++ip)
+    {
+        switch(ip->opcode)
+        {
+            case OP_CONST:
+                stack[top++] = AddNode(tree, OP_CONST, ip->operand, NO_NODE,
+                                                                    NO_NODE);
+                break;
+
+            case OP_VAR:
+                if(NO_NODE == tree->var_nodes[ip->operand])
+                {
+                    tree->var_nodes[ip->operand] = AddNode(tree, OP_VAR,
+                                            ip->operand, NO_NODE, NO_NODE);
+                }
+                stack[top++] = tree->var_nodes[ip->operand];
+                break;
+
+            case OP_NEG:
+            case OP_SQRT:
+            case OP_EXP:
+            case OP_LOG:
+            case OP_SIN:
+            case OP_COS:
+                stack[top - 1] = AddNode(tree, ip->opcode, 0, stack[top - 1],
+                                                                    NO_NODE);
+                break;
+
+            case OP_DUP:
+                stack[top] = stack[top - 1];
+                ++top;
+                break;
+
+            case OP_STORE:
+                temps[ip->operand] = stack[top - 1];
+                break;
+
+            case OP_LOAD:
+                stack[top++] = temps[ip->operand];
+                break;
+
+            default:
+                --top;
+                stack[top - 1] = AddNode(tree, ip->opcode, 0, stack[top - 1],
+                                                                stack[top]);
+                break;
+        }
+    }
+
+    tree->root = stack[0];
+}
+
+/* x*x is one parent of x, not two */
+static int HasRight(const node_t* node)
+{
+    return NO_NODE != node->right && node->right != node->left;
+}
+
+/* the parents of all nodes in one array, grouped by child */
+static void LinkParents(dependency_tree_t* tree)
+{
+    size_t* first_parent = tree->first_parent;
+    const node_t* node = NULL;
+    size_t i = 0;
+
+    memset(first_parent, 0, (tree->num_nodes + 1) * sizeof(size_t));
+
+    for( ; i < tree->num_nodes; ++i)
+    {
+        node = tree->nodes + i;
+        if(NO_NODE != node->left)
+        {
+            ++first_parent[node->left + 1];
+        }
+        if(HasRight(node))
+        {
+            ++first_parent[node->right + 1];
+        }
+    }
+
+    for(i = 0; i < tree->num_nodes; ++i)
+    {
+        first_parent[i + 1] += first_parent[i];
+    }
+
+    /* filling moves the start of each group to the start of the next */
+    for(i = 0; i < tree->num_nodes; ++i)
+    {
+        node = tree->nodes + i;
+        if(NO_NODE != node->left)
+        {
+            tree->parents[first_parent[node->left]++] = i;
+        }
+        if(HasRight(node))
+        {
+            tree->parents[first_parent[node->right]++] = i;
+        }
+    }
+
+    for(i = tree->num_nodes; 0 < i; --i)
+    {
+        first_parent[i] = first_parent[i - 1];
+    }
+    first_parent[0] = 0;
+}
+
+static int IsDirty(const dependency_tree_t* tree, size_t node)
+{
+    return 0 != (tree->dirty[node / WORD_BITS] & 1UL << node % WORD_BITS);
+}
+
+static void SetDirty(dependency_tree_t* tree, size_t node)
+{
+    tree->dirty[node / WORD_BITS] |= 1UL << node % WORD_BITS;
+}
+
+static dependency_tree_t* CreateTree(const calc_program_t* program)
+{
+    dependency_tree_t* tree = (dependency_tree_t*)calloc(1,
+                                                    sizeof(dependency_tree_t));
+    size_t size = program->code_size;
+    size_t words = size / WORD_BITS + 1;
+    size_t* scratch = NULL;
+    size_t i = 0;
+
+    if(NULL == tree)
+    {
+        return NULL;
+    }
+
+    tree->nodes = (node_t*)malloc(size * sizeof(node_t));
+    tree->values = (double*)malloc(size * sizeof(double));
+    tree->failed = (unsigned char*)malloc(size);
+    tree->first_parent = (size_t*)malloc((size + 1) * sizeof(size_t));
+    tree->parents = (size_t*)malloc(2 * size * sizeof(size_t));
+    tree->var_nodes = (size_t*)malloc((program->num_vars + 1) *
+                                                            sizeof(size_t));
+    tree->pending = (size_t*)malloc(size * sizeof(size_t));
+    tree->dirty = (unsigned long*)malloc(words * sizeof(unsigned long));
+    scratch = (size_t*)malloc((program->max_depth + program->num_temps + 1) *
+                                                            sizeof(size_t));
+    if(NULL == tree->nodes || NULL == tree->values || NULL == tree->failed ||
+        NULL == tree->first_parent || NULL == tree->parents ||
+        NULL == tree->var_nodes || NULL == tree->pending ||
+                                        NULL == tree->dirty || NULL == scratch)
+    {
+        free(scratch);
+        DependencyTreeDestroy(tree);
+        return NULL;
+    }
+
+    for( ; i < program->num_vars; ++i)
+    {
+        tree->var_nodes[i] = NO_NODE;
+    }
+
+    BuildNodes(tree, program, scratch, scratch + program->max_depth);
+    LinkParents(tree);
+    free(scratch);
+
+    /* nothing is computed yet */
+    memset(tree->dirty, 0, words * sizeof(unsigned long));
+    for(i = 0; i < tree->num_nodes; ++i)
+    {
+        SetDirty(tree, i);
+    }
+
+    return tree;
+}
+
+void DependencyTreeDestroy(dependency_tree_t* tree)
+{
+    if(NULL == tree)
+    {
+        return;
+    }
+
+    free(tree->nodes);
+    free(tree->values);
+    free(tree->failed);
+    free(tree->first_parent);
+    free(tree->parents);
+    free(tree->var_nodes);
+    free(tree->pending);
+    free(tree->dirty);
+    free(tree);
+}
+
+/* a dirty node's ancestors are all dirty already, so marking stops there */
+void DependencyTreeMarkVariable(dependency_tree_t* tree, size_t index)
+{
+    size_t num_pending = 0;
+    size_t node = tree->var_nodes[index];
+    size_t child = 0;
+    size_t parent = 0;
+
+    if(NO_NODE == node || IsDirty(tree, node))
+    {
+        return;
+    }
+
+    SetDirty(tree, node);
+    tree->pending[num_pending++] = node;
+
+    while(0 < num_pending)
+    {
+        child = tree->pending[--num_pending];
+        for(parent = tree->first_parent[child];
+                            parent < tree->first_parent[child + 1]; ++parent)
+        {
+            node = tree->parents[parent];
+            if(!IsDirty(tree, node))
+            {
+                SetDirty(tree, node);
+                tree->pending[num_pending++] = node;
+            }
+        }
+    }
+}
+
+static void Recompute(dependency_tree_t* tree, const calc_program_t* program,
+                                                                size_t index)
+{
+    const node_t* node = tree->nodes + index;
+    double right = 0;
+
+    switch(node->opcode)
+    {
+        case OP_CONST:
+            tree->values[index] = program->constants[node->operand];
+            tree->failed[index] = 0;
+            return;
+
+        case OP_VAR:
+            tree->values[index] = program->var_values[node->operand];
+            tree->failed[index] = 0;
+            return;
+    }
+
+    if(tree->failed[node->left] ||
+                        (NO_NODE != node->right && tree->failed[node->right]))
+    {
+        tree->failed[index] = 1;
+        return;
+    }
+
+    right = NO_NODE == node->right ? 0 : tree->values[node->right];
+    tree->failed[index] = SUCCESS != Compute(node->opcode,
+                    tree->values[node->left], right, &tree->values[index]);
+}
+
+/* lower bits first, so operands are always recomputed before the nodes
+   that use them */
+static void Update(dependency_tree_t* tree, const calc_program_t* program)
+{
+    size_t words = tree->num_nodes / WORD_BITS + 1;
+    size_t word = 0;
+    unsigned long bits = 0;
+
+    for( ; word < words; ++word)
+    {
+        bits = tree->dirty[word];
+        tree->dirty[word] = 0;
+        while(0 != bits)
+        {
+            Recompute(tree, program, word * WORD_BITS + __builtin_ctzl(bits));
+            bits &= bits - 1;
+        }
+    }
+}
+
+status_t CalcEvalIncremental(calc_program_t* program, double* ans)
+{
+    dependency_tree_t* tree = NULL;
+
+    assert(program);
+    assert(ans);
+
+    if(NULL == program->tree)
+    {
+        program->tree = CreateTree(program);
+        if(NULL == program->tree)
+        {
+            return FAILED_ALLOCATION;
+        }
+    }
+
+    tree = program->tree;
+    Update(tree, program);
+    if(tree->failed[tree->root])
+    {
+        return MATH_ERROR;
+    }
+
+    *ans = tree->values[tree->root];
+
+    return SUCCESS;
+}
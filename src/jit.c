@@ -0,0 +1,655 @@
+#define _DEFAULT_SOURCE     /* MAP_ANONYMOUS */
+
+#include <stdlib.h>  /* malloc, realloc, free */
+#include <string.h>  /* memcpy */
+#include <assert.h>  /* assert */
+
+#include "program.h"
+#include "power.h"
+#include "functions.h"
+
+#if defined(__x86_64__) && defined(__unix__)
+
+#include <stddef.h>    /* offsetof */
+#include <sys/mman.h>  /* mmap, mprotect, munmap */
+
+#define JIT_REGISTERS 14    /* values stack slots kept in xmm0 - xmm13 */
+#define SCRATCH 14          /* xmm14 */
+#define ZERO 15             /* xmm15, 0 for divisor checks */
+#define MAX_FRAME_SLOTS 4096
+#define INITIAL_CAPACITY 256
+
+/* x86-64 encodings */
+#define REX 0x40
+#define REX_R 0x04
+#define REX_B 0x01
+#define PREFIX_SD 0xF2
+#define PREFIX_PD 0x66
+#define MOVSD_LOAD 0x10
+#define MOVSD_STORE 0x11
+#define UCOMISD 0x2E
+#define XORPD 0x57
+#define ADDSD 0x58
+#define MULSD 0x59
+#define SUBSD 0x5C
+#define DIVSD 0x5E
+#define SQRTSD 0x51
+#define MINSD 0x5D      /* dst < src ? dst : src, as min in CalcEval */
+#define MAXSD 0x5F
+
+struct jit_code
+{
+    void* memory;
+    size_t size;
+    calc_eval_func_t func;
+};
+
+typedef enum
+{
+    IN_XMM,
+    IN_FRAME,       /* [rsp + disp] */
+    IN_VARIABLES,   /* [rbx + disp] */
+    IN_POOL         /* constant pool entry disp, RIP-relative */
+} location_t;
+
+typedef struct operand
+{
+    location_t location;
+    unsigned int index;     /* xmm register, byte offset or pool entry */
+} operand_t;
+
+typedef enum
+{
+    TO_POOL,
+    TO_ERROR,       /* returns MATH_ERROR */
+    TO_EXIT         /* returns the status in eax */
+} fixup_kind_t;
+
+/* a rel32 to patch once the code size is known */
+typedef struct fixup
+{
+    size_t at;
+    fixup_kind_t kind;
+    unsigned int index;     /* pool entry */
+} fixup_t;
+
+typedef struct assembler
+{
+    unsigned char* code;
+    size_t size;
+    size_t capacity;
+    fixup_t* fixups;
+    size_t num_fixups;
+    size_t fixups_capacity;
+    size_t max_depth;       /* frame slots of the values stack */
+    int failed;             /* an allocation failed, the code is incomplete */
+} assembler_t;
+
+typedef status_t (*jit_call_t)(double, double, double*);
+
+static int Grow(void** buffer, size_t* capacity, size_t size,
+                                                        size_t element_size)
+{
+    size_t new_capacity = *capacity * 2;
+    void* new_buffer = NULL;
+
+    if(size < *capacity)
+    {
+        return 1;
+    }
+
+    new_buffer = realloc(*buffer, new_capacity * element_size);
+    if(NULL == new_buffer)
+    {
+        return 0;
+    }
+
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+static void EmitBytes(assembler_t* as, const unsigned char* bytes, size_t n)
+{
+    size_t i = 0;
+
+    for( ; i < n && !as->failed; ++i)
+    {
+        if(!Grow((void**)&as->code, &as->capacity, as->size, 1))
+        {
+            as->failed = 1;
+            return;
+        }
+
+        as->code[as->size++] = bytes[i];
+    }
+}
+
+static void EmitByte(assembler_t* as, unsigned char byte)
+{
+    EmitBytes(as, &byte, 1);
+}
+
+static void EmitWord(assembler_t* as, unsigned long word, size_t n)
+{
+    unsigned char bytes[8];
+    size_t i = 0;
+
+    for( ; i < n; ++i, word >>= 8)
+    {
+        bytes[i] = (unsigned char)(word & 0xFF);
+    }
+
+    EmitBytes(as, bytes, n);
+}
+
+/* a rel32 placeholder patched by Link */
+static void EmitFixup(assembler_t* as, fixup_kind_t kind, unsigned int index)
+{
+    fixup_t* fixup = NULL;
+
+    if(!Grow((void**)&as->fixups, &as->fixups_capacity, as->num_fixups,
+                                                            sizeof(fixup_t)))
+    {
+        as->failed = 1;
+        return;
+    }
+
+    fixup = as->fixups + as->num_fixups++;
+    fixup->at = as->size;
+    fixup->kind = kind;
+    fixup->index = index;
+    EmitWord(as, 0, 4);
+}
+
+/* prefix [REX] 0F opcode ModRM [SIB] [disp32], reg being an xmm register */
+static void EmitSse(assembler_t* as, unsigned char prefix,
+                unsigned char opcode, unsigned int reg, const operand_t* rm)
+{
+    unsigned char rex = REX | (reg >= 8 ? REX_R : 0);
+    unsigned char modrm = (unsigned char)((reg & 7) << 3);
+
+    if(IN_XMM == rm->location && rm->index >= 8)
+    {
+        rex |= REX_B;
+    }
+
+    EmitByte(as, prefix);
+    if(REX != rex)
+    {
+        EmitByte(as, rex);
+    }
+    EmitByte(as, 0x0F);
+    EmitByte(as, opcode);
+
+    switch(rm->location)
+    {
+        case IN_XMM:
+            EmitByte(as, modrm | 0xC0 | (rm->index & 7));
+            break;
+
+        case IN_FRAME:
+            EmitByte(as, modrm | 0x84);     /* [rsp + disp32] */
+            EmitByte(as, 0x24);
+            EmitWord(as, rm->index, 4);
+            break;
+
+        case IN_VARIABLES:
+            EmitByte(as, modrm | 0x83);     /* [rbx + disp32] */
+            EmitWord(as, rm->index, 4);
+            break;
+
+        case IN_POOL:
+            EmitByte(as, modrm | 0x05);     /* [rip + disp32] */
+            EmitFixup(as, TO_POOL, rm->index);
+            break;
+    }
+}
+
+static operand_t Xmm(unsigned int reg)
+{
+    operand_t operand;
+
+    operand.location = IN_XMM;
+    operand.index = reg;
+
+    return operand;
+}
+
+static operand_t Memory(location_t location, size_t index)
+{
+    operand_t operand;
+
+    operand.location = location;
+    operand.index = (unsigned int)index;
+
+    return operand;
+}
+
+/* the values stack lives in registers, the deeper slots in the frame */
+static operand_t Slot(size_t slot)
+{
+    return slot < JIT_REGISTERS ? Xmm((unsigned int)slot) :
+                                            Memory(IN_FRAME, slot * 8);
+}
+
+static operand_t Temporary(const assembler_t* as, size_t index)
+{
+    return Memory(IN_FRAME, (as->max_depth + index) * 8);
+}
+
+static void Move(assembler_t* as, operand_t dst, operand_t src)
+{
+    if(IN_XMM == dst.location)
+    {
+        EmitSse(as, PREFIX_SD, MOVSD_LOAD, dst.index, &src);
+    }
+    else if(IN_XMM == src.location)
+    {
+        EmitSse(as, PREFIX_SD, MOVSD_STORE, src.index, &dst);
+    }
+    else
+    {
+        EmitSse(as, PREFIX_SD, MOVSD_LOAD, SCRATCH, &src);
+        EmitSse(as, PREFIX_SD, MOVSD_STORE, SCRATCH, &dst);
+    }
+}
+
+/* dst = dst op src */
+static void Arithmetic(assembler_t* as, unsigned char opcode, operand_t dst,
+                                                                operand_t src)
+{
+    if(IN_XMM == dst.location)
+    {
+        EmitSse(as, PREFIX_SD, opcode, dst.index, &src);
+        return;
+    }
+
+    Move(as, Xmm(SCRATCH), dst);
+    EmitSse(as, PREFIX_SD, opcode, SCRATCH, &src);
+    Move(as, dst, Xmm(SCRATCH));
+}
+
+/* flips the sign bit, NaN included, which is what compilers make of
+   CalcEval's x * -1; sign is the pool entry holding -0 */
+static void Negate(assembler_t* as, operand_t dst, operand_t sign)
+{
+    operand_t scratch = Xmm(SCRATCH);
+    operand_t mask = Xmm(ZERO);
+
+    if(IN_XMM == dst.location)
+    {
+        Move(as, scratch, sign);
+        EmitSse(as, PREFIX_PD, XORPD, dst.index, &scratch);
+        return;
+    }
+
+    Move(as, scratch, dst);
+    Move(as, mask, sign);
+    EmitSse(as, PREFIX_PD, XORPD, SCRATCH, &mask);
+    Move(as, dst, scratch);
+}
+
+/* jumps to the MATH_ERROR exit if divisor is 0, as CalcEval checks it */
+static void CheckDivisor(assembler_t* as, operand_t divisor)
+{
+    static const unsigned char jump_if_unordered[] = {0x7A, 0x06};
+    static const unsigned char jump_if_equal[] = {0x0F, 0x84};
+    operand_t zero = Xmm(ZERO);
+
+    EmitSse(as, PREFIX_PD, XORPD, ZERO, &zero);
+    EmitSse(as, PREFIX_PD, UCOMISD, ZERO, &divisor);
+    /* NaN compares unordered, which also sets ZF */
+    EmitBytes(as, jump_if_unordered, sizeof(jump_if_unordered));
+    EmitBytes(as, jump_if_equal, sizeof(jump_if_equal));
+    EmitFixup(as, TO_ERROR, 0);
+}
+
+/* result = func(a, b, &result) on the arity top slots, out of top. Every
+   xmm register is caller-saved, so the live slots go through the frame */
+static void EmitCall(assembler_t* as, jit_call_t func, size_t top,
+                                                            size_t arity)
+{
+    static const unsigned char lea_rdi[] = {0x48, 0x8D, 0xBC, 0x24};
+    static const unsigned char mov_rax[] = {0x48, 0xB8};
+    static const unsigned char call_rax[] = {0xFF, 0xD0};
+    static const unsigned char test_eax[] = {0x85, 0xC0};
+    static const unsigned char jump_if_not_zero[] = {0x0F, 0x85};
+    unsigned char address[sizeof(func)];
+    size_t first = top - arity;
+    size_t slot = 0;
+
+    for( ; slot < top && slot < JIT_REGISTERS; ++slot)
+    {
+        Move(as, Memory(IN_FRAME, slot * 8), Xmm((unsigned int)slot));
+    }
+
+    Move(as, Xmm(0), Memory(IN_FRAME, first * 8));
+    if(2 == arity)
+    {
+        Move(as, Xmm(1), Memory(IN_FRAME, (top - 1) * 8));
+    }
+    EmitBytes(as, lea_rdi, sizeof(lea_rdi));
+    EmitWord(as, first * 8, 4);
+
+    memcpy(address, &func, sizeof(func));
+    EmitBytes(as, mov_rax, sizeof(mov_rax));
+    EmitBytes(as, address, sizeof(address));
+    EmitBytes(as, call_rax, sizeof(call_rax));
+
+    EmitBytes(as, test_eax, sizeof(test_eax));
+    EmitBytes(as, jump_if_not_zero, sizeof(jump_if_not_zero));
+    EmitFixup(as, TO_EXIT, 0);
+
+    for(slot = 0; slot <= first && slot < JIT_REGISTERS; ++slot)
+    {
+        Move(as, Xmm((unsigned int)slot), Memory(IN_FRAME, slot * 8));
+    }
+}
+
+/* sqrtsd, after jumping to the MATH_ERROR exit if the operand is negative
+   (0 > NaN is unordered, so NaN goes through as it does in CalcEval) */
+static void SquareRoot(assembler_t* as, operand_t dst)
+{
+    static const unsigned char jump_if_above[] = {0x0F, 0x87};
+    operand_t zero = Xmm(ZERO);
+
+    EmitSse(as, PREFIX_PD, XORPD, ZERO, &zero);
+    EmitSse(as, PREFIX_PD, UCOMISD, ZERO, &dst);
+    EmitBytes(as, jump_if_above, sizeof(jump_if_above));
+    EmitFixup(as, TO_ERROR, 0);
+    Arithmetic(as, SQRTSD, dst, dst);
+}
+
+/* status_t f(const calc_program_t* rdi, double* rsi), with rbx holding the
+   variables and r12 the answer. The pushes and the frame keep rsp 16-byte
+   aligned for the calls */
+static void EmitPrologue(assembler_t* as, size_t frame)
+{
+    static const unsigned char push_rbx_r12[] = {0x53, 0x41, 0x54};
+    static const unsigned char sub_rsp[] = {0x48, 0x81, 0xEC};
+    static const unsigned char mov_rbx_rdi[] = {0x48, 0x8B, 0x9F};
+    static const unsigned char mov_r12_rsi[] = {0x49, 0x89, 0xF4};
+
+    EmitBytes(as, push_rbx_r12, sizeof(push_rbx_r12));
+    EmitBytes(as, sub_rsp, sizeof(sub_rsp));
+    EmitWord(as, frame, 4);
+    EmitBytes(as, mov_rbx_rdi, sizeof(mov_rbx_rdi));
+    EmitWord(as, offsetof(calc_program_t, var_values), 4);
+    EmitBytes(as, mov_r12_rsi, sizeof(mov_r12_rsi));
+}
+
+/* stores the answer and returns SUCCESS; returns eax from exit, MATH_ERROR
+   from error */
+static void EmitEpilogue(assembler_t* as, size_t frame, size_t* exit,
+                                                                size_t* error)
+{
+    static const unsigned char movsd_r12_xmm0[] =
+                                        {0xF2, 0x41, 0x0F, 0x11, 0x04, 0x24};
+    static const unsigned char xor_eax[] = {0x31, 0xC0};
+    static const unsigned char add_rsp[] = {0x48, 0x81, 0xC4};
+    static const unsigned char pop_r12_rbx_ret[] = {0x41, 0x5C, 0x5B, 0xC3};
+    static const unsigned char mov_eax[] = {0xB8};
+    static const unsigned char jump[] = {0xE9};
+
+    EmitBytes(as, movsd_r12_xmm0, sizeof(movsd_r12_xmm0));
+    EmitBytes(as, xor_eax, sizeof(xor_eax));
+    *exit = as->size;
+    EmitBytes(as, add_rsp, sizeof(add_rsp));
+    EmitWord(as, frame, 4);
+    EmitBytes(as, pop_r12_rbx_ret, sizeof(pop_r12_rbx_ret));
+
+    *error = as->size;
+    EmitBytes(as, mov_eax, sizeof(mov_eax));
+    EmitWord(as, MATH_ERROR, 4);
+    EmitBytes(as, jump, sizeof(jump));
+    EmitWord(as, (unsigned long)(*exit - (as->size + 4)), 4);
+}
+
+static void Assemble(assembler_t* as, const calc_program_t* program,
+                                                                size_t frame)
+{
+    const instruction_t* ip = program->code;
+    const instruction_t* end = ip + program->code_size;
+    size_t top = 0;
+
+    EmitPrologue(as, frame);
+
+    for( ; ip < end && !as->failed; ++ip)
+    {
+        switch(ip->opcode)
+        {
+            case OP_CONST:
+                Move(as, Slot(top++), Memory(IN_POOL, ip->operand));
+                break;
+
+            case OP_VAR:
+                Move(as, Slot(top++), Memory(IN_VARIABLES, ip->operand * 8));
+                break;
+
+            case OP_ADD:
+                --top;
+                Arithmetic(as, ADDSD, Slot(top - 1), Slot(top));
+                break;
+
+            case OP_SUB:
+                --top;
+                Arithmetic(as, SUBSD, Slot(top - 1), Slot(top));
+                break;
+
+            case OP_NEG:
+                Negate(as, Slot(top - 1),
+                                Memory(IN_POOL, program->num_constants));
+                break;
+
+            case OP_MUL:
+                --top;
+                Arithmetic(as, MULSD, Slot(top - 1), Slot(top));
+                break;
+
+            case OP_DIV:
+                --top;
+                CheckDivisor(as, Slot(top));
+                Arithmetic(as, DIVSD, Slot(top - 1), Slot(top));
+                break;
+
+            case OP_POW:
+                EmitCall(as, Power, top, 2);
+                --top;
+                break;
+
+            case OP_POWMUL:
+                EmitCall(as, PowerMultiply, top, 2);
+                --top;
+                break;
+
+            case OP_SQRT:
+                SquareRoot(as, Slot(top - 1));
+                break;
+
+            case OP_EXP:
+            case OP_LOG:
+            case OP_SIN:
+            case OP_COS:
+                EmitCall(as, FunctionImpl((function_t)(ip->opcode - OP_SQRT)),
+                                                                    top, 1);
+                break;
+
+            case OP_MIN:
+                --top;
+                Arithmetic(as, MINSD, Slot(top - 1), Slot(top));
+                break;
+
+            case OP_MAX:
+                --top;
+                Arithmetic(as, MAXSD, Slot(top - 1), Slot(top));
+                break;
+
+            case OP_DUP:
+                Move(as, Slot(top), Slot(top - 1));
+                ++top;
+                break;
+
+            case OP_STORE:
+                Move(as, Temporary(as, ip->operand), Slot(top - 1));
+                break;
+
+            case OP_LOAD:
+                Move(as, Slot(top++), Temporary(as, ip->operand));
+                break;
+        }
+    }
+}
+
+/* patches the rel32 fixups of code placed at memory, with the pool after
+   it */
+static void Link(const assembler_t* as, unsigned char* memory, size_t pool,
+                                            size_t exit, size_t error)
+{
+    size_t i = 0;
+    size_t target = 0;
+    unsigned long rel = 0;
+    const fixup_t* fixup = NULL;
+
+    for( ; i < as->num_fixups; ++i)
+    {
+        fixup = as->fixups + i;
+        target = TO_POOL == fixup->kind ? pool + fixup->index * 8 :
+                                        TO_EXIT == fixup->kind ? exit : error;
+        rel = (unsigned long)(target - (fixup->at + 4));
+        memory[fixup->at] = (unsigned char)(rel & 0xFF);
+        memory[fixup->at + 1] = (unsigned char)((rel >> 8) & 0xFF);
+        memory[fixup->at + 2] = (unsigned char)((rel >> 16) & 0xFF);
+        memory[fixup->at + 3] = (unsigned char)((rel >> 24) & 0xFF);
+    }
+}
+
+/* maps the code and its constant pool writable, then only executable */
+static jit_code_t* Load(const assembler_t* as, const calc_program_t* program,
+                                                size_t exit, size_t error)
+{
+    size_t pool = (as->size + 7) & ~(size_t)7;
+    size_t size = pool + (program->num_constants + 1) * sizeof(double);
+    double sign = -0.0;
+    void* memory = NULL;
+    jit_code_t* jit = (jit_code_t*)malloc(sizeof(jit_code_t));
+
+    if(NULL == jit)
+    {
+        return NULL;
+    }
+
+    memory = mmap(NULL, size, PROT_READ | PROT_WRITE,
+                                        MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if(MAP_FAILED == memory)
+    {
+        free(jit);
+        return NULL;
+    }
+
+    memcpy(memory, as->code, as->size);
+    if(0 < program->num_constants)
+    {
+        memcpy((unsigned char*)memory + pool, program->constants,
+                                    program->num_constants * sizeof(double));
+    }
+    memcpy((unsigned char*)memory + pool + program->num_constants *
+                            sizeof(double), &sign, sizeof(double));
+    Link(as, (unsigned char*)memory, pool, exit, error);
+
+    if(0 != mprotect(memory, size, PROT_READ | PROT_EXEC))
+    {
+        munmap(memory, size);
+        free(jit);
+        return NULL;
+    }
+
+    jit->memory = memory;
+    jit->size = size;
+    /* ISO C has no object to function pointer conversion */
+    memcpy(&jit->func, &memory, sizeof(jit->func));
+
+    return jit;
+}
+
+static jit_code_t* Compile(const calc_program_t* program)
+{
+    assembler_t as;
+    size_t slots = program->max_depth + program->num_temps;
+    size_t frame = ((slots * 8 + 15) & ~(size_t)15) + 8;
+    size_t exit = 0;
+    size_t error = 0;
+    jit_code_t* jit = NULL;
+
+    /* deeper programs would need a stack frame too large to be safe */
+    if(slots > MAX_FRAME_SLOTS)
+    {
+        return NULL;
+    }
+
+    as.code = (unsigned char*)malloc(INITIAL_CAPACITY);
+    as.size = 0;
+    as.capacity = INITIAL_CAPACITY;
+    as.fixups = (fixup_t*)malloc(INITIAL_CAPACITY * sizeof(fixup_t));
+    as.num_fixups = 0;
+    as.fixups_capacity = INITIAL_CAPACITY;
+    as.max_depth = program->max_depth;
+    as.failed = NULL == as.code || NULL == as.fixups;
+
+    if(!as.failed)
+    {
+        Assemble(&as, program, frame);
+        EmitEpilogue(&as, frame, &exit, &error);
+    }
+
+    if(!as.failed)
+    {
+        jit = Load(&as, program, exit, error);
+    }
+
+    free(as.code);
+    free(as.fixups);
+
+    return jit;
+}
+
+calc_eval_func_t CalcJit(calc_program_t* program)
+{
+    assert(program);
+
+    if(NULL == program->jit)
+    {
+        program->jit = Compile(program);
+    }
+
+    return NULL != program->jit ? program->jit->func : CalcEval;
+}
+
+void JitCodeDestroy(jit_code_t* jit)
+{
+    if(NULL == jit)
+    {
+        return;
+    }
+
+    munmap(jit->memory, jit->size);
+    free(jit);
+}
+
+#else
+
+/* other architectures use the interpreter */
+calc_eval_func_t CalcJit(calc_program_t* program)
+{
+    assert(program);
+
+    return CalcEval;
+}
+
+void JitCodeDestroy(jit_code_t* jit)
+{
+    assert(NULL == jit);
+}
+
+#endif
@@ -0,0 +1,489 @@
+#include <assert.h>  /* assert */
+#include <float.h>   /* DBL_MIN, DBL_MAX */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__) &&                                 \
+                                    (defined(__x86_64__) || defined(__i386__))
+#define HAS_AVX2
+#include <immintrin.h>
+#endif
+
+#include "kernels.h"
+
+/* The vector kernels follow fdlibm: the same reductions, the same
+   polynomials, without its branches, so every lane runs the same code. */
+
+#define ROUNDING 6755399441055744.0     /* 1.5 * 2^52: x + it - it rounds x
+                                           to an integer held in its low
+                                           bits */
+#define ROUNDING_BITS 0x4338000000000000L
+#define EXPONENT_ONE 0x3FF0000000000000L
+#define MANTISSA 0x000FFFFFFFFFFFFFL
+#define MAX_EXP_ARGUMENT 708.0          /* exp stays normal up to here */
+#define MAX_TRIG_ARGUMENT 1e6           /* three pieces of pi/2 suffice */
+
+/* exp */
+#define INV_LN2 1.44269504088896338700e+00
+#define LN2_HI 6.93147180369123816490e-01
+#define LN2_LO 1.90821492927058770002e-10
+#define P1 1.66666666666666019037e-01
+#define P2 -2.77777777770155933842e-03
+#define P3 6.61375632143793436117e-05
+#define P4 -1.65339022054652515390e-06
+#define P5 4.13813679705723846039e-08
+
+/* log: 1 + f is taken in [sqrt(2) / 2, sqrt(2)) */
+#define SQRT2_CARRY 0x00095F6400000000L /* carries into the exponent for a
+                                           mantissa of sqrt(2) and above */
+#define HFSQ_FROM 1.38000679016113281250 /* 1 + 0x6147a / 2^20 */
+#define HFSQ_TO 1.42078018188476562500   /* 1 + 0x6b852 / 2^20 */
+#define LG1 6.666666666666735130e-01
+#define LG2 3.999999999940941908e-01
+#define LG3 2.857142874366239149e-01
+#define LG4 2.222219843214978396e-01
+#define LG5 1.818357216161805012e-01
+#define LG6 1.531383769920937332e-01
+#define LG7 1.479819860511658591e-01
+
+/* sin and cos */
+#define INV_PIO2 6.36619772367581382433e-01
+#define PIO2_1 1.57079632673412561417e+00
+#define PIO2_2 6.07710050630396597660e-11
+#define PIO2_2T 2.02226624879595063154e-21
+#define PIO2_3 2.02226624871116645580e-21
+#define PIO2_3T 8.47842766036889956997e-32
+#define S1 -1.66666666666666324348e-01
+#define S2 8.33333333332248946124e-03
+#define S3 -1.98412698298579493134e-04
+#define S4 2.75573137070700676789e-06
+#define S5 -2.50507602534068634195e-08
+#define S6 1.58969099521155010221e-10
+#define C1 4.16666666666666019037e-02
+#define C2 -1.38888888888741095749e-03
+#define C3 2.48015872894767294178e-05
+#define C4 -2.75573143513906633035e-07
+#define C5 2.08757232129817482790e-09
+#define C6 -1.13596475577881948265e-11
+
+typedef void (*apply_func)(function_t function, const double* a,
+        const double* b, double* results, unsigned char* failed, size_t n);
+
+static void ApplyScalar(function_t function, const double* a,
+        const double* b, double* results, unsigned char* failed, size_t n)
+{
+    function_impl_t impl = FunctionImpl(function);
+    size_t i = 0;
+
+    for( ; i < n; ++i)
+    {
+        if(SUCCESS != impl(a[i], NULL != b ? b[i] : 0, &results[i]))
+        {
+            failed[i] = 1;
+        }
+    }
+}
+
+/* The kernels of one instruction set, written once over the V_ operations
+   defined for it: V_VEC vectors of V_WIDTH doubles and V_INT vectors of as
+   many 64-bit integers. Each function returns its results and sets a mask
+   of the lanes it computed; the others go through ApplyScalar. */
+
+#define DEFINE_KERNELS(LEVEL, ATTRIBUTE)                                      \
+                                                                              \
+ATTRIBUTE static V_VEC Exp##LEVEL(V_VEC x, V_VEC* ordinary)                   \
+{                                                                             \
+    V_VEC t = V_ADD(V_MUL(x, V_SET(INV_LN2)), V_SET(ROUNDING));               \
+    V_VEC k = V_SUB(t, V_SET(ROUNDING));                                      \
+    V_VEC hi = V_SUB(x, V_MUL(k, V_SET(LN2_HI)));                             \
+    V_VEC lo = V_MUL(k, V_SET(LN2_LO));                                       \
+    V_VEC r = V_SUB(hi, lo);                                                  \
+    V_VEC z = V_MUL(r, r);                                                    \
+    V_VEC c = V_SUB(r, V_MUL(z, V_ADD(V_SET(P1), V_MUL(z, V_ADD(V_SET(P2),    \
+                V_MUL(z, V_ADD(V_SET(P3), V_MUL(z, V_ADD(V_SET(P4),           \
+                                            V_MUL(z, V_SET(P5))))))))))); \
+    V_VEC y = V_SUB(V_SET(1), V_SUB(V_SUB(lo, V_DIV(V_MUL(r, c),              \
+                                        V_SUB(V_SET(2), c))), hi));           \
+    V_INT scale = V_SHL64(V_ADD64(V_SUB64(V_BITS(t),                          \
+                    V_SET64(ROUNDING_BITS)), V_SET64(1023)), 52);             \
+                                                                              \
+    *ordinary = V_LE(V_ANDNOT(V_SET(-0.0), x), V_SET(MAX_EXP_ARGUMENT));      \
+                                                                              \
+    return V_MUL(y, V_FLOAT(scale));                                          \
+}                                                                             \
+                                                                              \
+ATTRIBUTE static V_VEC Log##LEVEL(V_VEC x, V_VEC* ordinary)                   \
+{                                                                             \
+    V_INT bits = V_BITS(x);                                                   \
+    V_INT mantissa = V_AND64(bits, V_SET64(MANTISSA));                        \
+    V_INT carry = V_AND64(V_ADD64(mantissa, V_SET64(SQRT2_CARRY)),            \
+                                            V_SET64(0x0010000000000000L));    \
+    V_VEC m = V_FLOAT(V_OR64(mantissa, V_XOR64(carry,                         \
+                                            V_SET64(EXPONENT_ONE))));         \
+    V_VEC k = V_SUB(V_FLOAT(V_ADD64(V_ADD64(V_SHR64(bits, 52),                \
+                V_SHR64(carry, 52)), V_SET64(ROUNDING_BITS - 1023))),         \
+                                                        V_SET(ROUNDING));     \
+    V_VEC unscaled = V_FLOAT(V_OR64(mantissa, V_SET64(EXPONENT_ONE)));        \
+    V_VEC f = V_SUB(m, V_SET(1));                                             \
+    V_VEC hfsq = V_MUL(V_MUL(V_SET(0.5), f), f);                              \
+    V_VEC s = V_DIV(f, V_ADD(V_SET(2), f));                                   \
+    V_VEC z = V_MUL(s, s);                                                    \
+    V_VEC w = V_MUL(z, z);                                                    \
+    V_VEC t1 = V_MUL(w, V_ADD(V_SET(LG2), V_MUL(w, V_ADD(V_SET(LG4),          \
+                                                V_MUL(w, V_SET(LG6))))));     \
+    V_VEC t2 = V_MUL(z, V_ADD(V_SET(LG1), V_MUL(w, V_ADD(V_SET(LG3),          \
+            V_MUL(w, V_ADD(V_SET(LG5), V_MUL(w, V_SET(LG7))))))));            \
+    V_VEC r = V_ADD(t2, t1);                                                  \
+    V_VEC near = V_SUB(V_MUL(s, V_SUB(f, r)), V_MUL(k, V_SET(LN2_LO)));       \
+    V_VEC far = V_SUB(hfsq, V_ADD(V_MUL(s, V_ADD(hfsq, r)),                   \
+                                            V_MUL(k, V_SET(LN2_LO))));        \
+    V_VEC use_far = V_AND(V_GE(unscaled, V_SET(HFSQ_FROM)),                   \
+                                        V_LT(unscaled, V_SET(HFSQ_TO)));      \
+                                                                              \
+    *ordinary = V_AND(V_GE(x, V_SET(DBL_MIN)), V_LE(x, V_SET(DBL_MAX)));      \
+                                                                              \
+    return V_SUB(V_MUL(k, V_SET(LN2_HI)),                                     \
+                                V_SUB(V_SELECT(use_far, far, near), f));      \
+}                                                                             \
+                                                                              \
+/* x - n * pi / 2 in three pieces, as y0 + y1 */                              \
+ATTRIBUTE static V_INT Reduce##LEVEL(V_VEC x, V_VEC* y0, V_VEC* y1)           \
+{                                                                             \
+    V_VEC t = V_ADD(V_MUL(x, V_SET(INV_PIO2)), V_SET(ROUNDING));              \
+    V_VEC n = V_SUB(t, V_SET(ROUNDING));                                      \
+    V_VEC r = V_SUB(x, V_MUL(n, V_SET(PIO2_1)));                              \
+    V_VEC w = V_MUL(n, V_SET(PIO2_2));                                        \
+    V_VEC previous = r;                                                       \
+                                                                              \
+    r = V_SUB(previous, w);                                                   \
+    w = V_SUB(V_MUL(n, V_SET(PIO2_2T)), V_SUB(V_SUB(previous, r), w));        \
+    previous = r;                                                             \
+    w = V_MUL(n, V_SET(PIO2_3));                                              \
+    r = V_SUB(previous, w);                                                   \
+    w = V_SUB(V_MUL(n, V_SET(PIO2_3T)), V_SUB(V_SUB(previous, r), w));        \
+    *y0 = V_SUB(r, w);                                                        \
+    *y1 = V_SUB(V_SUB(r, *y0), w);                                            \
+                                                                              \
+    return V_BITS(t);                                                         \
+}                                                                             \
+                                                                              \
+ATTRIBUTE static V_VEC KernelSin##LEVEL(V_VEC x, V_VEC y)                     \
+{                                                                             \
+    V_VEC z = V_MUL(x, x);                                                    \
+    V_VEC w = V_MUL(z, z);                                                    \
+    V_VEC r = V_ADD(V_ADD(V_SET(S2), V_MUL(z, V_ADD(V_SET(S3),                \
+                                                V_MUL(z, V_SET(S4))))),       \
+        V_MUL(V_MUL(z, w), V_ADD(V_SET(S5), V_MUL(z, V_SET(S6)))));           \
+    V_VEC v = V_MUL(z, x);                                                    \
+                                                                              \
+    return V_SUB(x, V_SUB(V_SUB(V_MUL(z, V_SUB(V_MUL(V_SET(0.5), y),          \
+                        V_MUL(v, r))), y), V_MUL(v, V_SET(S1))));             \
+}                                                                             \
+                                                                              \
+ATTRIBUTE static V_VEC KernelCos##LEVEL(V_VEC x, V_VEC y)                     \
+{                                                                             \
+    V_VEC z = V_MUL(x, x);                                                    \
+    V_VEC w = V_MUL(z, z);                                                    \
+    V_VEC r = V_ADD(V_MUL(z, V_ADD(V_SET(C1), V_MUL(z, V_ADD(V_SET(C2),       \
+                                                V_MUL(z, V_SET(C3)))))),      \
+        V_MUL(V_MUL(w, w), V_ADD(V_SET(C4), V_MUL(z, V_ADD(V_SET(C5),         \
+                                                V_MUL(z, V_SET(C6)))))));     \
+    V_VEC hz = V_MUL(V_SET(0.5), z);                                          \
+                                                                              \
+    w = V_SUB(V_SET(1), hz);                                                  \
+                                                                              \
+    return V_ADD(w, V_ADD(V_SUB(V_SUB(V_SET(1), w), hz),                      \
+                                    V_SUB(V_MUL(z, r), V_MUL(x, y))));        \
+}                                                                             \
+                                                                              \
+/* quadrant n picks sin or cos of the remainder, bit 1 of n (of n + 1 for    \
+   cos) its sign */                                                           \
+ATTRIBUTE static V_VEC SinCos##LEVEL(V_VEC x, int cosine, V_VEC* ordinary)    \
+{                                                                             \
+    V_VEC y0;                                                                 \
+    V_VEC y1;                                                                 \
+    V_INT n = V_ADD64(Reduce##LEVEL(x, &y0, &y1), V_SET64(cosine));           \
+    V_VEC sin_y = KernelSin##LEVEL(y0, y1);                                   \
+    V_VEC cos_y = KernelCos##LEVEL(y0, y1);                                   \
+    V_VEC even = V_FLOAT(V_SHUFFLE32(V_EQ32(V_AND64(n, V_SET64(1)),           \
+                                    V_SET64(0)), V_PERMUTATION(2, 2, 0, 0))); \
+    V_VEC sign = V_FLOAT(V_SHL64(V_AND64(n, V_SET64(2)), 62));                \
+                                                                              \
+    *ordinary = V_LE(V_ANDNOT(V_SET(-0.0), x), V_SET(MAX_TRIG_ARGUMENT));     \
+                                                                              \
+    return V_XOR(V_SELECT(even, sin_y, cos_y), sign);                         \
+}                                                                             \
+                                                                              \
+ATTRIBUTE static V_VEC Compute##LEVEL(function_t function, V_VEC x, V_VEC y,  \
+                                                        V_VEC* ordinary)      \
+{                                                                             \
+    *ordinary = V_OR(V_EQ(x, x), V_NOT_EQ(x, x));   /* every lane */         \
+                                                                              \
+    switch(function)                                                          \
+    {                                                                         \
+        case FUNC_SQRT:                                                       \
+            *ordinary = V_GE(x, V_SET(0));                                    \
+            return V_SQRT(x);                                                 \
+                                                                              \
+        case FUNC_EXP:                                                        \
+            return Exp##LEVEL(x, ordinary);                                   \
+                                                                              \
+        case FUNC_LOG:                                                        \
+            return Log##LEVEL(x, ordinary);                                   \
+                                                                              \
+        case FUNC_SIN:                                                        \
+            return SinCos##LEVEL(x, 0, ordinary);                             \
+                                                                              \
+        case FUNC_COS:                                                        \
+            return SinCos##LEVEL(x, 1, ordinary);                             \
+                                                                              \
+        case FUNC_MIN:                                                        \
+            return V_MIN(x, y);                                               \
+                                                                              \
+        default:                                                              \
+            return V_MAX(x, y);                                               \
+    }                                                                         \
+}                                                                             \
+                                                                              \
+/* a last, partial vector is padded with ones, which every kernel takes */    \
+ATTRIBUTE static void Apply##LEVEL(function_t function, const double* a,      \
+        const double* b, double* results, unsigned char* failed, size_t n)    \
+{                                                                             \
+    double lanes[V_WIDTH];                                                    \
+    double others[V_WIDTH];                                                   \
+    double values[V_WIDTH];                                                   \
+    V_VEC x;                                                                  \
+    V_VEC y;                                                                  \
+    V_VEC ordinary;                                                           \
+    size_t width = V_WIDTH;                                                   \
+    size_t i = 0;                                                             \
+    size_t lane = 0;                                                          \
+    unsigned int special = 0;                                                 \
+                                                                              \
+    for( ; i < n; i += width)                                                 \
+    {                                                                         \
+        width = n - i < V_WIDTH ? n - i : V_WIDTH;                            \
+        for(lane = 0; V_WIDTH != width && lane < V_WIDTH; ++lane)             \
+        {                                                                     \
+            lanes[lane] = lane < width ? a[i + lane] : 1;                     \
+            others[lane] = lane < width && NULL != b ? b[i + lane] : 1;       \
+        }                                                                     \
+        x = V_WIDTH == width ? V_LOAD(a + i) : V_LOAD(lanes);                 \
+        y = NULL == b ? x : V_WIDTH == width ? V_LOAD(b + i) :                \
+                                                        V_LOAD(others);       \
+                                                                              \
+        V_STORE(values, Compute##LEVEL(function, x, y, &ordinary));           \
+        special = ~(unsigned int)V_MASK(ordinary) & ((1U << V_WIDTH) - 1);   \
+        if(0 != special)                                                      \
+        {                                                                     \
+            V_STORE(lanes, x);                                                \
+            V_STORE(others, y);                                               \
+            for(lane = 0; lane < width; ++lane)                               \
+            {                                                                 \
+                if(0 != (special & (1U << lane)))                             \
+                {                                                             \
+                    ApplyScalar(function, lanes + lane, others + lane,        \
+                                    values + lane, failed + i + lane, 1);     \
+                }                                                             \
+            }                                                                 \
+        }                                                                     \
+                                                                              \
+        for(lane = 0; lane < width; ++lane)                                   \
+        {                                                                     \
+            results[i + lane] = values[lane];                                 \
+        }                                                                     \
+    }                                                                         \
+}
+
+#define V_SELECT(mask, a, b) V_OR(V_AND(mask, a), V_ANDNOT(mask, b))
+#define V_PERMUTATION(a, b, c, d) _MM_SHUFFLE(a, b, c, d)
+
+#ifdef __SSE2__
+
+#define V_VEC __m128d
+#define V_INT __m128i
+#define V_WIDTH 2
+#define V_LOAD(p) _mm_loadu_pd(p)
+#define V_STORE(p, v) _mm_storeu_pd(p, v)
+#define V_SET(x) _mm_set1_pd(x)
+#define V_ADD(a, b) _mm_add_pd(a, b)
+#define V_SUB(a, b) _mm_sub_pd(a, b)
+#define V_MUL(a, b) _mm_mul_pd(a, b)
+#define V_DIV(a, b) _mm_div_pd(a, b)
+#define V_SQRT(a) _mm_sqrt_pd(a)
+#define V_MIN(a, b) _mm_min_pd(a, b)
+#define V_MAX(a, b) _mm_max_pd(a, b)
+#define V_AND(a, b) _mm_and_pd(a, b)
+#define V_OR(a, b) _mm_or_pd(a, b)
+#define V_XOR(a, b) _mm_xor_pd(a, b)
+#define V_ANDNOT(a, b) _mm_andnot_pd(a, b)
+#define V_EQ(a, b) _mm_cmpeq_pd(a, b)
+#define V_NOT_EQ(a, b) _mm_cmpneq_pd(a, b)
+#define V_LT(a, b) _mm_cmplt_pd(a, b)
+#define V_LE(a, b) _mm_cmple_pd(a, b)
+#define V_GE(a, b) _mm_cmpge_pd(a, b)
+#define V_MASK(a) _mm_movemask_pd(a)
+#define V_BITS(a) _mm_castpd_si128(a)
+#define V_FLOAT(a) _mm_castsi128_pd(a)
+#define V_SET64(x) _mm_set1_epi64x(x)
+#define V_ADD64(a, b) _mm_add_epi64(a, b)
+#define V_SUB64(a, b) _mm_sub_epi64(a, b)
+#define V_AND64(a, b) _mm_and_si128(a, b)
+#define V_OR64(a, b) _mm_or_si128(a, b)
+#define V_XOR64(a, b) _mm_xor_si128(a, b)
+#define V_SHL64(a, n) _mm_slli_epi64(a, n)
+#define V_SHR64(a, n) _mm_srli_epi64(a, n)
+#define V_EQ32(a, b) _mm_cmpeq_epi32(a, b)
+#define V_SHUFFLE32(a, p) _mm_shuffle_epi32(a, p)
+
+DEFINE_KERNELS(Sse2, __attribute__((target("sse2"))))
+
+#undef V_VEC
+#undef V_INT
+#undef V_WIDTH
+#undef V_LOAD
+#undef V_STORE
+#undef V_SET
+#undef V_ADD
+#undef V_SUB
+#undef V_MUL
+#undef V_DIV
+#undef V_SQRT
+#undef V_MIN
+#undef V_MAX
+#undef V_AND
+#undef V_OR
+#undef V_XOR
+#undef V_ANDNOT
+#undef V_EQ
+#undef V_NOT_EQ
+#undef V_LT
+#undef V_LE
+#undef V_GE
+#undef V_MASK
+#undef V_BITS
+#undef V_FLOAT
+#undef V_SET64
+#undef V_ADD64
+#undef V_SUB64
+#undef V_AND64
+#undef V_OR64
+#undef V_XOR64
+#undef V_SHL64
+#undef V_SHR64
+#undef V_EQ32
+#undef V_SHUFFLE32
+
+#endif      /* __SSE2__ */
+
+#ifdef HAS_AVX2
+
+#define V_VEC __m256d
+#define V_INT __m256i
+#define V_WIDTH 4
+#define V_LOAD(p) _mm256_loadu_pd(p)
+#define V_STORE(p, v) _mm256_storeu_pd(p, v)
+#define V_SET(x) _mm256_set1_pd(x)
+#define V_ADD(a, b) _mm256_add_pd(a, b)
+#define V_SUB(a, b) _mm256_sub_pd(a, b)
+#define V_MUL(a, b) _mm256_mul_pd(a, b)
+#define V_DIV(a, b) _mm256_div_pd(a, b)
+#define V_SQRT(a) _mm256_sqrt_pd(a)
+#define V_MIN(a, b) _mm256_min_pd(a, b)
+#define V_MAX(a, b) _mm256_max_pd(a, b)
+#define V_AND(a, b) _mm256_and_pd(a, b)
+#define V_OR(a, b) _mm256_or_pd(a, b)
+#define V_XOR(a, b) _mm256_xor_pd(a, b)
+#define V_ANDNOT(a, b) _mm256_andnot_pd(a, b)
+#define V_EQ(a, b) _mm256_cmp_pd(a, b, _CMP_EQ_OQ)
+#define V_NOT_EQ(a, b) _mm256_cmp_pd(a, b, _CMP_NEQ_UQ)
+#define V_LT(a, b) _mm256_cmp_pd(a, b, _CMP_LT_OQ)
+#define V_LE(a, b) _mm256_cmp_pd(a, b, _CMP_LE_OQ)
+#define V_GE(a, b) _mm256_cmp_pd(a, b, _CMP_GE_OQ)
+#define V_MASK(a) _mm256_movemask_pd(a)
+#define V_BITS(a) _mm256_castpd_si256(a)
+#define V_FLOAT(a) _mm256_castsi256_pd(a)
+#define V_SET64(x) _mm256_set1_epi64x(x)
+#define V_ADD64(a, b) _mm256_add_epi64(a, b)
+#define V_SUB64(a, b) _mm256_sub_epi64(a, b)
+#define V_AND64(a, b) _mm256_and_si256(a, b)
+#define V_OR64(a, b) _mm256_or_si256(a, b)
+#define V_XOR64(a, b) _mm256_xor_si256(a, b)
+#define V_SHL64(a, n) _mm256_slli_epi64(a, n)
+#define V_SHR64(a, n) _mm256_srli_epi64(a, n)
+#define V_EQ32(a, b) _mm256_cmpeq_epi32(a, b)
+#define V_SHUFFLE32(a, p) _mm256_shuffle_epi32(a, p)
+
+DEFINE_KERNELS(Avx2, __attribute__((target("avx2"))))
+
+#endif      /* HAS_AVX2 */
+
+static const apply_func apply_funcs_LUT[NUM_OF_KERNEL_LEVELS] =
+{
+    ApplyScalar,
+#ifdef __SSE2__
+    ApplySse2,
+#else
+    ApplyScalar,
+#endif
+#ifdef HAS_AVX2
+    ApplyAvx2
+#else
+    ApplyScalar
+#endif
+};
+
+/* -1 until the first call picks the widest level the CPU has */
+static int level_in_use = -1;
+
+static kernel_level_t MaxLevel(void)
+{
+#ifdef HAS_AVX2
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return KERNEL_AVX2;
+    }
+#endif
+
+#ifdef __SSE2__
+    return KERNEL_SSE2;
+#else
+    return KERNEL_SCALAR;
+#endif
+}
+
+static kernel_level_t Level(void)
+{
+    int level = __atomic_load_n(&level_in_use, __ATOMIC_RELAXED);
+
+    if(level < 0)
+    {
+        level = MaxLevel();
+        __atomic_store_n(&level_in_use, level, __ATOMIC_RELAXED);
+    }
+
+    return (kernel_level_t)level;
+}
+
+kernel_level_t KernelSetLevel(kernel_level_t level)
+{
+    kernel_level_t max = MaxLevel();
+
+    level = level < max ? level : max;
+    __atomic_store_n(&level_in_use, (int)level, __ATOMIC_RELAXED);
+
+    return level;
+}
+
+void KernelApply(function_t function, const double* a, const double* b,
+                        double* results, unsigned char* failed, size_t n)
+{
+    assert(function < NUM_OF_FUNCTIONS);
+    assert(a || 0 == n);
+    assert(results || 0 == n);
+    assert(failed || 0 == n);
+
+    apply_funcs_LUT[Level()](function, a, b, results, failed, n);
+}
@@ -0,0 +1,38 @@
+#ifndef __KERNELS_H__
+#define __KERNELS_H__
+
+#include <stddef.h> /* size_t */
+
+#include "functions.h"
+
+typedef enum
+{
+    KERNEL_SCALAR,
+    KERNEL_SSE2,
+    KERNEL_AVX2,
+    NUM_OF_KERNEL_LEVELS
+} kernel_level_t;
+
+/* @Desc: Apply a function to n values at once, with the widest instruction
+          set the CPU has: results[i] = f(a[i], b[i]). The scalar level is
+          the function's own implementation; the SSE2 and AVX2 levels give
+          the same bits as each other, with the error bounds documented for
+          CalcEvalColumns. Lanes out of the range of a vector kernel (NaN,
+          infinities, arguments that would overflow, and for sin and cos
+          |x| > 1e6) go through the scalar implementation
+   @params: function, its operands (b only for min and max), array to store
+            the results in, which may be a, flags to set to 1 where the
+            scalar implementation returns MATH_ERROR (the others are left
+            as they are), number of values*/
+
+void KernelApply(function_t function, const double* a, const double* b,
+                        double* results, unsigned char* failed, size_t n);
+
+/* @Desc: Choose the instruction set used by every kernel from now on, for
+          benchmarking. By default the widest one the CPU has is used
+   @params: highest level to use
+   @return value: the level actually used, capped at what the CPU has*/
+
+kernel_level_t KernelSetLevel(kernel_level_t level);
+
+#endif      /* kernels.h */
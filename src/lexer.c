@@ -0,0 +1,417 @@
+#include <assert.h>  /* assert */
+#include <limits.h>  /* ULONG_MAX */
+
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif
+
+#if defined(__SSE2__) && defined(__GNUC__) &&                                 \
+                                    (defined(__x86_64__) || defined(__i386__))
+#define HAS_AVX2
+#include <immintrin.h>
+#endif
+
+#include "lexer.h"
+#include "number.h"
+
+#if ULONG_MAX <= 0xFFFFFFFFUL
+#error "the lexer needs a 64-bit unsigned long"
+#endif
+
+#define BLOCK_SIZE 64   /* one bit per character in an unsigned long */
+#define MAX_EXACT_DIGITS 15     /* any integer this long is an exact double */
+
+typedef enum
+{
+    SPACE_CLASS,
+    DIGIT_CLASS,    /* digits and '.', which start a number */
+    LETTER_CLASS,   /* letters and '_', which start a name */
+    SYMBOL_CLASS,
+    NUM_OF_CLASSES
+} char_class_t;
+
+/* bit i describes block[i] */
+typedef struct block_masks
+{
+    unsigned long space;
+    unsigned long word;     /* digits, letters and '_', the name characters */
+    unsigned long digit;    /* '0' .. '9' only */
+} block_masks_t;
+
+/* Sets the bits of block[from] .. block[width - 1] */
+typedef void (*classify_func)(const char* block, size_t from, size_t width,
+                                                        block_masks_t* masks);
+
+#define SP SPACE_CLASS
+#define DG DIGIT_CLASS
+#define LT LETTER_CLASS
+#define SY SYMBOL_CLASS
+
+/* whitespace is the C locale's, whatever the current locale */
+static const unsigned char char_class_LUT[256] =
+{
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SP, SP, SP, SP, SP, SY, SY, /* 0x00 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0x10 */
+    SP, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, DG, SY, /* 0x20 */
+    DG, DG, DG, DG, DG, DG, DG, DG, DG, DG, SY, SY, SY, SY, SY, SY, /* 0x30 */
+    SY, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, /* 0x40 */
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, SY, SY, SY, SY, LT, /* 0x50 */
+    SY, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, /* 0x60 */
+    LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, LT, SY, SY, SY, SY, SY, /* 0x70 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0x80 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0x90 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0xA0 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0xB0 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0xC0 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0xD0 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, /* 0xE0 */
+    SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY, SY  /* 0xF0 */
+};
+
+#undef SP
+#undef DG
+#undef LT
+#undef SY
+
+/* powers of ten small enough to be exact doubles */
+static const double exact_power_LUT[MAX_EXACT_DIGITS + 1] =
+{
+    1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11, 1e12,
+    1e13, 1e14, 1e15
+};
+
+static void ClassifyScalar(const char* block, size_t from, size_t width,
+                                                        block_masks_t* masks)
+{
+    unsigned long space = 0;
+    unsigned long word = 0;
+    unsigned long digit = 0;
+    unsigned long bit = 0;
+    unsigned char char_class = SYMBOL_CLASS;
+
+    /* local masks: stores through masks could alias block */
+    for( ; from < width; ++from)
+    {
+        char_class = char_class_LUT[(unsigned char)block[from]];
+        bit = 1UL << from;
+        space |= SPACE_CLASS == char_class ? bit : 0;
+        digit |= DIGIT_CLASS == char_class && '.' != block[from] ? bit : 0;
+        word |= LETTER_CLASS == char_class ? bit : digit & bit;
+    }
+
+    masks->space |= space;
+    masks->word |= word;
+    masks->digit |= digit;
+}
+
+#ifdef __SSE2__
+static void ClassifySse2(const char* block, size_t from, size_t width,
+                                                        block_masks_t* masks)
+{
+    __m128i chunk;
+    __m128i folded;
+    __m128i is_space;
+    __m128i is_digit;
+    __m128i is_word;
+    unsigned long space = 0;
+    unsigned long word = 0;
+    unsigned long digit = 0;
+
+    for( ; from + 16 <= width; from += 16)
+    {
+        chunk = _mm_loadu_si128((const __m128i*)(block + from));
+        is_space = _mm_or_si128(_mm_cmpeq_epi8(chunk, _mm_set1_epi8(' ')),
+                        _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8(8)),
+                                _mm_cmplt_epi8(chunk, _mm_set1_epi8(14))));
+
+        /* setting bit 5 maps upper case letters onto lower case ones */
+        folded = _mm_or_si128(chunk, _mm_set1_epi8(0x20));
+        is_digit = _mm_and_si128(_mm_cmpgt_epi8(chunk, _mm_set1_epi8('0' - 1)),
+                                _mm_cmplt_epi8(chunk, _mm_set1_epi8('9' + 1)));
+        is_word = _mm_or_si128(is_digit,
+                _mm_and_si128(_mm_cmpgt_epi8(folded, _mm_set1_epi8('a' - 1)),
+                            _mm_cmplt_epi8(folded, _mm_set1_epi8('z' + 1))));
+        is_word = _mm_or_si128(is_word,
+                                _mm_cmpeq_epi8(chunk, _mm_set1_epi8('_')));
+
+        space |= (unsigned long)_mm_movemask_epi8(is_space) << from;
+        word |= (unsigned long)_mm_movemask_epi8(is_word) << from;
+        digit |= (unsigned long)_mm_movemask_epi8(is_digit) << from;
+    }
+
+    masks->space |= space;
+    masks->word |= word;
+    masks->digit |= digit;
+    ClassifyScalar(block, from, width, masks);
+}
+#endif
+
+#ifdef HAS_AVX2
+__attribute__((target("avx2")))
+static void ClassifyAvx2(const char* block, size_t from, size_t width,
+                                                        block_masks_t* masks)
+{
+    __m256i chunk;
+    __m256i folded;
+    __m256i is_space;
+    __m256i is_digit;
+    __m256i is_word;
+    unsigned long space = 0;
+    unsigned long word = 0;
+    unsigned long digit = 0;
+
+    for( ; from + 32 <= width; from += 32)
+    {
+        chunk = _mm256_loadu_si256((const __m256i*)(block + from));
+        is_space = _mm256_or_si256(
+                _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8(' ')),
+                _mm256_and_si256(_mm256_cmpgt_epi8(chunk, _mm256_set1_epi8(8)),
+                            _mm256_cmpgt_epi8(_mm256_set1_epi8(14), chunk)));
+
+        folded = _mm256_or_si256(chunk, _mm256_set1_epi8(0x20));
+        is_digit = _mm256_and_si256(
+                        _mm256_cmpgt_epi8(chunk, _mm256_set1_epi8('0' - 1)),
+                        _mm256_cmpgt_epi8(_mm256_set1_epi8('9' + 1), chunk));
+        is_word = _mm256_or_si256(is_digit, _mm256_and_si256(
+                        _mm256_cmpgt_epi8(folded, _mm256_set1_epi8('a' - 1)),
+                        _mm256_cmpgt_epi8(_mm256_set1_epi8('z' + 1), folded)));
+        is_word = _mm256_or_si256(is_word,
+                            _mm256_cmpeq_epi8(chunk, _mm256_set1_epi8('_')));
+
+        space |= (unsigned long)(unsigned int)_mm256_movemask_epi8(is_space)
+                                                                        << from;
+        word |= (unsigned long)(unsigned int)_mm256_movemask_epi8(is_word)
+                                                                        << from;
+        digit |= (unsigned long)(unsigned int)_mm256_movemask_epi8(is_digit)
+                                                                        << from;
+    }
+
+    masks->space |= space;
+    masks->word |= word;
+    masks->digit |= digit;
+    ClassifySse2(block, from, width, masks);
+}
+#endif
+
+static const classify_func classify_funcs_LUT[NUM_OF_LEXER_LEVELS] =
+{
+    ClassifyScalar,
+#ifdef __SSE2__
+    ClassifySse2,
+#else
+    ClassifyScalar,
+#endif
+#ifdef HAS_AVX2
+    ClassifyAvx2
+#else
+    ClassifyScalar
+#endif
+};
+
+/* -1 until the first lexer picks the widest level the CPU has */
+static int level_in_use = -1;
+
+static lexer_level_t MaxLevel(void)
+{
+#ifdef HAS_AVX2
+    if(__builtin_cpu_supports("avx2"))
+    {
+        return LEXER_AVX2;
+    }
+#endif
+
+#ifdef __SSE2__
+    return LEXER_SSE2;
+#else
+    return LEXER_SCALAR;
+#endif
+}
+
+static lexer_level_t Level(void)
+{
+    int level = __atomic_load_n(&level_in_use, __ATOMIC_RELAXED);
+
+    if(level < 0)
+    {
+        level = MaxLevel();
+        __atomic_store_n(&level_in_use, level, __ATOMIC_RELAXED);
+    }
+
+    return (lexer_level_t)level;
+}
+
+lexer_level_t LexerSetLevel(lexer_level_t level)
+{
+    lexer_level_t max = MaxLevel();
+
+    level = level < max ? level : max;
+    __atomic_store_n(&level_in_use, (int)level, __ATOMIC_RELAXED);
+
+    return level;
+}
+
+/* the lowest count bits, count up to 64 */
+static unsigned long LowBits(size_t count)
+{
+    return count < BLOCK_SIZE ? (1UL << count) - 1 : ULONG_MAX;
+}
+
+static const char* WordEnd(const char* str, const char* end)
+{
+    while(str < end && '.' != *str &&
+                    (DIGIT_CLASS == char_class_LUT[(unsigned char)*str] ||
+                        LETTER_CLASS == char_class_LUT[(unsigned char)*str]))
+    {
+        ++str;
+    }
+
+    return str;
+}
+
+/* end of the run of mask bits starting at from, width if it reaches it */
+static size_t RunEnd(unsigned long mask, size_t from, size_t width)
+{
+    unsigned long rest = ~mask & ~LowBits(from) & LowBits(width);
+
+    return 0 != rest ? (size_t)__builtin_ctzl(rest) : width;
+}
+
+/* Up to MAX_EXACT_DIGITS digits with an optional fraction, ending inside the
+   block at neither an exponent nor a name, are an exact integer over an
+   exact power of ten, so a single division rounds them correctly. Anything
+   else is left to ParseNumber */
+static const char* LexNumber(const char* block, size_t at, size_t width,
+                    const block_masks_t* masks, const char* end, double* value)
+{
+    size_t digits_end = RunEnd(masks->digit, at, width);
+    size_t number_end = digits_end;
+    size_t digits = digits_end - at;
+    unsigned long integer = 0;
+    size_t i = at;
+
+    if(digits_end < width && '.' == block[digits_end])
+    {
+        number_end = RunEnd(masks->digit, digits_end + 1, width);
+        digits += number_end - digits_end - 1;
+    }
+
+    if(number_end == width || 0 == digits || digits > MAX_EXACT_DIGITS ||
+                                        0 != ((masks->word >> number_end) & 1))
+    {
+        return ParseNumber(block + at, end, value);
+    }
+
+    for( ; i < number_end; ++i)
+    {
+        if(i != digits_end)
+        {
+            integer = integer * 10 + (block[i] - '0');
+        }
+    }
+
+    *value = (double)integer;
+    if(number_end != digits_end)
+    {
+        *value /= exact_power_LUT[number_end - digits_end - 1];
+    }
+
+    return block + number_end;
+}
+
+/* Names end at the first non-word character of the block, or are followed
+   past it one character at a time */
+static const char* LexToken(const char* block, size_t at, size_t width,
+                        const block_masks_t* masks, const lexer_t* lexer,
+                                                            token_t* token)
+{
+    const char* str = block + at;
+    unsigned long rest = 0;
+
+    token->start = str;
+
+    switch(char_class_LUT[(unsigned char)*str])
+    {
+        case DIGIT_CLASS:
+            token->kind = TOKEN_NUMBER;
+            token->end = lexer->convert ? LexNumber(block, at, width, masks,
+                                            lexer->end, &token->value) :
+                                                ScanNumber(str, lexer->end);
+            if(token->end == str)
+            {
+                token->kind = TOKEN_INVALID;
+                token->end = str + 1;
+            }
+            break;
+
+        case LETTER_CLASS:
+            token->kind = TOKEN_NAME;
+            rest = ~masks->word & ~LowBits(at) & LowBits(width);
+            token->end = 0 != rest ? block + __builtin_ctzl(rest) :
+                                            WordEnd(block + width, lexer->end);
+            break;
+
+        default:
+            token->kind = TOKEN_SYMBOL;
+            token->end = str + 1;
+            break;
+    }
+
+    return token->end;
+}
+
+void LexerInit(lexer_t* lexer, const char* str, size_t len)
+{
+    assert(lexer);
+    assert(str || 0 == len);
+
+    lexer->str = str;
+    lexer->end = str + len;
+    lexer->convert = 1;
+}
+
+void LexerInitScan(lexer_t* lexer, const char* str, size_t len)
+{
+    LexerInit(lexer, str, len);
+    lexer->convert = 0;
+}
+
+size_t LexerNext(lexer_t* lexer, token_t* tokens, size_t max)
+{
+    classify_func classify = classify_funcs_LUT[Level()];
+    const char* block = NULL;
+    block_masks_t masks;
+    size_t width = 0;
+    size_t next = 0;
+    size_t count = 0;
+    unsigned long starts = 0;
+
+    assert(lexer);
+    assert(tokens);
+
+    while(count < max && lexer->str < lexer->end)
+    {
+        block = lexer->str;
+        width = lexer->end - block < BLOCK_SIZE ? lexer->end - block :
+                                                                    BLOCK_SIZE;
+        masks.space = 0;
+        masks.word = 0;
+        masks.digit = 0;
+        classify(block, 0, width, &masks);
+
+        /* every non-space character starts a token, unless the token
+           before it covers it */
+        starts = ~masks.space & LowBits(width);
+        next = 0;
+        while(0 != starts && count < max)
+        {
+            next = LexToken(block, __builtin_ctzl(starts), width, &masks,
+                                            lexer, &tokens[count++]) - block;
+            starts &= ~LowBits(next);
+        }
+
+        lexer->str = 0 == starts && next < width ? block + width :
+                                                                block + next;
+    }
+
+    return count;
+}
@@ -0,0 +1,63 @@
+#ifndef __LEXER_H__
+#define __LEXER_H__
+
+#include <stddef.h> /* size_t */
+
+typedef enum
+{
+    TOKEN_NUMBER,
+    TOKEN_NAME,
+    TOKEN_SYMBOL,   /* any other single character: operators, brackets */
+    TOKEN_INVALID,  /* a '.' that does not start a number */
+    NUM_OF_TOKEN_KINDS
+} token_kind_t;
+
+typedef enum
+{
+    LEXER_SCALAR,
+    LEXER_SSE2,
+    LEXER_AVX2,
+    NUM_OF_LEXER_LEVELS
+} lexer_level_t;
+
+typedef struct token
+{
+    const char* start;
+    const char* end;
+    double value;   /* TOKEN_NUMBER only */
+    token_kind_t kind;
+} token_t;
+
+typedef struct lexer
+{
+    const char* str;
+    const char* end;
+    int convert;    /* 0 leaves the values of numbers unset */
+} lexer_t;
+
+/* @Desc: Start lexing str. Nothing at or past str + len is ever read
+   @params: Pointer to the lexer, input, its length*/
+
+void LexerInit(lexer_t* lexer, const char* str, size_t len);
+
+/* @Desc: Same as LexerInit, but numbers are only delimited: their tokens
+          are the same, with no value, for callers that only check syntax
+   @params: Pointer to the lexer, input, its length*/
+
+void LexerInitScan(lexer_t* lexer, const char* str, size_t len);
+
+/* @Desc: Lex the next tokens, skipping whitespace. The input is classified
+          in 64-byte blocks with the widest instruction set the CPU has
+   @params: Pointer to the lexer, array to store the tokens in, its size
+   @return value: number of tokens stored, 0 at the end of the input*/
+
+size_t LexerNext(lexer_t* lexer, token_t* tokens, size_t max);
+
+/* @Desc: Choose the instruction set used by every lexer from now on, for
+          benchmarking. By default the widest one the CPU has is used
+   @params: highest level to use
+   @return value: the level actually used, capped at what the CPU has*/
+
+lexer_level_t LexerSetLevel(lexer_level_t level);
+
+#endif      /* lexer.h */
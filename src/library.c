@@ -0,0 +1,714 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>     /* fopen, fwrite, fclose, rename, remove */
+#include <stdlib.h>    /* malloc, realloc, calloc, free, qsort */
+#include <string.h>    /* strlen, strcmp, strcpy, memcpy, memcmp, memset */
+#include <assert.h>    /* assert */
+#include <limits.h>    /* UINT_MAX */
+#include <fcntl.h>     /* open */
+#include <unistd.h>    /* close */
+#include <sys/mman.h>  /* mmap, munmap */
+#include <sys/stat.h>  /* fstat */
+
+#include "calc_library.h"
+#include "program.h"
+
+#if UINT_MAX != 0xFFFFFFFFUL
+#error "library files need a 32-bit unsigned int"
+#endif
+
+#define LIBRARY_VERSION 1
+#define INITIAL_CAPACITY 64
+#define MAX_FILE_SIZE 0xFFFFFFF8UL
+#define FLETCHER_MODULUS 0xFFFFFFFFUL
+
+/* Every field is a native unsigned int, so a file written on a host of the
+   other byte order fails the version check. The sections follow the header
+   in this order, each 8-byte aligned, so their offsets are checked against
+   the counts rather than trusted */
+typedef struct library_header
+{
+    char magic[8];
+    unsigned int version;
+    unsigned int file_size;
+    unsigned int checksum[2];   /* Fletcher-64 of everything past the header */
+    unsigned int num_formulas;
+    unsigned int num_constants;
+    unsigned int code_size;
+    unsigned int num_vars;
+    unsigned int strings_size;
+    unsigned int constants_offset;
+    unsigned int code_offset;
+    unsigned int vars_offset;
+    unsigned int strings_offset;
+    unsigned int reserved;
+} library_header_t;
+
+/* indices into the sections; operands are relative to the formula's own
+   constants and variables */
+typedef struct library_formula
+{
+    unsigned int name;          /* offset in the strings */
+    unsigned int code;
+    unsigned int code_size;
+    unsigned int constants;
+    unsigned int num_constants;
+    unsigned int vars;          /* string offsets of the variable names */
+    unsigned int num_vars;
+    unsigned int max_depth;
+    unsigned int num_temps;
+    unsigned int reserved;
+} library_formula_t;
+
+typedef struct library_entry
+{
+    char* name;
+    calc_program_t* program;
+    size_t order;               /* of addition, the last one is kept */
+} library_entry_t;
+
+struct calc_library_builder
+{
+    library_entry_t* entries;
+    size_t num_entries;
+    size_t capacity;
+};
+
+struct calc_library
+{
+    void* map;
+    size_t size;
+    const library_header_t* header;
+    const library_formula_t* formulas;
+    const double* constants;
+    const instruction_t* code;
+    const unsigned int* vars;
+    const char* strings;
+};
+
+static const char library_magic[8] = "CALCLIB";
+
+static unsigned long Align(unsigned long offset)
+{
+    return (offset + 7) & ~7UL;
+}
+
+/* Fills the section offsets and the file size from the counts
+   @return value: 0 if the file would not fit the 32-bit offsets */
+static int Layout(library_header_t* header)
+{
+    unsigned long offset = Align(sizeof(library_header_t) +
+            (unsigned long)header->num_formulas * sizeof(library_formula_t));
+
+    header->constants_offset = offset;
+    offset += (unsigned long)header->num_constants * sizeof(double);
+    header->code_offset = offset;
+    offset += (unsigned long)header->code_size * sizeof(instruction_t);
+    header->vars_offset = offset;
+    offset = Align(offset + (unsigned long)header->num_vars *
+                                                        sizeof(unsigned int));
+    header->strings_offset = offset;
+    offset = Align(offset + header->strings_size);
+    header->file_size = offset;
+
+    return offset <= MAX_FILE_SIZE;
+}
+
+static void Checksum(const unsigned char* data, size_t size,
+                                                    unsigned int checksum[2])
+{
+    const unsigned int* words = (const unsigned int*)data;
+    unsigned long low = 0;
+    unsigned long high = 0;
+    size_t i = 0;
+
+    for( ; i < size / sizeof(unsigned int); ++i)
+    {
+        low = (low + words[i]) % FLETCHER_MODULUS;
+        high = (high + low) % FLETCHER_MODULUS;
+    }
+
+    checksum[0] = low;
+    checksum[1] = high;
+}
+
+calc_library_builder_t* CalcLibraryBuilderCreate(void)
+{
+    calc_library_builder_t* builder = (calc_library_builder_t*)malloc(
+                                            sizeof(calc_library_builder_t));
+
+    if(NULL == builder)
+    {
+        return NULL;
+    }
+
+    builder->entries = NULL;
+    builder->num_entries = 0;
+    builder->capacity = 0;
+
+    return builder;
+}
+
+void CalcLibraryBuilderDestroy(calc_library_builder_t* builder)
+{
+    size_t i = 0;
+
+    if(NULL == builder)
+    {
+        return;
+    }
+
+    for( ; i < builder->num_entries; ++i)
+    {
+        free(builder->entries[i].name);
+        CalcProgramDestroy(builder->entries[i].program);
+    }
+
+    free(builder->entries);
+    free(builder);
+}
+
+status_t CalcLibraryBuilderAdd(calc_library_builder_t* builder,
+                                        const char* name, const char* expr)
+{
+    library_entry_t* entries = NULL;
+    library_entry_t* entry = NULL;
+    calc_program_t* program = NULL;
+    size_t capacity = 0;
+    size_t len = 0;
+    status_t status = SUCCESS;
+
+    assert(builder);
+    assert(name);
+    assert(expr);
+
+    status = CalcCompile(expr, &program);
+    if(SUCCESS == status)
+    {
+        status = CalcOptimize(program, NULL);
+    }
+    if(SUCCESS != status)
+    {
+        CalcProgramDestroy(program);
+        return status;
+    }
+
+    if(builder->num_entries == builder->capacity)
+    {
+        capacity = 0 == builder->capacity ? INITIAL_CAPACITY :
+                                                        builder->capacity * 2;
+        entries = (library_entry_t*)realloc(builder->entries,
+                                        capacity * sizeof(library_entry_t));
+        if(NULL == entries)
+        {
+            CalcProgramDestroy(program);
+            return FAILED_ALLOCATION;
+        }
+        builder->entries = entries;
+        builder->capacity = capacity;
+    }
+
+    entry = builder->entries + builder->num_entries;
+    len = strlen(name);
+    entry->name = (char*)malloc(len + 1);
+    if(NULL == entry->name)
+    {
+        CalcProgramDestroy(program);
+        return FAILED_ALLOCATION;
+    }
+
+    memcpy(entry->name, name, len + 1);
+    entry->program = program;
+    entry->order = builder->num_entries++;
+
+    return SUCCESS;
+}
+
+/* by name, then by order of addition */
+static int CompareEntries(const void* a, const void* b)
+{
+    const library_entry_t* x = *(const library_entry_t* const*)a;
+    const library_entry_t* y = *(const library_entry_t* const*)b;
+    int cmp = strcmp(x->name, y->name);
+
+    return 0 != cmp ? cmp : (x->order > y->order) - (x->order < y->order);
+}
+
+/* Sorts the entries by name and drops all but the last of each name
+   @return value: number of entries left */
+static size_t SortEntries(const calc_library_builder_t* builder,
+                                                library_entry_t** sorted)
+{
+    size_t kept = 0;
+    size_t i = 0;
+
+    for( ; i < builder->num_entries; ++i)
+    {
+        sorted[i] = builder->entries + i;
+    }
+    qsort(sorted, builder->num_entries, sizeof(library_entry_t*),
+                                                            CompareEntries);
+
+    for(i = 0; i < builder->num_entries; ++i)
+    {
+        if(i + 1 < builder->num_entries &&
+                            0 == strcmp(sorted[i]->name, sorted[i + 1]->name))
+        {
+            continue;
+        }
+        sorted[kept++] = sorted[i];
+    }
+
+    return kept;
+}
+
+static unsigned int AddString(char* strings, unsigned int* size,
+                                                            const char* str)
+{
+    unsigned int offset = *size;
+    size_t len = strlen(str) + 1;
+
+    memcpy(strings + offset, str, len);
+    *size += len;
+
+    return offset;
+}
+
+/* Lays the formulas out in image, sized by Layout from header */
+static void FillImage(library_entry_t* const* sorted, size_t count,
+                        const library_header_t* header, unsigned char* image)
+{
+    library_formula_t* formula = (library_formula_t*)(image +
+                                                    sizeof(library_header_t));
+    double* constants = (double*)(image + header->constants_offset);
+    instruction_t* code = (instruction_t*)(image + header->code_offset);
+    unsigned int* vars = (unsigned int*)(image + header->vars_offset);
+    char* strings = (char*)image + header->strings_offset;
+    const calc_program_t* program = NULL;
+    unsigned int strings_size = 0;
+    unsigned int num_constants = 0;
+    unsigned int code_size = 0;
+    unsigned int num_vars = 0;
+    size_t i = 0;
+    size_t j = 0;
+
+    for( ; i < count; ++i, ++formula)
+    {
+        program = sorted[i]->program;
+        formula->name = AddString(strings, &strings_size, sorted[i]->name);
+        formula->code = code_size;
+        formula->code_size = program->code_size;
+        formula->constants = num_constants;
+        formula->num_constants = program->num_constants;
+        formula->vars = num_vars;
+        formula->num_vars = program->num_vars;
+        formula->max_depth = program->max_depth;
+        formula->num_temps = program->num_temps;
+        formula->reserved = 0;
+
+        if(0 < program->num_constants)
+        {
+            memcpy(constants + num_constants, program->constants,
+                                    program->num_constants * sizeof(double));
+        }
+        memcpy(code + code_size, program->code,
+                                program->code_size * sizeof(instruction_t));
+        for(j = 0; j < program->num_vars; ++j)
+        {
+            vars[num_vars + j] = AddString(strings, &strings_size,
+                                                    program->var_names[j]);
+        }
+
+        num_constants += program->num_constants;
+        code_size += program->code_size;
+        num_vars += program->num_vars;
+    }
+}
+
+static status_t WriteFile(const char* path, const unsigned char* image,
+                                                                size_t size)
+{
+    char* temp_path = (char*)malloc(strlen(path) + sizeof(".tmp"));
+    FILE* file = NULL;
+    int written = 0;
+
+    if(NULL == temp_path)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    strcpy(temp_path, path);
+    strcat(temp_path, ".tmp");
+
+    file = fopen(temp_path, "wb");
+    if(NULL != file)
+    {
+        written = 1 == fwrite(image, size, 1, file);
+        written = 0 == fclose(file) && written;
+        written = written && 0 == rename(temp_path, path);
+        if(!written)
+        {
+            remove(temp_path);
+        }
+    }
+
+    free(temp_path);
+
+    return written ? SUCCESS : INVALID_LIBRARY;
+}
+
+status_t CalcLibraryBuilderWrite(const calc_library_builder_t* builder,
+                                                            const char* path)
+{
+    library_header_t header;
+    library_entry_t** sorted = NULL;
+    const calc_program_t* program = NULL;
+    unsigned char* image = NULL;
+    unsigned long strings_size = 0;
+    unsigned long num_constants = 0;
+    unsigned long code_size = 0;
+    unsigned long num_vars = 0;
+    size_t count = 0;
+    size_t i = 0;
+    size_t j = 0;
+    status_t status = SUCCESS;
+
+    assert(builder);
+    assert(path);
+
+    sorted = (library_entry_t**)malloc((builder->num_entries + 1) *
+                                                    sizeof(library_entry_t*));
+    if(NULL == sorted)
+    {
+        return FAILED_ALLOCATION;
+    }
+    count = SortEntries(builder, sorted);
+
+    for( ; i < count; ++i)
+    {
+        program = sorted[i]->program;
+        strings_size += strlen(sorted[i]->name) + 1;
+        for(j = 0; j < program->num_vars; ++j)
+        {
+            strings_size += strlen(program->var_names[j]) + 1;
+        }
+        num_constants += program->num_constants;
+        code_size += program->code_size;
+        num_vars += program->num_vars;
+    }
+
+    memset(&header, 0, sizeof(header));
+    memcpy(header.magic, library_magic, sizeof(header.magic));
+    header.version = LIBRARY_VERSION;
+    header.num_formulas = count;
+    header.num_constants = num_constants;
+    header.code_size = code_size;
+    header.num_vars = num_vars;
+    header.strings_size = strings_size;
+
+    /* formulas, constants and variables are each no more than the
+       instructions, so no count was truncated */
+    if(strings_size > MAX_FILE_SIZE || code_size > MAX_FILE_SIZE ||
+                                                        !Layout(&header))
+    {
+        free(sorted);
+        return INVALID_LIBRARY;
+    }
+
+    /* zeroed, so the padding between sections is too */
+    image = (unsigned char*)calloc(header.file_size, 1);
+    if(NULL == image)
+    {
+        free(sorted);
+        return FAILED_ALLOCATION;
+    }
+
+    FillImage(sorted, count, &header, image);
+    Checksum(image + sizeof(header), header.file_size - sizeof(header),
+                                                            header.checksum);
+    memcpy(image, &header, sizeof(header));
+
+    status = WriteFile(path, image, header.file_size);
+    free(image);
+    free(sorted);
+
+    return status;
+}
+
+/* the program a formula is, borrowing the mapped code and constants */
+static void FormulaProgram(const calc_library_t* library, size_t index,
+                            const double* vars, calc_program_t* program)
+{
+    const library_formula_t* formula = library->formulas + index;
+
+    program->code = (instruction_t*)(library->code + formula->code);
+    program->code_size = formula->code_size;
+    program->code_capacity = formula->code_size;
+    program->constants = (double*)(library->constants + formula->constants);
+    program->num_constants = formula->num_constants;
+    program->constants_capacity = formula->num_constants;
+    program->var_names = NULL;
+    program->var_values = (double*)vars;    /* only ever read */
+    program->num_vars = formula->num_vars;
+    program->vars_capacity = formula->num_vars;
+    program->num_temps = formula->num_temps;
+    program->depth = 1;
+    program->max_depth = formula->max_depth;
+    program->tree = NULL;
+    program->jit = NULL;
+}
+
+/* a formula's ranges lie inside the sections, its names are strings and its
+   code runs */
+static int CheckFormula(const calc_library_t* library, size_t index)
+{
+    const library_header_t* header = library->header;
+    const library_formula_t* formula = library->formulas + index;
+    calc_program_t program;
+    size_t i = 0;
+
+    if(formula->name >= header->strings_size ||
+        formula->code > header->code_size ||
+        formula->code_size > header->code_size - formula->code ||
+        formula->constants > header->num_constants ||
+        formula->num_constants > header->num_constants - formula->constants ||
+        formula->vars > header->num_vars ||
+        formula->num_vars > header->num_vars - formula->vars)
+    {
+        return 0;
+    }
+
+    for( ; i < formula->num_vars; ++i)
+    {
+        if(library->vars[formula->vars + i] >= header->strings_size)
+        {
+            return 0;
+        }
+    }
+
+    /* sorted, for CalcLibraryFind */
+    if(0 < index && 0 <= strcmp(library->strings + formula[-1].name,
+                                        library->strings + formula->name))
+    {
+        return 0;
+    }
+
+    FormulaProgram(library, index, NULL, &program);
+
+    return ProgramVerify(&program);
+}
+
+/* the header matches its own counts and the file, and the checksum the
+   rest of the file */
+static int CheckHeader(const void* map, size_t size)
+{
+    library_header_t expected;
+    unsigned int checksum[2];
+
+    if(size < sizeof(library_header_t))
+    {
+        return 0;
+    }
+
+    memcpy(&expected, map, sizeof(expected));
+    if(0 != memcmp(expected.magic, library_magic, sizeof(expected.magic)) ||
+        LIBRARY_VERSION != expected.version ||
+        !Layout(&expected) ||
+        0 != memcmp(&expected, map, sizeof(expected)) ||
+        expected.file_size != size)
+    {
+        return 0;
+    }
+
+    Checksum((const unsigned char*)map + sizeof(expected),
+                                    size - sizeof(expected), checksum);
+
+    return checksum[0] == expected.checksum[0] &&
+                                        checksum[1] == expected.checksum[1];
+}
+
+static int CheckFormulas(const calc_library_t* library)
+{
+    const library_header_t* header = library->header;
+    size_t i = 0;
+
+    /* every string ends inside the section */
+    if(0 < header->strings_size &&
+                        '\0' != library->strings[header->strings_size - 1])
+    {
+        return 0;
+    }
+
+    for( ; i < header->num_formulas; ++i)
+    {
+        if(!CheckFormula(library, i))
+        {
+            return 0;
+        }
+    }
+
+    return 1;
+}
+
+status_t CalcLibraryOpen(const char* path, calc_library_t** library)
+{
+    calc_library_t* opened = NULL;
+    const unsigned char* base = NULL;
+    struct stat st;
+    int fd = -1;
+
+    assert(path);
+    assert(library);
+
+    *library = NULL;
+    opened = (calc_library_t*)malloc(sizeof(calc_library_t));
+    if(NULL == opened)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    fd = open(path, O_RDONLY);
+    if(fd < 0 || 0 != fstat(fd, &st) || 0 == st.st_size ||
+                                    (unsigned long)st.st_size > MAX_FILE_SIZE)
+    {
+        if(0 <= fd)
+        {
+            close(fd);
+        }
+        free(opened);
+        return INVALID_LIBRARY;
+    }
+
+    opened->size = st.st_size;
+    opened->map = mmap(NULL, opened->size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if(MAP_FAILED == opened->map)
+    {
+        free(opened);
+        return INVALID_LIBRARY;
+    }
+
+    if(!CheckHeader(opened->map, opened->size))
+    {
+        CalcLibraryClose(opened);
+        return INVALID_LIBRARY;
+    }
+
+    base = (const unsigned char*)opened->map;
+    opened->header = (const library_header_t*)base;
+    opened->formulas = (const library_formula_t*)(base +
+                                                    sizeof(library_header_t));
+    opened->constants = (const double*)(base +
+                                            opened->header->constants_offset);
+    opened->code = (const instruction_t*)(base +
+                                                opened->header->code_offset);
+    opened->vars = (const unsigned int*)(base + opened->header->vars_offset);
+    opened->strings = (const char*)base + opened->header->strings_offset;
+
+    if(!CheckFormulas(opened))
+    {
+        CalcLibraryClose(opened);
+        return INVALID_LIBRARY;
+    }
+
+    *library = opened;
+
+    return SUCCESS;
+}
+
+void CalcLibraryClose(calc_library_t* library)
+{
+    if(NULL == library)
+    {
+        return;
+    }
+
+    munmap(library->map, library->size);
+    free(library);
+}
+
+size_t CalcLibraryCount(const calc_library_t* library)
+{
+    assert(library);
+
+    return library->header->num_formulas;
+}
+
+size_t CalcLibraryFind(const calc_library_t* library, const char* name)
+{
+    size_t low = 0;
+    size_t high = 0;
+    size_t middle = 0;
+    int cmp = 0;
+
+    assert(library);
+    assert(name);
+
+    high = library->header->num_formulas;
+    while(low < high)
+    {
+        middle = low + (high - low) / 2;
+        cmp = strcmp(name, library->strings +
+                                        library->formulas[middle].name);
+        if(0 == cmp)
+        {
+            return middle;
+        }
+
+        if(cmp < 0)
+        {
+            high = middle;
+        }
+        else
+        {
+            low = middle + 1;
+        }
+    }
+
+    return library->header->num_formulas;
+}
+
+const char* CalcLibraryName(const calc_library_t* library, size_t index)
+{
+    assert(library);
+    assert(index < library->header->num_formulas);
+
+    return library->strings + library->formulas[index].name;
+}
+
+size_t CalcLibraryVariableCount(const calc_library_t* library, size_t index)
+{
+    assert(library);
+    assert(index < library->header->num_formulas);
+
+    return library->formulas[index].num_vars;
+}
+
+const char* CalcLibraryVariableName(const calc_library_t* library,
+                                                size_t index, size_t var)
+{
+    const library_formula_t* formula = NULL;
+
+    assert(library);
+    assert(index < library->header->num_formulas);
+
+    formula = library->formulas + index;
+    assert(var < formula->num_vars);
+
+    return library->strings + library->vars[formula->vars + var];
+}
+
+status_t CalcLibraryEval(const calc_library_t* library, size_t index,
+                                            const double* vars, double* ans)
+{
+    calc_program_t program;
+
+    assert(library);
+    assert(index < library->header->num_formulas);
+    assert(vars || 0 == library->formulas[index].num_vars);
+    assert(ans);
+
+    FormulaProgram(library, index, vars, &program);
+
+    return CalcEval(&program, ans);
+}
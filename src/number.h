@@ -0,0 +1,30 @@
+#ifndef __NUMBER_H__
+#define __NUMBER_H__
+
+#include <stddef.h> /* size_t */
+
+/* @Desc: Parse a decimal number - digits with an optional fraction and an
+          optional exponent ("12", "1.5", ".5", "1e-3") - into the correctly
+          rounded double, whatever the locale. Nothing at or past end is read
+   @params: start of the number, end of the input, pointer to store the
+            number in
+   @return value: pointer past the number, str if it does not start one*/
+
+const char* ParseNumber(const char* str, const char* end, double* result);
+
+/* @Desc: Find the end of the number ParseNumber would read, without
+          converting it
+   @params: start of the number, end of the input
+   @return value: pointer past the number, str if it does not start one*/
+
+const char* ScanNumber(const char* str, const char* end);
+
+/* @Desc: Write a double as sprintf's "%.17g" would, so that ParseNumber
+          reads it back exactly. Numbers in [2^-8, 2^53) are formatted
+          with integer arithmetic, several times faster than sprintf
+   @params: number, buffer of at least 32 chars
+   @return value: length of the text written, without the NUL*/
+
+size_t FormatNumber(double num, char* str);
+
+#endif      /* number.h */
@@ -0,0 +1,754 @@
+#include <stdlib.h>  /* malloc, realloc, free */
+#include <string.h>  /* memcmp, memcpy, memset */
+#include <assert.h>  /* assert */
+
+#include "program.h"
+#include "power.h"
+#include "functions.h"
+#include "typed_stack.h"
+
+#define NO_NODE ((size_t)-1)
+#define MAX_UNROLLED_POWER 4
+#define INITIAL_CAPACITY 64
+
+DEFINE_TYPED_STACK(IndexStack, index_stack_t, size_t, 64)
+
+typedef enum
+{
+    FOLD,
+    SIMPLIFY,
+    STRENGTH_REDUCE,
+    SHARE,
+    NUM_OF_PASSES
+} Pass;
+
+/* One node per value of the expression. Children always come before their
+   parents, so a forward walk over a list visits every node after its
+   operands. A node shared by several parents is computed once. */
+typedef struct node
+{
+    unsigned int opcode;
+    unsigned int operand;   /* variable index of OP_VAR */
+    double value;           /* value of OP_CONST */
+    size_t left;            /* NO_NODE for leaves */
+    size_t right;           /* NO_NODE for leaves, OP_NEG and functions of
+                               one argument */
+} node_t;
+
+typedef struct node_list
+{
+    node_t* nodes;
+    size_t size;
+    size_t capacity;
+} node_list_t;
+
+/* every pass rewrites the nodes of "in" into "out", then the two swap */
+typedef struct optimizer
+{
+    node_list_t lists[2];
+    node_list_t* in;
+    node_list_t* out;
+    size_t root;
+    size_t* map;        /* node of "in" -> its rewrite in "out" */
+    size_t* uses;       /* number of parents of each node of "in" */
+    size_t* slots;      /* temporary holding a shared node once computed */
+    size_t* table;      /* hash set of the nodes of "out", for SHARE */
+    size_t table_size;
+} optimizer_t;
+
+typedef size_t (*rewrite_func)(optimizer_t*, const node_t*);
+
+static size_t Fold(optimizer_t* opt, const node_t* node);
+static size_t Simplify(optimizer_t* opt, const node_t* node);
+static size_t StrengthReduce(optimizer_t* opt, const node_t* node);
+static size_t Share(optimizer_t* opt, const node_t* node);
+
+static const rewrite_func pass_funcs_LUT[NUM_OF_PASSES] = {Fold, Simplify,
+                                                    StrengthReduce, Share};
+
+static size_t Append(node_list_t* list, const node_t* node)
+{
+    size_t capacity = 0 == list->capacity ? INITIAL_CAPACITY :
+                                                        list->capacity * 2;
+    node_t* nodes = NULL;
+
+    if(list->size == list->capacity)
+    {
+        nodes = (node_t*)realloc(list->nodes, capacity * sizeof(node_t));
+        if(NULL == nodes)
+        {
+            return NO_NODE;
+        }
+
+        list->nodes = nodes;
+        list->capacity = capacity;
+    }
+
+    list->nodes[list->size] = *node;
+
+    return list->size++;
+}
+
+static void InitNode(node_t* node, unsigned int opcode, size_t left,
+                                                                size_t right)
+{
+    node->opcode = opcode;
+    node->operand = 0;
+    node->value = 0;
+    node->left = left;
+    node->right = right;
+}
+
+/* bitwise, so 0 does not match -0 */
+static int IsConstant(const node_t* nodes, size_t index, double value)
+{
+    return OP_CONST == nodes[index].opcode &&
+                    0 == memcmp(&nodes[index].value, &value, sizeof(double));
+}
+
+/* the same operations CalcEval runs, on constant operands */
+static status_t Compute(unsigned int opcode, double a, double b,
+                                                            double* result)
+{
+    switch(opcode)
+    {
+        case OP_ADD:
+            *result = a + b;
+            break;
+
+        case OP_SUB:
+            *result = a - b;
+            break;
+
+        case OP_NEG:
+            *result = a * -1;
+            break;
+
+        case OP_MUL:
+            *result = a * b;
+            break;
+
+        case OP_DIV:
+            if(b == 0)
+            {
+                return MATH_ERROR;
+            }
+            *result = a / b;
+            break;
+
+        case OP_POW:
+            return Power(a, b, result);
+
+        case OP_SQRT:
+        case OP_EXP:
+        case OP_LOG:
+        case OP_SIN:
+        case OP_COS:
+        case OP_MIN:
+        case OP_MAX:
+            return FunctionImpl((function_t)(opcode - OP_SQRT))(a, b, result);
+
+        default:
+            return MATH_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+/* operators on constants become constants; failing ones are kept so the
+   error is still reported when the program runs */
+static size_t Fold(optimizer_t* opt, const node_t* node)
+{
+    const node_t* nodes = opt->out->nodes;
+    node_t folded;
+    double right = 0;
+
+    if(NO_NODE == node->left || OP_CONST != nodes[node->left].opcode ||
+        (NO_NODE != node->right && OP_CONST != nodes[node->right].opcode))
+    {
+        return Append(opt->out, node);
+    }
+
+    right = NO_NODE == node->right ? 0 : nodes[node->right].value;
+    InitNode(&folded, OP_CONST, NO_NODE, NO_NODE);
+    if(SUCCESS != Compute(node->opcode, nodes[node->left].value, right,
+                                                            &folded.value))
+    {
+        return Append(opt->out, node);
+    }
+
+    return Append(opt->out, &folded);
+}
+
+/* --x, x*1, 1*x, x/1, x^1, x-0 and x+0 are x; adding a negation is
+   subtracting. All exact in IEEE arithmetic but x+0, which is -0 + 0 = 0 */
+static size_t Simplify(optimizer_t* opt, const node_t* node)
+{
+    const node_t* nodes = opt->out->nodes;
+    node_t simpler = *node;
+
+    switch(node->opcode)
+    {
+        case OP_NEG:
+            if(OP_NEG == nodes[node->left].opcode)
+            {
+                return nodes[node->left].left;
+            }
+            break;
+
+        case OP_ADD:
+            if(IsConstant(nodes, node->right, 0))
+            {
+                return node->left;
+            }
+            if(IsConstant(nodes, node->left, 0))
+            {
+                return node->right;
+            }
+            if(OP_NEG == nodes[node->right].opcode)
+            {
+                simpler.opcode = OP_SUB;
+                simpler.right = nodes[node->right].left;
+            }
+            else if(OP_NEG == nodes[node->left].opcode)
+            {
+                simpler.opcode = OP_SUB;
+                simpler.left = node->right;
+                simpler.right = nodes[node->left].left;
+            }
+            break;
+
+        case OP_SUB:
+            if(IsConstant(nodes, node->right, 0))
+            {
+                return node->left;
+            }
+            if(OP_NEG == nodes[node->right].opcode)
+            {
+                simpler.opcode = OP_ADD;
+                simpler.right = nodes[node->right].left;
+            }
+            break;
+
+        case OP_MUL:
+            if(IsConstant(nodes, node->right, 1))
+            {
+                return node->left;
+            }
+            if(IsConstant(nodes, node->left, 1))
+            {
+                return node->right;
+            }
+            break;
+
+        case OP_DIV:
+        case OP_POW:
+            if(IsConstant(nodes, node->right, 1))
+            {
+                return node->left;
+            }
+            break;
+    }
+
+    return Append(opt->out, &simpler);
+}
+
+static size_t Multiply(optimizer_t* opt, size_t left, size_t right)
+{
+    node_t product;
+
+    InitNode(&product, OP_POWMUL, left, right);
+
+    return Append(opt->out, &product);
+}
+
+/* x^n for small integer n becomes the multiplications Power would do, in
+   the same order, with the same range checks (OP_POWMUL) */
+static size_t StrengthReduce(optimizer_t* opt, const node_t* node)
+{
+    const node_t* nodes = opt->out->nodes;
+    size_t base = node->left;
+    size_t result = NO_NODE;
+    double exponent = 0;
+    unsigned int n = 0;
+
+    if(OP_POW != node->opcode || OP_CONST != nodes[node->right].opcode)
+    {
+        return Append(opt->out, node);
+    }
+
+    exponent = nodes[node->right].value;
+    if(exponent < 2 || exponent > MAX_UNROLLED_POWER ||
+                                    (double)(unsigned int)exponent != exponent)
+    {
+        return Append(opt->out, node);
+    }
+
+    for(n = (unsigned int)exponent; n > 0 && NO_NODE != base; n /= 2)
+    {
+        if(1 == n % 2)
+        {
+            result = NO_NODE == result ? base : Multiply(opt, result, base);
+            if(NO_NODE == result)
+            {
+                return NO_NODE;
+            }
+        }
+
+        if(n > 1)
+        {
+            base = Multiply(opt, base, base);
+        }
+    }
+
+    return NO_NODE == base ? NO_NODE : result;
+}
+
+static size_t HashNode(const node_t* node)
+{
+    unsigned char bytes[sizeof(double)];
+    size_t hash = node->opcode;
+    size_t i = 0;
+
+    memcpy(bytes, &node->value, sizeof(double));
+    hash = hash * 31 + node->operand;
+    for( ; i < sizeof(double); ++i)
+    {
+        hash = hash * 31 + bytes[i];
+    }
+    hash = hash * 31 + node->left;
+    hash = hash * 31 + node->right;
+
+    return hash ^ (hash >> 16);
+}
+
+static int IsSameNode(const node_t* a, const node_t* b)
+{
+    return a->opcode == b->opcode && a->operand == b->operand &&
+                a->left == b->left && a->right == b->right &&
+                0 == memcmp(&a->value, &b->value, sizeof(double));
+}
+
+/* equal nodes over equal operands become one node; operands of commutative
+   operators are ordered first, so a+b and b+a are equal too */
+static size_t Share(optimizer_t* opt, const node_t* node)
+{
+    node_t canonical = *node;
+    size_t mask = opt->table_size - 1;
+    size_t i = 0;
+
+    if((OP_ADD == node->opcode || OP_MUL == node->opcode ||
+                    OP_POWMUL == node->opcode) && node->left > node->right)
+    {
+        canonical.left = node->right;
+        canonical.right = node->left;
+    }
+
+    for(i = HashNode(&canonical) & mask; NO_NODE != opt->table[i];
+                                                            i = (i + 1) & mask)
+    {
+        if(IsSameNode(&opt->out->nodes[opt->table[i]], &canonical))
+        {
+            return opt->table[i];
+        }
+    }
+
+    opt->table[i] = Append(opt->out, &canonical);
+
+    return opt->table[i];
+}
+
+static status_t ResetTable(optimizer_t* opt)
+{
+    size_t size = 1;
+    size_t i = 0;
+
+    while(size < opt->in->size * 2)
+    {
+        size *= 2;
+    }
+
+    free(opt->table);
+    opt->table = (size_t*)malloc(size * sizeof(size_t));
+    if(NULL == opt->table)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; i < size; ++i)
+    {
+        opt->table[i] = NO_NODE;
+    }
+    opt->table_size = size;
+
+    return SUCCESS;
+}
+
+static int Resize(size_t** array, size_t size)
+{
+    size_t* resized = (size_t*)realloc(*array, (size + 1) * sizeof(size_t));
+
+    if(NULL == resized)
+    {
+        return 0;
+    }
+
+    *array = resized;
+
+    return 1;
+}
+
+/* nodes no longer reachable from the root get no uses */
+static status_t CountUses(optimizer_t* opt)
+{
+    const node_t* nodes = opt->in->nodes;
+    size_t i = opt->root + 1;
+
+    if(!Resize(&opt->uses, opt->in->size))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    memset(opt->uses, 0, opt->in->size * sizeof(size_t));
+    opt->uses[opt->root] = 1;
+
+    while(i-- > 0)
+    {
+        if(0 == opt->uses[i] || NO_NODE == nodes[i].left)
+        {
+            continue;
+        }
+
+        ++opt->uses[nodes[i].left];
+        if(NO_NODE != nodes[i].right && nodes[i].right != nodes[i].left)
+        {
+            ++opt->uses[nodes[i].right];
+        }
+    }
+
+    return SUCCESS;
+}
+
+static status_t Build(optimizer_t* opt, const calc_program_t* program)
+{
+    const instruction_t* ip = program->code;
+    const instruction_t* end = ip + program->code_size;
+    size_t* values = (size_t*)malloc((program->max_depth + 1) *
+                                                            sizeof(size_t));
+    size_t* temps = (size_t*)malloc((program->num_temps + 1) *
+                                                            sizeof(size_t));
+    size_t top = 0;
+    status_t status = SUCCESS;
+    node_t node;
+
+    for( ; ip < end && NULL != values && NULL != temps; ++ip)
+    {
+        InitNode(&node, ip->opcode, NO_NODE, NO_NODE);
+
+        switch(ip->opcode)
+        {
+            case OP_CONST:
+                node.value = program->constants[ip->operand];
+                break;
+
+            case OP_VAR:
+                node.operand = ip->operand;
+                break;
+
+            case OP_DUP:
+                values[top] = values[top - 1];
+                ++top;
+                continue;
+
+            case OP_STORE:
+                temps[ip->operand] = values[top - 1];
+                continue;
+
+            case OP_LOAD:
+                values[top++] = temps[ip->operand];
+                continue;
+
+            case OP_NEG:
+            case OP_SQRT:
+            case OP_EXP:
+            case OP_LOG:
+            case OP_SIN:
+            case OP_COS:
+                node.left = values[--top];
+                break;
+
+            default:
+                node.right = values[--top];
+                node.left = values[--top];
+                break;
+        }
+
+        values[top] = Append(opt->in, &node);
+        if(NO_NODE == values[top++])
+        {
+            break;
+        }
+    }
+
+    if(ip < end || NULL == values || NULL == temps)
+    {
+        status = FAILED_ALLOCATION;
+    }
+    else
+    {
+        opt->root = values[0];
+    }
+
+    free(values);
+    free(temps);
+
+    return status;
+}
+
+static status_t RunPass(optimizer_t* opt, rewrite_func rewrite)
+{
+    node_list_t* swap = opt->in;
+    node_t node;
+    size_t i = 0;
+    status_t status = CountUses(opt);
+
+    if(SUCCESS != status || !Resize(&opt->map, opt->in->size))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    opt->out->size = 0;
+    for( ; i <= opt->root; ++i)
+    {
+        if(0 == opt->uses[i])
+        {
+            continue;
+        }
+
+        node = opt->in->nodes[i];
+        if(NO_NODE != node.left)
+        {
+            node.left = opt->map[node.left];
+        }
+        if(NO_NODE != node.right)
+        {
+            node.right = opt->map[node.right];
+        }
+
+        opt->map[i] = rewrite(opt, &node);
+        if(NO_NODE == opt->map[i])
+        {
+            return FAILED_ALLOCATION;
+        }
+    }
+
+    opt->root = opt->map[opt->root];
+    opt->in = opt->out;
+    opt->out = swap;
+
+    return SUCCESS;
+}
+
+static status_t Put(calc_program_t* target, size_t* count,
+                            unsigned int opcode, size_t operand, double value)
+{
+    ++*count;
+
+    if(NULL == target)
+    {
+        return SUCCESS;
+    }
+
+    switch(opcode)
+    {
+        case OP_CONST:
+            return ProgramEmitConstant(target, value);
+
+        case OP_VAR:
+        case OP_STORE:
+        case OP_LOAD:
+            return ProgramEmitIndexed(target, (opcode_t)opcode,
+                                                    (unsigned int)operand);
+
+        default:
+            return ProgramEmitOperator(target, (opcode_t)opcode);
+    }
+}
+
+/* Postfix code of the nodes reachable from the root, or only its length
+   when target is NULL. A node with several parents is stored in a
+   temporary the first time and loaded after that; leaves are repeated.
+   Stack entries are node * 2, plus 1 once the operands are pushed. */
+static status_t Generate(optimizer_t* opt, calc_program_t* target,
+                                                                size_t* count)
+{
+    index_stack_t stack;
+    const node_t* node = NULL;
+    size_t entry = 0;
+    size_t index = 0;
+    size_t temps = 0;
+    status_t status = CountUses(opt);
+
+    *count = 0;
+    if(SUCCESS != status || !Resize(&opt->slots, opt->in->size))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; index < opt->in->size; ++index)
+    {
+        opt->slots[index] = NO_NODE;
+    }
+
+    IndexStackInit(&stack);
+    if(!IndexStackPush(&stack, opt->root * 2))
+    {
+        status = FAILED_ALLOCATION;
+    }
+
+    while(SUCCESS == status && !IndexStackIsEmpty(&stack))
+    {
+        entry = IndexStackPop(&stack);
+        index = entry / 2;
+        node = &opt->in->nodes[index];
+
+        if(1 == entry % 2)
+        {
+            if(node->left == node->right)
+            {
+                status = Put(target, count, OP_DUP, 0, 0);
+            }
+            if(SUCCESS == status)
+            {
+                status = Put(target, count, node->opcode, 0, 0);
+            }
+            if(SUCCESS == status && opt->uses[index] > 1)
+            {
+                opt->slots[index] = temps++;
+                status = Put(target, count, OP_STORE, opt->slots[index], 0);
+            }
+        }
+        else if(NO_NODE != opt->slots[index])
+        {
+            status = Put(target, count, OP_LOAD, opt->slots[index], 0);
+        }
+        else if(NO_NODE == node->left)
+        {
+            status = Put(target, count, node->opcode, node->operand,
+                                                                node->value);
+        }
+        else if(!IndexStackPush(&stack, entry + 1) ||
+            (NO_NODE != node->right && node->right != node->left &&
+                            !IndexStackPush(&stack, node->right * 2)) ||
+            !IndexStackPush(&stack, node->left * 2))
+        {
+            status = FAILED_ALLOCATION;
+        }
+    }
+
+    IndexStackDestroy(&stack);
+
+    return status;
+}
+
+static void OptimizerInit(optimizer_t* opt)
+{
+    int i = 0;
+
+    for( ; i < 2; ++i)
+    {
+        opt->lists[i].nodes = NULL;
+        opt->lists[i].size = 0;
+        opt->lists[i].capacity = 0;
+    }
+
+    opt->in = &opt->lists[0];
+    opt->out = &opt->lists[1];
+    opt->root = 0;
+    opt->map = NULL;
+    opt->uses = NULL;
+    opt->slots = NULL;
+    opt->table = NULL;
+    opt->table_size = 0;
+}
+
+static void OptimizerDestroy(optimizer_t* opt)
+{
+    free(opt->lists[0].nodes);
+    free(opt->lists[1].nodes);
+    free(opt->map);
+    free(opt->uses);
+    free(opt->slots);
+    free(opt->table);
+}
+
+status_t CalcOptimize(calc_program_t* program, calc_opt_report_t* report)
+{
+    optimizer_t opt;
+    calc_program_t* code = NULL;
+    size_t counts[NUM_OF_PASSES + 1];
+    status_t status = SUCCESS;
+    int pass = 0;
+
+    assert(program);
+
+    for( ; pass <= NUM_OF_PASSES; ++pass)
+    {
+        counts[pass] = program->code_size;
+    }
+
+    OptimizerInit(&opt);
+    if(0 < program->code_size)
+    {
+        status = Build(&opt, program);
+
+        for(pass = 0; pass < NUM_OF_PASSES && SUCCESS == status; ++pass)
+        {
+            if(SHARE == pass)
+            {
+                status = ResetTable(&opt);
+            }
+            if(SUCCESS == status)
+            {
+                status = RunPass(&opt, pass_funcs_LUT[pass]);
+            }
+            if(SUCCESS == status)
+            {
+                status = Generate(&opt, NULL, &counts[pass + 1]);
+            }
+        }
+
+        code = SUCCESS == status ? ProgramCreate() : NULL;
+        if(SUCCESS == status && NULL == code)
+        {
+            status = FAILED_ALLOCATION;
+        }
+        if(SUCCESS == status)
+        {
+            status = Generate(&opt, code, &counts[NUM_OF_PASSES]);
+        }
+        if(SUCCESS == status)
+        {
+            ProgramReplaceCode(program, code);
+        }
+        else
+        {
+            CalcProgramDestroy(code);
+        }
+    }
+    OptimizerDestroy(&opt);
+
+    if(SUCCESS == status && NULL != report)
+    {
+        report->instructions_before = counts[0];
+        report->instructions_after = counts[NUM_OF_PASSES];
+        report->folded = (long)counts[FOLD] - (long)counts[FOLD + 1];
+        report->simplified = (long)counts[SIMPLIFY] -
+                                                (long)counts[SIMPLIFY + 1];
+        report->strength_reduced = (long)counts[STRENGTH_REDUCE] -
+                                        (long)counts[STRENGTH_REDUCE + 1];
+        report->shared = (long)counts[SHARE] - (long)counts[SHARE + 1];
+    }
+
+    return status;
+}
@@ -0,0 +1,85 @@
+#include <math.h>    /* pow, floor, fabs */
+#include <float.h>   /* DBL_MAX */
+
+#include "power.h"
+
+/* 2^53: every double at or above it is an even integer, and squaring would
+   not end for an infinite one */
+#define MAX_SQUARING_EXPONENT 9007199254740992.0
+
+int IsFinite(double num)
+{
+    return num <= DBL_MAX && num >= -DBL_MAX;
+}
+
+/* O(log exponent) multiplications; exponent is a non-negative integer */
+static double PowerBySquaring(double base, double exponent)
+{
+    double result = 1;
+    double half = 0;
+
+    while(exponent > 0)
+    {
+        half = floor(exponent / 2);
+        if(exponent != half * 2)
+        {
+            result *= base;
+        }
+
+        exponent = half;
+        if(exponent > 0)
+        {
+            base *= base;
+        }
+    }
+
+    return result;
+}
+
+status_t Power(double base, double exponent, double* result)
+{
+    if(exponent < 0 && base == 0)
+    {
+        return MATH_ERROR;
+    }
+
+    if(floor(exponent) == exponent && fabs(exponent) <= MAX_SQUARING_EXPONENT)
+    {
+        *result = PowerBySquaring(base, exponent < 0 ? -exponent : exponent);
+        *result = exponent < 0 ? 1 / *result : *result;
+    }
+    else
+    {
+        /* no real root of a negative base for a fractional exponent (also
+           rejects NaN exponents); infinite ones go to pow as well */
+        if(exponent != exponent || (base < 0 && floor(exponent) != exponent))
+        {
+            return MATH_ERROR;
+        }
+
+        *result = pow(base, exponent);
+    }
+
+    /* overflow to infinity or underflow to zero from finite, non-zero base */
+    if(IsFinite(base) && (!IsFinite(*result) || (*result == 0 && base != 0)))
+    {
+        return MATH_ERROR;
+    }
+
+    return SUCCESS;
+}
+
+status_t PowerMultiply(double a, double b, double* result)
+{
+    double product = a * b;
+
+    if(IsFinite(a) && IsFinite(b) &&
+                    (!IsFinite(product) || (product == 0 && a != 0 && b != 0)))
+    {
+        return MATH_ERROR;
+    }
+
+    *result = product;
+
+    return SUCCESS;
+}
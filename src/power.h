@@ -0,0 +1,29 @@
+#ifndef __POWER_H__
+#define __POWER_H__
+
+#include "calculator.h"
+
+/* @Desc: Raise base to the power of exponent, shared by the in-place
+          evaluator and the compiled program evaluator. Integral exponents use
+          exponentiation by squaring, others use pow
+   @params: base, exponent, pointer to store the result in
+   @return value: SUCCESS, or MATH_ERROR for a negative power of zero, a
+                  fractional power of a negative base, overflow or underflow*/
+
+status_t Power(double base, double exponent, double* result);
+
+/* @Desc: Multiply two numbers as a step of a reduced power (OP_POWMUL), so
+          every evaluator reports the range errors Power would: a product of
+          finite, non-zero operands that overflows or underflows to zero
+   @params: operands, pointer to store the product in (untouched on error)
+   @return value: SUCCESS or MATH_ERROR*/
+
+status_t PowerMultiply(double a, double b, double* result);
+
+/* @Desc: Check that a number is neither infinite nor NaN
+   @params: number
+   @return value: 1 if it is finite, 0 otherwise*/
+
+int IsFinite(double num);
+
+#endif      /* power.h */
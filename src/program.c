@@ -0,0 +1,483 @@
+#include <stdlib.h>  /* malloc, realloc, free */
+#include <string.h>  /* memcpy, memcmp, strlen, strncmp */
+#include <assert.h>  /* assert */
+
+#include "program.h"
+#include "power.h"
+#include "functions.h"
+
+#define INITIAL_CAPACITY 8
+#define LOCAL_STACK_SIZE 64
+
+static const int stack_effect_LUT[NUM_OF_OPCODES] =
+{
+    1,      /* OP_CONST */
+    1,      /* OP_VAR */
+    -1,     /* OP_ADD */
+    -1,     /* OP_SUB */
+    0,      /* OP_NEG */
+    -1,     /* OP_MUL */
+    -1,     /* OP_DIV */
+    -1,     /* OP_POW */
+    -1,     /* OP_POWMUL */
+    0,      /* OP_SQRT */
+    0,      /* OP_EXP */
+    0,      /* OP_LOG */
+    0,      /* OP_SIN */
+    0,      /* OP_COS */
+    -1,     /* OP_MIN */
+    -1,     /* OP_MAX */
+    1,      /* OP_DUP */
+    0,      /* OP_STORE */
+    1       /* OP_LOAD */
+};
+
+/* values each instruction reads from the top of the stack */
+static const unsigned int operands_LUT[NUM_OF_OPCODES] =
+{
+    0, 0, 2, 2, 1, 2, 2, 2, 2, 1, 1, 1, 1, 1, 2, 2, 1, 1, 0
+};
+
+static int Reserve(void** buffer, size_t* capacity, size_t size,
+                                                        size_t element_size)
+{
+    size_t new_capacity = 0 == *capacity ? INITIAL_CAPACITY : *capacity * 2;
+    void* new_buffer = NULL;
+
+    if(size < *capacity)
+    {
+        return 1;
+    }
+
+    new_buffer = realloc(*buffer, new_capacity * element_size);
+    if(NULL == new_buffer)
+    {
+        return 0;
+    }
+
+    *buffer = new_buffer;
+    *capacity = new_capacity;
+
+    return 1;
+}
+
+static status_t Emit(calc_program_t* program, opcode_t opcode,
+                                                        unsigned int operand)
+{
+    instruction_t* instruction = NULL;
+
+    if(!Reserve((void**)&program->code, &program->code_capacity,
+                                program->code_size, sizeof(instruction_t)))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    instruction = program->code + program->code_size++;
+    instruction->opcode = opcode;
+    instruction->operand = operand;
+
+    program->depth += stack_effect_LUT[opcode];
+    if(program->depth > program->max_depth)
+    {
+        program->max_depth = program->depth;
+    }
+
+    return SUCCESS;
+}
+
+calc_program_t* ProgramCreate(void)
+{
+    calc_program_t* program = (calc_program_t*)malloc(sizeof(calc_program_t));
+
+    if(NULL == program)
+    {
+        return NULL;
+    }
+
+    program->code = NULL;
+    program->code_size = 0;
+    program->code_capacity = 0;
+    program->constants = NULL;
+    program->num_constants = 0;
+    program->constants_capacity = 0;
+    program->var_names = NULL;
+    program->var_values = NULL;
+    program->num_vars = 0;
+    program->vars_capacity = 0;
+    program->num_temps = 0;
+    program->depth = 0;
+    program->max_depth = 0;
+    program->tree = NULL;
+    program->jit = NULL;
+
+    return program;
+}
+
+status_t ProgramEmitConstant(calc_program_t* program, double value)
+{
+    assert(program);
+
+    if(!Reserve((void**)&program->constants, &program->constants_capacity,
+                                    program->num_constants, sizeof(double)))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    program->constants[program->num_constants] = value;
+
+    return Emit(program, OP_CONST, program->num_constants++);
+}
+
+static size_t FindVariable(const calc_program_t* program, const char* name,
+                                                                    size_t len)
+{
+    size_t i = 0;
+
+    for( ; i < program->num_vars; ++i)
+    {
+        if(0 == strncmp(program->var_names[i], name, len) &&
+                                        '\0' == program->var_names[i][len])
+        {
+            break;
+        }
+    }
+
+    return i;
+}
+
+static status_t AddVariable(calc_program_t* program, const char* name,
+                                                                    size_t len)
+{
+    size_t capacity = program->vars_capacity;
+    char* copy = NULL;
+
+    if(!Reserve((void**)&program->var_names, &capacity, program->num_vars,
+                                                                sizeof(char*)))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    if(!Reserve((void**)&program->var_values, &program->vars_capacity,
+                                        program->num_vars, sizeof(double)))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    copy = (char*)malloc(len + 1);
+    if(NULL == copy)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    memcpy(copy, name, len);
+    copy[len] = '\0';
+    program->var_names[program->num_vars] = copy;
+    program->var_values[program->num_vars] = 0;
+    ++program->num_vars;
+
+    return SUCCESS;
+}
+
+status_t ProgramEmitVariable(calc_program_t* program, const char* name,
+                                                                    size_t len)
+{
+    size_t index = 0;
+    status_t status = SUCCESS;
+
+    assert(program);
+    assert(name);
+
+    index = FindVariable(program, name, len);
+    if(index == program->num_vars)
+    {
+        status = AddVariable(program, name, len);
+    }
+
+    return SUCCESS == status ? Emit(program, OP_VAR, index) : status;
+}
+
+status_t ProgramEmitOperator(calc_program_t* program, opcode_t opcode)
+{
+    assert(program);
+    assert(OP_VAR < opcode && opcode <= OP_DUP);
+
+    return Emit(program, opcode, 0);
+}
+
+status_t ProgramEmitIndexed(calc_program_t* program, opcode_t opcode,
+                                                        unsigned int index)
+{
+    assert(program);
+    assert(OP_VAR == opcode || OP_STORE == opcode || OP_LOAD == opcode);
+
+    if(OP_STORE == opcode && index >= program->num_temps)
+    {
+        program->num_temps = index + 1;
+    }
+
+    return Emit(program, opcode, index);
+}
+
+void ProgramReplaceCode(calc_program_t* program, calc_program_t* code)
+{
+    assert(program);
+    assert(code);
+
+    free(program->code);
+    free(program->constants);
+
+    program->code = code->code;
+    program->code_size = code->code_size;
+    program->code_capacity = code->code_capacity;
+    program->constants = code->constants;
+    program->num_constants = code->num_constants;
+    program->constants_capacity = code->constants_capacity;
+    program->num_temps = code->num_temps;
+    program->depth = code->depth;
+    program->max_depth = code->max_depth;
+
+    /* the nodes and the native code of the old code are gone */
+    DependencyTreeDestroy(program->tree);
+    program->tree = NULL;
+    JitCodeDestroy(program->jit);
+    program->jit = NULL;
+
+    code->code = NULL;
+    code->constants = NULL;
+    CalcProgramDestroy(code);
+}
+
+void CalcProgramDestroy(calc_program_t* program)
+{
+    size_t i = 0;
+
+    if(NULL == program)
+    {
+        return;
+    }
+
+    for( ; i < program->num_vars; ++i)
+    {
+        free(program->var_names[i]);
+    }
+
+    free(program->var_names);
+    free(program->var_values);
+    free(program->constants);
+    free(program->code);
+    DependencyTreeDestroy(program->tree);
+    JitCodeDestroy(program->jit);
+    free(program);
+}
+
+size_t CalcVariableCount(const calc_program_t* program)
+{
+    assert(program);
+
+    return program->num_vars;
+}
+
+const char* CalcVariableName(const calc_program_t* program, size_t index)
+{
+    assert(program);
+    assert(index < program->num_vars);
+
+    return program->var_names[index];
+}
+
+status_t CalcSetVariable(calc_program_t* program, const char* name,
+                                                                double value)
+{
+    size_t index = 0;
+
+    assert(program);
+    assert(name);
+
+    index = FindVariable(program, name, strlen(name));
+    if(index == program->num_vars)
+    {
+        return INVALID_SYNTAX;
+    }
+
+    return CalcSetVariableIndex(program, index, value);
+}
+
+status_t CalcSetVariableIndex(calc_program_t* program, size_t index,
+                                                                double value)
+{
+    assert(program);
+
+    if(index >= program->num_vars)
+    {
+        return INVALID_SYNTAX;
+    }
+
+    /* bitwise, so 0 and -0 differ */
+    if(NULL != program->tree && 0 != memcmp(&program->var_values[index],
+                                                    &value, sizeof(double)))
+    {
+        DependencyTreeMarkVariable(program->tree, index);
+    }
+
+    program->var_values[index] = value;
+
+    return SUCCESS;
+}
+
+static status_t Execute(const calc_program_t* program, double* stack,
+                                                double* temps, double* ans)
+{
+    const instruction_t* ip = program->code;
+    const instruction_t* end = ip + program->code_size;
+    size_t top = 0;
+    status_t status = SUCCESS;
+
+    for( ; ip < end && SUCCESS == status; ++ip)
+    {
+        switch(ip->opcode)
+        {
+            case OP_CONST:
+                stack[top++] = program->constants[ip->operand];
+                break;
+
+            case OP_VAR:
+                stack[top++] = program->var_values[ip->operand];
+                break;
+
+            case OP_ADD:
+                --top;
+                stack[top - 1] += stack[top];
+                break;
+
+            case OP_SUB:
+                --top;
+                stack[top - 1] -= stack[top];
+                break;
+
+            case OP_NEG:
+                stack[top - 1] *= -1;
+                break;
+
+            case OP_MUL:
+                --top;
+                stack[top - 1] *= stack[top];
+                break;
+
+            case OP_DIV:
+                --top;
+                if(stack[top] == 0)
+                {
+                    status = MATH_ERROR;
+                    break;
+                }
+                stack[top - 1] /= stack[top];
+                break;
+
+            case OP_POW:
+                --top;
+                status = Power(stack[top - 1], stack[top], &stack[top - 1]);
+                break;
+
+            case OP_POWMUL:
+                --top;
+                status = PowerMultiply(stack[top - 1], stack[top],
+                                                            &stack[top - 1]);
+                break;
+
+            case OP_SQRT:
+            case OP_EXP:
+            case OP_LOG:
+            case OP_SIN:
+            case OP_COS:
+                status = FunctionImpl((function_t)(ip->opcode - OP_SQRT))(
+                                        stack[top - 1], 0, &stack[top - 1]);
+                break;
+
+            case OP_MIN:
+            case OP_MAX:
+                --top;
+                status = FunctionImpl((function_t)(ip->opcode - OP_SQRT))(
+                            stack[top - 1], stack[top], &stack[top - 1]);
+                break;
+
+            case OP_DUP:
+                stack[top] = stack[top - 1];
+                ++top;
+                break;
+
+            case OP_STORE:
+                temps[ip->operand] = stack[top - 1];
+                break;
+
+            case OP_LOAD:
+                stack[top++] = temps[ip->operand];
+                break;
+        }
+    }
+
+    if(SUCCESS == status)
+    {
+        *ans = stack[0];
+    }
+
+    return status;
+}
+
+int ProgramVerify(const calc_program_t* program)
+{
+    const instruction_t* ip = NULL;
+    const instruction_t* end = NULL;
+    size_t depth = 0;
+
+    assert(program);
+
+    for(ip = program->code, end = ip + program->code_size; ip < end; ++ip)
+    {
+        if(ip->opcode >= NUM_OF_OPCODES || depth < operands_LUT[ip->opcode] ||
+            (OP_CONST == ip->opcode && ip->operand >= program->num_constants) ||
+            (OP_VAR == ip->opcode && ip->operand >= program->num_vars) ||
+            ((OP_STORE == ip->opcode || OP_LOAD == ip->opcode) &&
+                                        ip->operand >= program->num_temps))
+        {
+            return 0;
+        }
+
+        depth += stack_effect_LUT[ip->opcode];
+        if(depth > program->max_depth)
+        {
+            return 0;
+        }
+    }
+
+    return 1 == depth;
+}
+
+status_t CalcEval(const calc_program_t* program, double* ans)
+{
+    double local_stack[LOCAL_STACK_SIZE];
+    double* stack = local_stack;
+    status_t status = SUCCESS;
+
+    assert(program);
+    assert(ans);
+
+    /* temporaries live past the top of the values stack */
+    if(program->max_depth + program->num_temps > LOCAL_STACK_SIZE)
+    {
+        stack = (double*)malloc((program->max_depth + program->num_temps) *
+                                                            sizeof(double));
+        if(NULL == stack)
+        {
+            return FAILED_ALLOCATION;
+        }
+    }
+
+    status = Execute(program, stack, stack + program->max_depth, ans);
+
+    if(stack != local_stack)
+    {
+        free(stack);
+    }
+
+    return status;
+}
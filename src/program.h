@@ -0,0 +1,124 @@
+#ifndef __PROGRAM_H__
+#define __PROGRAM_H__
+
+#include <stddef.h> /* size_t */
+
+#include "calculator.h"
+
+typedef enum
+{
+    OP_CONST,
+    OP_VAR,
+    OP_ADD,
+    OP_SUB,
+    OP_NEG,
+    OP_MUL,
+    OP_DIV,
+    OP_POW,
+    OP_POWMUL,  /* multiplication with Power's overflow/underflow checks */
+    OP_SQRT,    /* the functions, in the order of function_t */
+    OP_EXP,
+    OP_LOG,
+    OP_SIN,
+    OP_COS,
+    OP_MIN,
+    OP_MAX,
+    OP_DUP,
+    OP_STORE,   /* copy the top of the stack into a temporary */
+    OP_LOAD,
+    NUM_OF_OPCODES
+} opcode_t;
+
+typedef struct instruction
+{
+    unsigned int opcode;
+    unsigned int operand;   /* constant pool, variable or temporary index */
+} instruction_t;
+
+typedef struct dependency_tree dependency_tree_t;
+typedef struct jit_code jit_code_t;
+
+struct calc_program
+{
+    instruction_t* code;
+    size_t code_size;
+    size_t code_capacity;
+    double* constants;
+    size_t num_constants;
+    size_t constants_capacity;
+    char** var_names;
+    double* var_values;
+    size_t num_vars;
+    size_t vars_capacity;
+    size_t num_temps;
+    size_t depth;
+    size_t max_depth;
+    dependency_tree_t* tree;    /* built by CalcEvalIncremental */
+    jit_code_t* jit;            /* built by CalcJit */
+};
+
+/* @Desc: Create an empty program to emit postfix instructions into
+   @return value: pointer to the new program, NULL on allocation failure*/
+
+calc_program_t* ProgramCreate(void);
+
+/* @Desc: Append a push of a constant to the program
+   @params: Pointer to the program, value of the constant
+   @return value: SUCCESS or FAILED_ALLOCATION*/
+
+status_t ProgramEmitConstant(calc_program_t* program, double value);
+
+/* @Desc: Append a push of a named variable, adding it to the variable table
+          on its first occurrence
+   @params: Pointer to the program, name of the variable and its length
+   @return value: SUCCESS or FAILED_ALLOCATION*/
+
+status_t ProgramEmitVariable(calc_program_t* program, const char* name,
+                                                                size_t len);
+
+/* @Desc: Append an operator consuming its operands from the values stack
+   @params: Pointer to the program, opcode of the operator
+   @return value: SUCCESS or FAILED_ALLOCATION*/
+
+status_t ProgramEmitOperator(calc_program_t* program, opcode_t opcode);
+
+/* @Desc: Append an instruction that takes an index operand (a variable,
+          OP_STORE or OP_LOAD), growing the temporaries as needed
+   @params: Pointer to the program, opcode, index
+   @return value: SUCCESS or FAILED_ALLOCATION*/
+
+status_t ProgramEmitIndexed(calc_program_t* program, opcode_t opcode,
+                                                        unsigned int index);
+
+/* @Desc: Move the code, constants and temporaries of another program into
+          a program, keeping its variables, then free the other program
+   @params: Pointer to the program, program to take the code from*/
+
+void ProgramReplaceCode(calc_program_t* program, calc_program_t* code);
+
+/* @Desc: Check that a program read from outside the library can be run:
+          every opcode and operand is in range, no instruction reads past
+          the bottom of the values stack or pushes past max_depth, and one
+          value is left
+   @params: Pointer to the program
+   @return value: 1 if it can, 0 otherwise*/
+
+int ProgramVerify(const calc_program_t* program);
+
+/* @Desc: Mark the nodes that depend on a variable to be recomputed by the
+          next CalcEvalIncremental
+   @params: Pointer to the tree, index of the variable*/
+
+void DependencyTreeMarkVariable(dependency_tree_t* tree, size_t index);
+
+/* @Desc: Free a dependency tree (NULL is ignored)
+   @params: Pointer to the tree*/
+
+void DependencyTreeDestroy(dependency_tree_t* tree);
+
+/* @Desc: Unmap the native code of a program (NULL is ignored)
+   @params: Pointer to the code*/
+
+void JitCodeDestroy(jit_code_t* jit);
+
+#endif      /* program.h */
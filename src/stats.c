@@ -0,0 +1,137 @@
+#define _POSIX_C_SOURCE 199309L
+
+#include <string.h>  /* memset */
+#include <time.h>    /* clock_gettime */
+
+#include "stats.h"
+
+#define SUB_BUCKET_BITS 2
+#define SUB_BUCKETS (1UL << SUB_BUCKET_BITS)
+
+static size_t LatencyBucket(unsigned long duration)
+{
+    unsigned long power = 0;
+    size_t bucket = 0;
+
+    if(duration < SUB_BUCKETS)
+    {
+        return duration;
+    }
+
+    /* the sub-bucket is given by the bits right below the leading one */
+    power = 8 * sizeof(unsigned long) - 1 - __builtin_clzl(duration);
+    bucket = (power - SUB_BUCKET_BITS + 1) * SUB_BUCKETS +
+                ((duration >> (power - SUB_BUCKET_BITS)) & (SUB_BUCKETS - 1));
+
+    return bucket < CALC_LATENCY_BUCKETS ? bucket : CALC_LATENCY_BUCKETS - 1;
+}
+
+static void Add(size_t* counter, size_t value, int shared)
+{
+    if(shared)
+    {
+        __atomic_add_fetch(counter, value, __ATOMIC_RELAXED);
+    }
+    else
+    {
+        __atomic_store_n(counter, *counter + value, __ATOMIC_RELAXED);
+    }
+}
+
+static void Max(size_t* counter, size_t value, int shared)
+{
+    size_t current = __atomic_load_n(counter, __ATOMIC_RELAXED);
+
+    while(current < value)
+    {
+        if(!shared)
+        {
+            __atomic_store_n(counter, value, __ATOMIC_RELAXED);
+            return;
+        }
+
+        if(__atomic_compare_exchange_n(counter, &current, value, 1,
+                                        __ATOMIC_RELAXED, __ATOMIC_RELAXED))
+        {
+            return;
+        }
+    }
+}
+
+static size_t Load(const size_t* counter)
+{
+    return __atomic_load_n(counter, __ATOMIC_RELAXED);
+}
+
+void StatsRunInit(stats_run_t* run)
+{
+    memset(run, 0, sizeof(stats_run_t));
+}
+
+unsigned long StatsNow(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return (unsigned long)now.tv_sec * 1000000000UL +
+                                                (unsigned long)now.tv_nsec;
+}
+
+void StatsRecord(calc_stats_t* stats, const stats_run_t* run,
+                                        unsigned long duration, int shared)
+{
+    int op = 0;
+
+    Add(&stats->calls, 1, shared);
+    Add(&stats->tokens, run->tokens, shared);
+    Add(&stats->numbers, run->numbers, shared);
+
+    for( ; op < CALC_NUM_OF_OPERATORS; ++op)
+    {
+        if(0 != run->operators[op])
+        {
+            Add(&stats->operators[op], run->operators[op], shared);
+        }
+    }
+
+    Max(&stats->max_numbers_depth, run->max_numbers_depth, shared);
+    Max(&stats->max_operators_depth, run->max_operators_depth, shared);
+    Add(&stats->whitespace_bytes, run->whitespace_bytes, shared);
+    Add(&stats->latency[LatencyBucket(duration)], 1, shared);
+}
+
+void StatsRead(const calc_stats_t* stats, calc_stats_t* snapshot)
+{
+    size_t i = 0;
+
+    snapshot->calls = Load(&stats->calls);
+    snapshot->tokens = Load(&stats->tokens);
+    snapshot->numbers = Load(&stats->numbers);
+
+    for( ; i < CALC_NUM_OF_OPERATORS; ++i)
+    {
+        snapshot->operators[i] = Load(&stats->operators[i]);
+    }
+
+    snapshot->max_numbers_depth = Load(&stats->max_numbers_depth);
+    snapshot->max_operators_depth = Load(&stats->max_operators_depth);
+    snapshot->whitespace_bytes = Load(&stats->whitespace_bytes);
+
+    for(i = 0; i < CALC_LATENCY_BUCKETS; ++i)
+    {
+        snapshot->latency[i] = Load(&stats->latency[i]);
+    }
+}
+
+unsigned long CalcLatencyBucketFloor(size_t bucket)
+{
+    unsigned long power = bucket / SUB_BUCKETS + SUB_BUCKET_BITS - 1;
+
+    if(bucket < SUB_BUCKETS)
+    {
+        return bucket;
+    }
+
+    return (SUB_BUCKETS + bucket % SUB_BUCKETS) << (power - SUB_BUCKET_BITS);
+}
@@ -0,0 +1,44 @@
+#ifndef __STATS_H__
+#define __STATS_H__
+
+#include <stddef.h> /* size_t */
+
+#include "calculator.h"
+
+/* Counters of a single call, owned by the calling thread */
+typedef struct stats_run
+{
+    size_t tokens;
+    size_t numbers;
+    size_t operators[CALC_NUM_OF_OPERATORS];
+    size_t max_numbers_depth;
+    size_t max_operators_depth;
+    size_t whitespace_bytes;
+} stats_run_t;
+
+/* @Desc: Zero the counters of a call
+   @params: Pointer to the counters*/
+
+void StatsRunInit(stats_run_t* run);
+
+/* @Desc: Read a monotonic clock
+   @return value: nanoseconds since an arbitrary start*/
+
+unsigned long StatsNow(void);
+
+/* @Desc: Add the counters and the duration of a call to stats. Stats written
+          by one thread only may be updated with plain stores, stats shared
+          between threads need atomic read-modify-writes
+   @params: stats to add to, counters of the call, its duration in
+            nanoseconds, non-zero when stats are shared between threads*/
+
+void StatsRecord(calc_stats_t* stats, const stats_run_t* run,
+                                        unsigned long duration, int shared);
+
+/* @Desc: Copy stats while they may be recorded to, one atomic load per
+          counter
+   @params: stats to read, snapshot to fill*/
+
+void StatsRead(const calc_stats_t* stats, calc_stats_t* snapshot);
+
+#endif      /* stats.h */
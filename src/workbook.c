@@ -0,0 +1,765 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdlib.h>   /* malloc, realloc, calloc, free */
+#include <string.h>   /* strlen, strcmp, memcpy, memcmp */
+#include <assert.h>   /* assert */
+#include <pthread.h>  /* pthread_create, pthread_join, pthread_mutex_t */
+#include <unistd.h>   /* sysconf */
+
+#include "calc_workbook.h"
+
+#define NO_CELL ((size_t)-1)
+#define NO_LEVEL ((size_t)-1)
+#define INITIAL_CAPACITY 16
+#define CELLS_PER_CLAIM 4
+#define CELLS_PER_THREAD 16
+#define FNV_OFFSET 2166136261UL
+#define FNV_PRIME 16777619UL
+
+typedef struct cell
+{
+    char* name;
+    calc_program_t* program;    /* NULL for inputs and undefined cells */
+    size_t* refs;               /* cell of each variable of the program */
+    size_t num_refs;
+    size_t* dependents;         /* cells whose programs reference this one */
+    size_t num_dependents;
+    size_t dependents_capacity;
+    size_t level;               /* NO_LEVEL in or after a cycle */
+    size_t pending;             /* references not levelled yet */
+    double value;
+    status_t status;
+    int dirty;
+} cell_t;
+
+struct calc_workbook
+{
+    cell_t* cells;
+    size_t num_cells;
+    size_t capacity;
+    size_t* table;              /* open addressing, name -> cell */
+    size_t table_size;
+    size_t* dirty;              /* cells to recompute, capacity cells */
+    size_t num_dirty;
+    size_t num_levels;
+    int relevel;                /* references changed since levelling */
+    int has_cycle;
+};
+
+/* the dirty cells of one evaluation, grouped by level */
+typedef struct run
+{
+    calc_workbook_t* workbook;
+    size_t* order;
+    size_t* level_start;        /* non-empty levels only */
+    size_t* claims;             /* next unclaimed cell of each level */
+    size_t num_levels;
+    unsigned workers;
+    unsigned waiting;
+    unsigned long generation;
+    pthread_mutex_t lock;
+    pthread_cond_t released;
+} run_t;
+
+typedef struct worker
+{
+    run_t* run;
+    int started;
+    pthread_t thread;
+} worker_t;
+
+static unsigned long Hash(const char* name)
+{
+    unsigned long hash = FNV_OFFSET;
+
+    for( ; '\0' != *name; ++name)
+    {
+        hash = ((hash ^ (unsigned char)*name) * FNV_PRIME) & 0xFFFFFFFFUL;
+    }
+
+    return hash;
+}
+
+static size_t* Slot(const calc_workbook_t* workbook, const char* name)
+{
+    size_t mask = workbook->table_size - 1;
+    size_t i = Hash(name) & mask;
+
+    while(NO_CELL != workbook->table[i] &&
+                0 != strcmp(workbook->cells[workbook->table[i]].name, name))
+    {
+        i = (i + 1) & mask;
+    }
+
+    return &workbook->table[i];
+}
+
+static size_t FindCell(const calc_workbook_t* workbook, const char* name)
+{
+    return *Slot(workbook, name);
+}
+
+/* keeps the table at most half full */
+static int GrowTable(calc_workbook_t* workbook)
+{
+    size_t* old_table = workbook->table;
+    size_t old_size = workbook->table_size;
+    size_t i = 0;
+
+    workbook->table_size = 0 == old_size ? 2 * INITIAL_CAPACITY :
+                                                                old_size * 2;
+    workbook->table = (size_t*)malloc(workbook->table_size * sizeof(size_t));
+    if(NULL == workbook->table)
+    {
+        workbook->table = old_table;
+        workbook->table_size = old_size;
+        return 0;
+    }
+
+    for( ; i < workbook->table_size; ++i)
+    {
+        workbook->table[i] = NO_CELL;
+    }
+
+    for(i = 0; i < workbook->num_cells; ++i)
+    {
+        *Slot(workbook, workbook->cells[i].name) = i;
+    }
+
+    free(old_table);
+
+    return 1;
+}
+
+static int GrowCells(calc_workbook_t* workbook)
+{
+    size_t capacity = 0 == workbook->capacity ? INITIAL_CAPACITY :
+                                                    workbook->capacity * 2;
+    cell_t* cells = NULL;
+    size_t* dirty = NULL;
+
+    cells = (cell_t*)realloc(workbook->cells, capacity * sizeof(cell_t));
+    if(NULL == cells)
+    {
+        return 0;
+    }
+    workbook->cells = cells;
+
+    dirty = (size_t*)realloc(workbook->dirty, capacity * sizeof(size_t));
+    if(NULL == dirty)
+    {
+        return 0;
+    }
+    workbook->dirty = dirty;
+    workbook->capacity = capacity;
+
+    return 1;
+}
+
+/* a name seen for the first time is an undefined cell until it is set */
+static size_t FindOrAddCell(calc_workbook_t* workbook, const char* name)
+{
+    size_t index = FindCell(workbook, name);
+    size_t len = strlen(name);
+    cell_t* cell = NULL;
+
+    if(NO_CELL != index)
+    {
+        return index;
+    }
+
+    if((workbook->num_cells + 1) * 2 > workbook->table_size &&
+                                                        !GrowTable(workbook))
+    {
+        return NO_CELL;
+    }
+
+    if(workbook->num_cells == workbook->capacity && !GrowCells(workbook))
+    {
+        return NO_CELL;
+    }
+
+    cell = workbook->cells + workbook->num_cells;
+    cell->name = (char*)malloc(len + 1);
+    if(NULL == cell->name)
+    {
+        return NO_CELL;
+    }
+
+    memcpy(cell->name, name, len + 1);
+    cell->program = NULL;
+    cell->refs = NULL;
+    cell->num_refs = 0;
+    cell->dependents = NULL;
+    cell->num_dependents = 0;
+    cell->dependents_capacity = 0;
+    cell->level = 0;
+    cell->pending = 0;
+    cell->value = 0;
+    cell->status = INVALID_SYNTAX;
+    cell->dirty = 0;
+
+    *Slot(workbook, name) = workbook->num_cells;
+    workbook->relevel = 1;
+
+    return workbook->num_cells++;
+}
+
+static int ReserveDependent(cell_t* cell)
+{
+    size_t capacity = 0 == cell->dependents_capacity ? INITIAL_CAPACITY / 4 :
+                                                cell->dependents_capacity * 2;
+    size_t* dependents = NULL;
+
+    if(cell->num_dependents < cell->dependents_capacity)
+    {
+        return 1;
+    }
+
+    dependents = (size_t*)realloc(cell->dependents,
+                                                capacity * sizeof(size_t));
+    if(NULL == dependents)
+    {
+        return 0;
+    }
+
+    cell->dependents = dependents;
+    cell->dependents_capacity = capacity;
+
+    return 1;
+}
+
+static void RemoveDependent(cell_t* cell, size_t dependent)
+{
+    size_t i = 0;
+
+    for( ; i < cell->num_dependents; ++i)
+    {
+        if(cell->dependents[i] == dependent)
+        {
+            cell->dependents[i] = cell->dependents[--cell->num_dependents];
+            return;
+        }
+    }
+}
+
+/* drops the cell's formula and its links to the cells it referenced */
+static void Unlink(calc_workbook_t* workbook, size_t index)
+{
+    cell_t* cell = workbook->cells + index;
+    size_t i = 0;
+
+    if(NULL == cell->program)
+    {
+        return;
+    }
+
+    for( ; i < cell->num_refs; ++i)
+    {
+        RemoveDependent(workbook->cells + cell->refs[i], index);
+    }
+
+    CalcProgramDestroy(cell->program);
+    free(cell->refs);
+    cell->program = NULL;
+    cell->refs = NULL;
+    cell->num_refs = 0;
+    workbook->relevel = 1;
+}
+
+/* the dirty list doubles as the queue of a breadth-first walk down the
+   dependents; cells already dirty have their dependents dirty too */
+static void MarkDirty(calc_workbook_t* workbook, size_t index)
+{
+    cell_t* cells = workbook->cells;
+    size_t next = workbook->num_dirty;
+    size_t i = 0;
+    size_t dependent = 0;
+
+    if(cells[index].dirty)
+    {
+        return;
+    }
+
+    cells[index].dirty = 1;
+    workbook->dirty[workbook->num_dirty++] = index;
+
+    for( ; next < workbook->num_dirty; ++next)
+    {
+        for(i = 0; i < cells[workbook->dirty[next]].num_dependents; ++i)
+        {
+            dependent = cells[workbook->dirty[next]].dependents[i];
+            if(!cells[dependent].dirty)
+            {
+                cells[dependent].dirty = 1;
+                workbook->dirty[workbook->num_dirty++] = dependent;
+            }
+        }
+    }
+}
+
+calc_workbook_t* CalcWorkbookCreate(void)
+{
+    calc_workbook_t* workbook = (calc_workbook_t*)calloc(1,
+                                                    sizeof(calc_workbook_t));
+
+    if(NULL == workbook)
+    {
+        return NULL;
+    }
+
+    if(!GrowTable(workbook) || !GrowCells(workbook))
+    {
+        CalcWorkbookDestroy(workbook);
+        return NULL;
+    }
+
+    return workbook;
+}
+
+void CalcWorkbookDestroy(calc_workbook_t* workbook)
+{
+    size_t i = 0;
+
+    assert(workbook);
+
+    for( ; i < workbook->num_cells; ++i)
+    {
+        free(workbook->cells[i].name);
+        CalcProgramDestroy(workbook->cells[i].program);
+        free(workbook->cells[i].refs);
+        free(workbook->cells[i].dependents);
+    }
+
+    free(workbook->cells);
+    free(workbook->table);
+    free(workbook->dirty);
+    free(workbook);
+}
+
+/* everything that can fail is done before the cell is touched */
+status_t CalcWorkbookSet(calc_workbook_t* workbook, const char* name,
+                                                            const char* expr)
+{
+    calc_program_t* program = NULL;
+    size_t* refs = NULL;
+    size_t num_refs = 0;
+    size_t index = 0;
+    size_t i = 0;
+    status_t status = SUCCESS;
+
+    assert(workbook);
+    assert(name);
+    assert(expr);
+
+    status = CalcCompile(expr, &program);
+    if(SUCCESS == status)
+    {
+        status = CalcOptimize(program, NULL);
+    }
+    if(SUCCESS != status)
+    {
+        CalcProgramDestroy(program);
+        return status;
+    }
+
+    num_refs = CalcVariableCount(program);
+    refs = (size_t*)malloc((num_refs + 1) * sizeof(size_t));
+    index = NULL == refs ? NO_CELL : FindOrAddCell(workbook, name);
+    for( ; NO_CELL != index && i < num_refs; ++i)
+    {
+        refs[i] = FindOrAddCell(workbook, CalcVariableName(program, i));
+        if(NO_CELL == refs[i] ||
+                            !ReserveDependent(workbook->cells + refs[i]))
+        {
+            index = NO_CELL;
+        }
+    }
+
+    if(NO_CELL == index)
+    {
+        free(refs);
+        CalcProgramDestroy(program);
+        return FAILED_ALLOCATION;
+    }
+
+    Unlink(workbook, index);
+    workbook->cells[index].program = program;
+    workbook->cells[index].refs = refs;
+    workbook->cells[index].num_refs = num_refs;
+    for(i = 0; i < num_refs; ++i)
+    {
+        workbook->cells[refs[i]].dependents[
+                            workbook->cells[refs[i]].num_dependents++] = index;
+    }
+
+    /* the cell may have been a value or an undefined reference until now,
+       levelled as a cell without references */
+    workbook->relevel = 1;
+    MarkDirty(workbook, index);
+
+    return SUCCESS;
+}
+
+status_t CalcWorkbookSetValue(calc_workbook_t* workbook, const char* name,
+                                                                double value)
+{
+    size_t index = 0;
+    cell_t* cell = NULL;
+
+    assert(workbook);
+    assert(name);
+
+    index = FindOrAddCell(workbook, name);
+    if(NO_CELL == index)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    cell = workbook->cells + index;
+    if(NULL == cell->program && SUCCESS == cell->status &&
+                            0 == memcmp(&cell->value, &value, sizeof(double)))
+    {
+        return SUCCESS;
+    }
+
+    Unlink(workbook, index);
+    cell->value = value;
+    cell->status = SUCCESS;
+    MarkDirty(workbook, index);
+
+    return SUCCESS;
+}
+
+/* Kahn's algorithm: a cell is levelled once all of the cells it references
+   are, one level above the highest of them. Cells never levelled are in a
+   cycle or depend on one */
+static int Relevel(calc_workbook_t* workbook)
+{
+    cell_t* cells = workbook->cells;
+    size_t* queue = (size_t*)malloc((workbook->num_cells + 1) *
+                                                            sizeof(size_t));
+    size_t head = 0;
+    size_t tail = 0;
+    size_t i = 0;
+    cell_t* dependent = NULL;
+
+    if(NULL == queue)
+    {
+        return 0;
+    }
+
+    for( ; i < workbook->num_cells; ++i)
+    {
+        cells[i].pending = cells[i].num_refs;
+        cells[i].level = 0;
+        if(0 == cells[i].pending)
+        {
+            queue[tail++] = i;
+        }
+    }
+
+    workbook->num_levels = 0;
+    for( ; head < tail; ++head)
+    {
+        if(cells[queue[head]].level >= workbook->num_levels)
+        {
+            workbook->num_levels = cells[queue[head]].level + 1;
+        }
+
+        for(i = 0; i < cells[queue[head]].num_dependents; ++i)
+        {
+            dependent = cells + cells[queue[head]].dependents[i];
+            if(dependent->level <= cells[queue[head]].level)
+            {
+                dependent->level = cells[queue[head]].level + 1;
+            }
+            if(0 == --dependent->pending)
+            {
+                queue[tail++] = dependent - cells;
+            }
+        }
+    }
+
+    workbook->has_cycle = tail < workbook->num_cells;
+    for(i = 0; i < workbook->num_cells; ++i)
+    {
+        if(0 != cells[i].pending)
+        {
+            cells[i].level = NO_LEVEL;
+        }
+    }
+
+    workbook->relevel = 0;
+    free(queue);
+
+    return 1;
+}
+
+static void EvaluateCell(calc_workbook_t* workbook, size_t index)
+{
+    cell_t* cell = workbook->cells + index;
+    const cell_t* ref = NULL;
+    size_t i = 0;
+
+    /* inputs keep their value, undefined cells their INVALID_SYNTAX */
+    if(NULL == cell->program)
+    {
+        return;
+    }
+
+    for( ; i < cell->num_refs; ++i)
+    {
+        ref = workbook->cells + cell->refs[i];
+        if(SUCCESS != ref->status)
+        {
+            cell->status = ref->status;
+            return;
+        }
+
+        CalcSetVariableIndex(cell->program, i, ref->value);
+    }
+
+    cell->status = CalcEvalIncremental(cell->program, &cell->value);
+}
+
+/* the number of workers is only read under the lock */
+static void BarrierWait(run_t* run)
+{
+    unsigned long generation = 0;
+
+    pthread_mutex_lock(&run->lock);
+    generation = run->generation;
+    if(++run->waiting == run->workers)
+    {
+        run->waiting = 0;
+        ++run->generation;
+        pthread_cond_broadcast(&run->released);
+    }
+    else
+    {
+        while(generation == run->generation)
+        {
+            pthread_cond_wait(&run->released, &run->lock);
+        }
+    }
+    pthread_mutex_unlock(&run->lock);
+}
+
+/* every worker claims cells of a level until none is left, then waits for
+   the others before the next level, whose cells read the results */
+static void* WorkerMain(void* arg)
+{
+    run_t* run = ((worker_t*)arg)->run;
+    size_t level = 0;
+    size_t claim = 0;
+    size_t end = 0;
+    size_t i = 0;
+
+    for( ; level < run->num_levels; ++level)
+    {
+        end = run->level_start[level + 1];
+        while((claim = __atomic_fetch_add(&run->claims[level],
+                                CELLS_PER_CLAIM, __ATOMIC_RELAXED)) < end)
+        {
+            for(i = claim; i < claim + CELLS_PER_CLAIM && i < end; ++i)
+            {
+                EvaluateCell(run->workbook, run->order[i]);
+            }
+        }
+
+        BarrierWait(run);
+    }
+
+    return NULL;
+}
+
+static unsigned OnlineCpus(void)
+{
+    long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+
+    return cpus < 1 ? 1 : (unsigned)cpus;
+}
+
+static status_t RunLevels(run_t* run, unsigned threads)
+{
+    worker_t* workers = (worker_t*)malloc(threads * sizeof(worker_t));
+    unsigned i = 0;
+
+    if(NULL == workers)
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    for( ; i < threads; ++i)
+    {
+        workers[i].run = run;
+        workers[i].started = 0;
+    }
+
+    pthread_mutex_init(&run->lock, NULL);
+    pthread_cond_init(&run->released, NULL);
+    run->waiting = 0;
+    run->generation = 0;
+
+    /* the calling thread is worker 0. Workers reach the barrier only once
+       the lock is released, by then the number of workers is known */
+    pthread_mutex_lock(&run->lock);
+    run->workers = 1;
+    for(i = 1; i < threads; ++i)
+    {
+        workers[i].started = 0 == pthread_create(&workers[i].thread, NULL,
+                                                    WorkerMain, &workers[i]);
+        run->workers += workers[i].started;
+    }
+    pthread_mutex_unlock(&run->lock);
+
+    WorkerMain(&workers[0]);
+
+    for(i = 1; i < threads; ++i)
+    {
+        if(workers[i].started)
+        {
+            pthread_join(workers[i].thread, NULL);
+        }
+    }
+
+    pthread_cond_destroy(&run->released);
+    pthread_mutex_destroy(&run->lock);
+    free(workers);
+
+    return SUCCESS;
+}
+
+/* counting sort of the dirty cells by level, keeping non-empty levels */
+static int GroupByLevel(calc_workbook_t* workbook, run_t* run)
+{
+    size_t* counts = (size_t*)calloc(workbook->num_levels + 1,
+                                                            sizeof(size_t));
+    const cell_t* cell = NULL;
+    size_t level = 0;
+    size_t i = 0;
+
+    run->order = (size_t*)malloc((workbook->num_dirty + 1) * sizeof(size_t));
+    run->level_start = (size_t*)malloc((workbook->num_levels + 1) *
+                                                            sizeof(size_t));
+    run->claims = (size_t*)malloc((workbook->num_levels + 1) *
+                                                            sizeof(size_t));
+    if(NULL == counts || NULL == run->order || NULL == run->level_start ||
+                                                        NULL == run->claims)
+    {
+        free(counts);
+        return 0;
+    }
+
+    for( ; i < workbook->num_dirty; ++i)
+    {
+        cell = workbook->cells + workbook->dirty[i];
+        if(NO_LEVEL != cell->level)
+        {
+            ++counts[cell->level + 1];
+        }
+    }
+
+    for(level = 0; level < workbook->num_levels; ++level)
+    {
+        counts[level + 1] += counts[level];
+    }
+
+    for(i = 0; i < workbook->num_dirty; ++i)
+    {
+        cell = workbook->cells + workbook->dirty[i];
+        if(NO_LEVEL != cell->level)
+        {
+            run->order[counts[cell->level]++] = workbook->dirty[i];
+        }
+    }
+
+    /* counts[level] is now where the level ends */
+    run->num_levels = 0;
+    run->level_start[0] = 0;
+    for(level = 0; level < workbook->num_levels; ++level)
+    {
+        if(counts[level] > run->level_start[run->num_levels])
+        {
+            run->claims[run->num_levels] = run->level_start[run->num_levels];
+            run->level_start[++run->num_levels] = counts[level];
+        }
+    }
+
+    free(counts);
+
+    return 1;
+}
+
+status_t CalcWorkbookEvaluate(calc_workbook_t* workbook, unsigned threads)
+{
+    run_t run;
+    size_t i = 0;
+    status_t status = SUCCESS;
+
+    assert(workbook);
+
+    if(workbook->relevel && !Relevel(workbook))
+    {
+        return FAILED_ALLOCATION;
+    }
+
+    run.workbook = workbook;
+    run.order = NULL;
+    run.level_start = NULL;
+    run.claims = NULL;
+    if(!GroupByLevel(workbook, &run))
+    {
+        status = FAILED_ALLOCATION;
+    }
+    else
+    {
+        threads = 0 == threads ? OnlineCpus() : threads;
+        if(threads > workbook->num_dirty / CELLS_PER_THREAD)
+        {
+            threads = (unsigned)(workbook->num_dirty / CELLS_PER_THREAD);
+        }
+        status = RunLevels(&run, 0 == threads ? 1 : threads);
+    }
+
+    free(run.order);
+    free(run.level_start);
+    free(run.claims);
+    if(SUCCESS != status)
+    {
+        return status;
+    }
+
+    for( ; i < workbook->num_dirty; ++i)
+    {
+        if(NO_LEVEL == workbook->cells[workbook->dirty[i]].level)
+        {
+            workbook->cells[workbook->dirty[i]].status = CYCLIC_REFERENCE;
+        }
+        workbook->cells[workbook->dirty[i]].dirty = 0;
+    }
+    workbook->num_dirty = 0;
+
+    return workbook->has_cycle ? CYCLIC_REFERENCE : SUCCESS;
+}
+
+status_t CalcWorkbookGet(const calc_workbook_t* workbook, const char* name,
+                                                                double* ans)
+{
+    size_t index = 0;
+
+    assert(workbook);
+    assert(name);
+    assert(ans);
+
+    index = FindCell(workbook, name);
+    if(NO_CELL == index)
+    {
+        return INVALID_SYNTAX;
+    }
+
+    *ans = workbook->cells[index].value;
+
+    return workbook->cells[index].status;
+}
@@ -1,6 +1,16 @@
+#include <string.h> /* strcmp, strlen, memcpy, memset, strcpy, strcat */
+#include <stdlib.h> /* malloc, free, strtod */
+#include <stdio.h>  /* sprintf, fopen, fseek, fputc, remove, tmpfile, fputs,
+                       fread, rewind */
+#include <locale.h> /* setlocale */
+
 #include "test_macros.h"
 
 #include "calculator.h"
+#include "calc_cache.h"
+#include "calc_workbook.h"
+#include "calc_library.h"
+#include "calc_csv.h"
 
 #define ERROR_EPSILON (0.005)
 
@@ -86,11 +96,1174 @@ static void TestCalculator(void)
 	status = Calculate("-5 ^ 2", &result);
 	TEST("Status success", status, SUCCESS);
 	TEST("Correct result", IsMatch(result, -25), 1);
+	status = Calculate("2 ^ 10", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 1024), 1);
+	status = Calculate("9 ^ 0.5", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 3), 1);
+	status = Calculate("0.5 ^ -3", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 8), 1);
+	status = Calculate("(0 - 1) ^ 1000000001", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -1), 1);
+	status = Calculate("2 ^ 0", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 1), 1);
+	status = Calculate("2 ^ 1000000000", &result);
+	TEST("Status overflow", status, MATH_ERROR);
+	status = Calculate("2 ^ -2000", &result);
+	TEST("Status underflow", status, MATH_ERROR);
+	status = Calculate("2 ^ 1e400", &result);
+	TEST("Infinite exponent overflow", status, MATH_ERROR);
+	status = Calculate("1 ^ 2e310", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 1), 1);
+	status = Calculate("2 ^ -1e400", &result);
+	TEST("Infinite exponent underflow", status, MATH_ERROR);
+	status = Calculate("0 ^ -1e400", &result);
+	TEST("Status domain error", status, MATH_ERROR);
+	status = Calculate("(0 - 1) ^ 1e300", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 1), 1);
+	status = Calculate("(0 - 8) ^ 0.5", &result);
+	TEST("Status domain error", status, MATH_ERROR);
+	status = Calculate("5)+3", &result);
+	TEST("Status success", status, INVALID_SYNTAX);
+	status = Calculate("x + 1", &result);
+	TEST("Status success", status, INVALID_SYNTAX);
+}
+
+typedef struct arena
+{
+	char buffer[16384];
+	size_t used;
+} arena_t;
+
+static void* ArenaAlloc(size_t size, void* param)
+{
+	arena_t* arena = (arena_t*)param;
+	void* ptr = NULL;
+
+	size = (size + 15) & ~(size_t)15;
+	if(arena->used + size > sizeof(arena->buffer))
+	{
+		return NULL;
+	}
+
+	ptr = arena->buffer + arena->used;
+	arena->used += size;
+
+	return ptr;
+}
+
+static void ArenaFree(void* ptr, void* param)
+{
+	(void)ptr;
+	(void)param;
+}
+
+/* the expression is copied to the end of a heap block, so reading past len
+   is caught by memory checkers */
+static status_t CalculateSlice(const char* str, double* ans)
+{
+	size_t len = strlen(str);
+	char* slice = (char*)malloc(len + 1);
+	status_t status = SUCCESS;
+
+	memcpy(slice + 1, str, len);
+	status = CalculateN(slice + 1, len, ans);
+	free(slice);
+
+	return status;
+}
+
+static void TestLength(void)
+{
+	const char* buffer = "12+34*(2-1)";
+	status_t status = SUCCESS;
+	double result = 0;
+
+	status = CalculateN(buffer, 4, &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 15), 1);
+	status = CalculateN(buffer, 5, &result);
+	TEST("Correct result", IsMatch(result, 46), 1);
+	status = CalculateN(buffer, 6, &result);
+	TEST("Status syntax error", status, INVALID_SYNTAX);
+	status = CalculateN(buffer + 3, 8, &result);
+	TEST("Correct result", IsMatch(result, 34), 1);
+	status = CalculateN("2*3e5", 3, &result);
+	TEST("Correct result", IsMatch(result, 6), 1);
+	status = CalculateN("1+2\0+3", 6, &result);
+	TEST("NUL inside the slice", status, INVALID_SYNTAX);
+
+	status = CalculateSlice(" 1.5e+2 + 2.5  ", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 152.5), 1);
+	status = CalculateSlice("3 * 1.25e", &result);
+	TEST("Status syntax error", status, INVALID_SYNTAX);
+	status = CalculateSlice("2 * 000000000000000000000000000000000000000000000"
+						"000000000000000000000000000000000000003.5", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 7), 1);
+	status = CalculateSlice("2 ^ 10", &result);
+	TEST("Correct result", IsMatch(result, 1024), 1);
+	status = CalculateSlice("   ", &result);
+	TEST("Status syntax error", status, INVALID_SYNTAX);
+	status = CalculateN("", 0, &result);
+	TEST("Status syntax error", status, INVALID_SYNTAX);
+}
+
+static void TestBlocks(void)
+{
+	static const char padding[] = " \t  \n \v\f\r ";
+	char expr[256];
+	calc_program_t* program = NULL;
+	status_t status = SUCCESS;
+	double result = 0;
+	size_t pad = 0;
+	size_t i = 0;
+	int ok = 1;
+
+	/* every token lands on every offset of the lexer's 64-byte blocks */
+	for( ; pad < 80 && ok; ++pad)
+	{
+		for(i = 0; i < pad; ++i)
+		{
+			expr[i] = padding[i % (sizeof(padding) - 1)];
+		}
+		strcpy(expr + pad, "1234567 + 0.5 *\t2\v- 8\f\r\n");
+		status = CalculateSlice(expr, &result);
+		ok = SUCCESS == status && IsMatch(result, 1234560);
+
+		strcpy(expr + pad, "(long_variable_name_1 * 2)  ");
+		status = CalcCompile(expr, &program);
+		ok = ok && SUCCESS == status &&
+				SUCCESS == CalcSetVariable(program, "long_variable_name_1", 3) &&
+				SUCCESS == CalcEval(program, &result) && IsMatch(result, 6);
+		CalcProgramDestroy(program);
+
+		strcpy(expr + pad, "long_variable_name.b + 1");
+		ok = ok && INVALID_SYNTAX == CalcCompile(expr, &program);
+	}
+	TEST("Tokens across blocks", ok, 1);
+
+	strcpy(expr, "1");
+	for(i = 1; i < 120; ++i)
+	{
+		strcat(expr, "+1");
+	}
+	status = Calculate(expr, &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("More tokens than a block", IsMatch(result, 120), 1);
+
+	status = Calculate("1 +\xA0" "2", &result);
+	TEST("Only C locale whitespace", status, INVALID_SYNTAX);
+	status = Calculate("2 . 5", &result);
+	TEST("Lone point", status, INVALID_SYNTAX);
+	status = CalcCompile("a.b+1", &program);
+	TEST("Point in a name", status, INVALID_SYNTAX);
+	TEST("Point in a name", CalcValidate("a.b+1", 5), 1);
+	status = Calculate("12345678901234567890 - 12345678901234567000", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 0), 1);
+}
+
+static int IsSameAsStrtod(const char* str)
+{
+	double expected = strtod(str, NULL);
+	double result = 0;
+
+	return SUCCESS == Calculate(str, &result) &&
+						0 == memcmp(&expected, &result, sizeof(double));
+}
+
+static unsigned long NextRandom(unsigned long* state)
+{
+	*state ^= (*state << 13) & 0xFFFFFFFFUL;
+	*state ^= *state >> 17;
+	*state ^= (*state << 5) & 0xFFFFFFFFUL;
+
+	return *state;
+}
+
+static void TestNumbers(void)
+{
+	static const char* hard[] = {"2.2250738585072011e-308",
+		"2.2250738585072012e-308", "4.9406564584124654e-324",
+		"2.4703282292062327e-324", "2.4703282292062328e-324",
+		"1.7976931348623157e308", "1.7976931348623158e308", "1e400", "1e-400",
+		"9007199254740993", "9007199254740992.5", "1e23", "0.1", "1e-3",
+		"7.2057594037927933e16", "8.98846567431158e307", "00012.50e+01",
+		"1.00000000000000011102230246251565404236316680908203125",
+		"1.00000000000000011102230246251565404236316680908203126",
+		"123456789012345678901234567890", "9999999999999999999999999999e-20",
+		"0.000000000000000000000000000000000000000000000000000000000001",
+		"1e99999999999999999999", "1.", ".5"};
+	char number[128];
+	unsigned long state = 1;
+	double result = 0;
+	size_t i = 0;
+	size_t len = 0;
+	size_t digits = 0;
+	int mismatches = 0;
+
+	for( ; i < sizeof(hard) / sizeof(hard[0]); ++i)
+	{
+		mismatches += !IsSameAsStrtod(hard[i]);
+	}
+	TEST("Hard numbers match strtod", mismatches, 0);
+
+	/* random digits, point and exponent, differential against strtod */
+	for(i = 0, mismatches = 0; i < 20000; ++i)
+	{
+		digits = 2 + NextRandom(&state) % 40;
+		for(len = 0; len < digits; ++len)
+		{
+			number[len] = (char)('0' + NextRandom(&state) % 10);
+		}
+		number[NextRandom(&state) % digits] = '.';
+		len += sprintf(number + len, "e%d",
+									(int)(NextRandom(&state) % 700) - 350);
+		mismatches += !IsSameAsStrtod(number);
+	}
+	TEST("Random numbers match strtod", mismatches, 0);
+
+	TEST("Exponent needs digits", Calculate("2e", &result), INVALID_SYNTAX);
+	TEST("No hexadecimal", Calculate("0x10", &result), INVALID_SYNTAX);
+
+	/* the decimal point does not follow the locale */
+	if(NULL != setlocale(LC_NUMERIC, "de_DE.UTF-8"))
+	{
+		TEST("Locale independent", Calculate("2.5", &result), SUCCESS);
+		TEST("Correct result", IsMatch(result, 2.5), 1);
+		setlocale(LC_NUMERIC, "C");
+	}
+}
+
+static void TestContext(void)
+{
+	static arena_t arena;
+	calc_allocator_t allocator;
+	calc_alloc_counters_t counters;
+	calc_ctx_t* ctx = NULL;
+	status_t status = SUCCESS;
+	double result;
+	char long_expr[301];
+	size_t i = 0;
+
+	allocator.alloc = ArenaAlloc;
+	allocator.free = ArenaFree;
+	allocator.param = &arena;
+	ctx = CalcCtxCreate(&allocator);
+	TEST("Context created", ctx != NULL, 1);
+
+	status = CalculateCtx(ctx, "4 * 5 / (4 - 5)", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -20), 1);
+	CalcCtxGetAllocCounters(ctx, &counters);
+	TEST("Warm-up allocations", counters.allocations, 2);
+
+	status = CalculateCtx(ctx, "(6 + 7) ^ 2", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 169), 1);
+	status = CalculateCtx(ctx, "0/0", &result);
+	TEST("Status math error", status, MATH_ERROR);
+	status = CalculateCtx(ctx, "(5 + ) * 2", &result);
+	TEST("Status syntax error", status, INVALID_SYNTAX);
+	status = CalculateCtx(ctx, "2 + 3", &result);
+	TEST("Correct result", IsMatch(result, 5), 1);
+	CalcCtxGetAllocCounters(ctx, &counters);
+	TEST("No steady state allocations", counters.allocations, 2);
+
+	for( ; i < 300; i += 2)
+	{
+		long_expr[i] = '1';
+		long_expr[i + 1] = '+';
+	}
+	long_expr[299] = '\0';
+	status = CalculateCtx(ctx, long_expr, &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 150), 1);
+	CalcCtxGetAllocCounters(ctx, &counters);
+	TEST("Grew once", counters.allocations, 3);
+	TEST("Released old stacks", counters.frees, 1);
+
+	CalcCtxDestroy(ctx);
+}
+
+static void TestStats(void)
+{
+	calc_ctx_t* ctx = CalcCtxCreate(NULL);
+	calc_stats_t stats;
+	double result = 0;
+	size_t calls = 0;
+	size_t i = 0;
+	int enabled = 0;
+
+	CalculateCtx(ctx, "  2 * (3 + 4)  ^ 2", &result);
+	TEST("Correct result", IsMatch(result, 98), 1);
+	CalculateCtx(ctx, "-1", &result);
+	CalculateCtx(ctx, "1 +", &result);
+	enabled = CalcGetStats(ctx, &stats);
+
+	for( ; i < CALC_LATENCY_BUCKETS; ++i)
+	{
+		calls += stats.latency[i];
+	}
+
+	if(enabled)
+	{
+		TEST("Calls", stats.calls, 3);
+		TEST("Tokens", stats.tokens, 9 + 2 + 2);
+		TEST("Numbers", stats.numbers, 4 + 1 + 1);
+		TEST("Additions", stats.operators[CALC_ADD], 1);
+		TEST("Multiplications", stats.operators[CALC_MUL], 1);
+		TEST("Powers", stats.operators[CALC_POW], 1);
+		TEST("Negations", stats.operators[CALC_NEG], 1);
+		TEST("No divisions", stats.operators[CALC_DIV], 0);
+		TEST("Numbers depth", stats.max_numbers_depth, 3);
+		TEST("Operators depth", stats.max_operators_depth, 3);
+		TEST("Whitespace", stats.whitespace_bytes, 9 + 1);
+		TEST("Every call timed", calls, 3);
+	}
+	else
+	{
+		TEST("Compiled out", stats.calls + stats.tokens + calls, 0);
+	}
+
+	TEST("First buckets", CalcLatencyBucketFloor(3), 3);
+	TEST("Log-linear bucket", CalcLatencyBucketFloor(9), 10);
+	TEST("Log-linear bucket", CalcLatencyBucketFloor(12), 16);
+	for(i = 1; i < CALC_LATENCY_BUCKETS; ++i)
+	{
+		TEST("Buckets grow", CalcLatencyBucketFloor(i) >
+										CalcLatencyBucketFloor(i - 1), 1);
+	}
+
+	CalcCtxDestroy(ctx);
+}
+
+static void TestBatch(void)
+{
+	static const char* exprs[] = {"2 + 3", "0/0", "(5 + ) * 2", "-5 ^ 2",
+								  "4 * 5 / (4 - 5)", "200-100+50.5", "x"};
+	const size_t n = sizeof(exprs) / sizeof(exprs[0]);
+	double results[1000];
+	status_t statuses[1000];
+	const char* many[1000];
+	double expected = 0;
+	size_t mismatches = 0;
+	size_t i = 0;
+
+	TEST("Batch success", CalculateBatch(exprs, n, results, statuses, 3),
+																	SUCCESS);
+	TEST("Batch status", statuses[0], SUCCESS);
+	TEST("Batch result", IsMatch(results[0], 5), 1);
+	TEST("Batch status", statuses[1], MATH_ERROR);
+	TEST("Batch status", statuses[2], INVALID_SYNTAX);
+	TEST("Batch result", IsMatch(results[3], -25), 1);
+	TEST("Batch result", IsMatch(results[4], -20), 1);
+	TEST("Batch result", IsMatch(results[5], 150.5), 1);
+	TEST("Batch status", statuses[6], INVALID_SYNTAX);
+
+	for( ; i < 1000; ++i)
+	{
+		many[i] = exprs[i % n];
+	}
+
+	TEST("Batch success", CalculateBatch(many, 1000, results, statuses, 0),
+																	SUCCESS);
+	for(i = 0; i < 1000; ++i)
+	{
+		mismatches += statuses[i] != Calculate(many[i], &expected) ||
+				(SUCCESS == statuses[i] && !IsMatch(results[i], expected));
+	}
+	TEST("Batch matches Calculate", mismatches, 0);
+	TEST("Empty batch", CalculateBatch(many, 0, results, statuses, 4), SUCCESS);
+}
+
+static void TestCache(void)
+{
+	calc_cache_t* cache = CalcCacheCreate(16);
+	calc_cache_stats_t stats;
+	status_t status = SUCCESS;
+	double result = 0;
+	char expr[16];
+	int i = 0;
+
+	TEST("Cache created", cache != NULL, 1);
+
+	status = CalculateCached(cache, "4 * 5 / (4 - 5)", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -20), 1);
+	status = CalculateCached(cache, "4*5/(4-5)", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -20), 1);
+	status = CalculateCached(cache, "	4 *5/ ( 4 -5 )  ", &result);
+	TEST("Correct result", IsMatch(result, -20), 1);
+	status = CalculateCached(cache, "0/0", &result);
+	TEST("Status math error", status, MATH_ERROR);
+	status = CalculateCached(cache, "0 / 0", &result);
+	TEST("Cached math error", status, MATH_ERROR);
+	status = CalculateCached(cache, "1 2", &result);
+	TEST("Status syntax error", status, INVALID_SYNTAX);
+	status = CalculateCached(cache, "12", &result);
+	TEST("Whitespace between digits kept", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 12), 1);
+	/* a separate key, whatever the locale calls a space */
+	status = CalculateCached(cache, "1 +2", &result);
+	TEST("Status success", status, SUCCESS);
+	status = CalculateCached(cache, "1 +\xA0" "2", &result);
+	TEST("Only C locale whitespace", status, INVALID_SYNTAX);
+	status = CalculateCached(cache, "1e+1", &result);
+	TEST("Correct result", IsMatch(result, 10), 1);
+	status = CalculateCached(cache, "1e +1", &result);
+	TEST("Exponent sign spacing kept", status, Calculate("1e +1", &result));
+	status = CalculateCached(cache, "1 2", &result);
+	TEST("Cached syntax error", status, INVALID_SYNTAX);
+
+	CalcCacheGetStats(cache, &stats);
+	TEST("Cache hits", stats.hits, 4);
+	TEST("Cache misses", stats.misses, 8);
+	TEST("No evictions", stats.evictions, 0);
+
+	for( ; i < 100; ++i)
+	{
+		sprintf(expr, "%d + 1", i);
+		CalculateCached(cache, expr, &result);
+	}
+	status = CalculateCached(cache, "99+1", &result);
+	TEST("Correct result", IsMatch(result, 100), 1);
+	CalcCacheGetStats(cache, &stats);
+	TEST("Bounded with evictions", stats.evictions >= 100 - 16, 1);
+
+	CalcCacheDestroy(cache);
+}
+
+static status_t CompileOptimized(const char* str, calc_program_t** program,
+												calc_opt_report_t* report)
+{
+	status_t status = CalcCompile(str, program);
+
+	return SUCCESS == status ? CalcOptimize(*program, report) : status;
+}
+
+static void TestOptimize(void)
+{
+	static const char* exprs[] = {"(x*1)+0", "2*3+x", "(x+y)*(y+x)-(x+y)",
+				"x^2+y^3-x^4", "--x-(-y)", "-x+y", "x^1/1", "(x-0)*(1*y)",
+				"x^2^2", "2^0.5*x", "(x*y)^3", "1/0+x", "x/(y-y)"};
+	static const double values[] = {3, -2, 0.5, 0, 1e200, -1e-200};
+	calc_program_t* program = NULL;
+	calc_program_t* optimized = NULL;
+	calc_opt_report_t report;
+	status_t status = SUCCESS;
+	double result = 0;
+	double expected = 0;
+	size_t i = 0;
+	size_t x = 0;
+	size_t y = 0;
+	int mismatches = 0;
+
+	status = CompileOptimized("(x*1)+0", &program, &report);
+	TEST("Optimize success", status, SUCCESS);
+	TEST("Instructions before", report.instructions_before, 5);
+	TEST("Identities removed", report.simplified, 4);
+	TEST("Instructions after", report.instructions_after, 1);
+	CalcSetVariable(program, "x", 7);
+	CalcEval(program, &result);
+	TEST("Correct result", IsMatch(result, 7), 1);
+	CalcProgramDestroy(program);
+
+	CompileOptimized("2*3^2+x", &program, &report);
+	TEST("Constants folded", report.folded, 4);
+	TEST("Instructions after", report.instructions_after, 3);
+	CalcSetVariable(program, "x", 1);
+	CalcEval(program, &result);
+	TEST("Correct result", IsMatch(result, 19), 1);
+	CalcProgramDestroy(program);
+
+	CompileOptimized("(a+b)*(b+a)", &program, &report);
+	TEST("Common subexpression shared", report.shared, 2);
+	TEST("Instructions after", report.instructions_after, 5);
+	CalcSetVariable(program, "a", 1);
+	CalcSetVariable(program, "b", 2);
+	CalcEval(program, &result);
+	TEST("Correct result", IsMatch(result, 9), 1);
+	TEST("Optimize again", CalcOptimize(program, &report), SUCCESS);
+	TEST("Nothing left to remove", report.instructions_after, 5);
+	CalcEval(program, &result);
+	TEST("Correct result", IsMatch(result, 9), 1);
+	CalcProgramDestroy(program);
+
+	CompileOptimized("---z", &program, &report);
+	TEST("Negations removed", report.simplified, 2);
+	CalcProgramDestroy(program);
+
+	CompileOptimized("1/0", &program, &report);
+	TEST("Failing operator kept", report.folded, 0);
+	TEST("Eval math error", CalcEval(program, &result), MATH_ERROR);
+	CalcProgramDestroy(program);
+
+	/* optimized programs agree with unoptimized ones on results and errors,
+	   including overflow and underflow of reduced powers */
+	for(i = 0; i < sizeof(exprs) / sizeof(exprs[0]); ++i)
+	{
+		CalcCompile(exprs[i], &program);
+		CompileOptimized(exprs[i], &optimized, NULL);
+
+		for(x = 0; x < sizeof(values) / sizeof(values[0]); ++x)
+		{
+			for(y = 0; y < sizeof(values) / sizeof(values[0]); ++y)
+			{
+				CalcSetVariable(program, "x", values[x]);
+				CalcSetVariable(program, "y", values[y]);
+				CalcSetVariable(optimized, "x", values[x]);
+				CalcSetVariable(optimized, "y", values[y]);
+				status = CalcEval(program, &expected);
+				if(status != CalcEval(optimized, &result) ||
+					(SUCCESS == status && result != expected))
+				{
+					++mismatches;
+				}
+			}
+		}
+
+		CalcProgramDestroy(program);
+		CalcProgramDestroy(optimized);
+	}
+	TEST("Optimized programs agree", mismatches, 0);
+}
+
+static void TestCompile(void)
+{
+	status_t status = SUCCESS;
+	calc_program_t* program = NULL;
+	double result;
+
+	status = CalcCompile("4 * 5 / (4 - 5)", &program);
+	TEST("Compile success", status, SUCCESS);
+	status = CalcEval(program, &result);
+	TEST("Eval success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -20), 1);
+	CalcProgramDestroy(program);
+
+	status = CalcCompile("-5 ^ 2 + --3", &program);
+	TEST("Compile success", status, SUCCESS);
+	status = CalcEval(program, &result);
+	TEST("Eval success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -22), 1);
+	CalcProgramDestroy(program);
+
+	status = CalcCompile("4 * 5 // 4", &program);
+	TEST("Compile syntax error", status, INVALID_SYNTAX);
+	TEST("No program", program == NULL, 1);
+	status = CalcCompile("(5 + 3", &program);
+	TEST("Compile syntax error", status, INVALID_SYNTAX);
+	status = CalcCompile("x y", &program);
+	TEST("Compile syntax error", status, INVALID_SYNTAX);
+
+	status = CalcCompile("price * qty_2 - price / x", &program);
+	TEST("Compile success", status, SUCCESS);
+	TEST("Variable count", CalcVariableCount(program), 3);
+	TEST("Variable name", strcmp(CalcVariableName(program, 1), "qty_2"), 0);
+	TEST("Set variable", CalcSetVariable(program, "price", 10), SUCCESS);
+	TEST("Set variable", CalcSetVariable(program, "qty_2", 3), SUCCESS);
+	TEST("Set variable", CalcSetVariable(program, "x", 4), SUCCESS);
+	TEST("Unknown variable", CalcSetVariable(program, "qty", 1), INVALID_SYNTAX);
+	status = CalcEval(program, &result);
+	TEST("Eval success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 27.5), 1);
+	CalcSetVariable(program, "x", 0);
+	status = CalcEval(program, &result);
+	TEST("Eval math error", status, MATH_ERROR);
+	CalcProgramDestroy(program);
+}
+
+static void TestIncremental(void)
+{
+	calc_program_t* program = NULL;
+	status_t status = SUCCESS;
+	double result = 0;
+
+	status = CalcCompile("a * b + c / (a - 1) + a * b", &program);
+	TEST("Compile success", status, SUCCESS);
+	CalcSetVariable(program, "a", 3);
+	CalcSetVariable(program, "b", 4);
+	CalcSetVariable(program, "c", 10);
+	status = CalcEvalIncremental(program, &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 29), 1);
+
+	CalcSetVariable(program, "c", 2);
+	status = CalcEvalIncremental(program, &result);
+	TEST("Only c changed", IsMatch(result, 25), 1);
+	status = CalcEvalIncremental(program, &result);
+	TEST("Nothing changed", IsMatch(result, 25), 1);
+
+	CalcSetVariable(program, "a", 1);
+	status = CalcEvalIncremental(program, &result);
+	TEST("Division by zero", status, MATH_ERROR);
+	TEST("Same as eval", CalcEval(program, &result), MATH_ERROR);
+	CalcSetVariableIndex(program, 0, 2);
+	status = CalcEvalIncremental(program, &result);
+	TEST("Recovered", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 18), 1);
+	TEST("No such variable", CalcSetVariableIndex(program, 3, 1),
+														INVALID_SYNTAX);
+
+	status = CalcOptimize(program, NULL);
+	TEST("Optimize success", status, SUCCESS);
+	CalcSetVariable(program, "b", 5);
+	status = CalcEvalIncremental(program, &result);
+	TEST("Rebuilt after optimize", IsMatch(result, 22), 1);
+	CalcProgramDestroy(program);
+}
+
+static void TestJit(void)
+{
+	calc_program_t* program = NULL;
+	calc_eval_func_t eval = NULL;
+	status_t status = SUCCESS;
+	double result = 0;
+	double expected = 0;
+	char expr[256];
+	size_t len = 0;
+	int i = 0;
+
+	CalcCompile("-a * b + c / (a - 1) - 2 ^ a", &program);
+	eval = CalcJit(program);
+	TEST("Same function again", CalcJit(program) == eval, 1);
+	CalcSetVariable(program, "a", 3);
+	CalcSetVariable(program, "b", 4);
+	CalcSetVariable(program, "c", 10);
+	status = eval(program, &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, -15), 1);
+	CalcSetVariable(program, "a", 1);
+	TEST("Division by zero", eval(program, &result), MATH_ERROR);
+	CalcSetVariable(program, "a", -2000);
+	TEST("Power underflow", eval(program, &result), MATH_ERROR);
+	CalcSetVariable(program, "a", 1e308 * 10);
+	TEST("Infinite exponent", eval(program, &result), MATH_ERROR);
+	TEST("Same as eval", CalcEval(program, &result), MATH_ERROR);
+	CalcProgramDestroy(program);
+
+	CalcCompile("x ^ 3 + (x + 1) ^ 2 * (x + 1)", &program);
+	CalcOptimize(program, NULL);
+	eval = CalcJit(program);
+	CalcSetVariable(program, "x", 1e200);
+	TEST("Multiplication overflow", eval(program, &result), MATH_ERROR);
+	CalcSetVariable(program, "x", 2);
+	TEST("Status success", eval(program, &result), SUCCESS);
+	TEST("Correct result", IsMatch(result, 35), 1);
+	CalcProgramDestroy(program);
+
+	/* deeper than the registers the values stack is kept in */
+	for(i = 1; i <= 20; ++i)
+	{
+		len += sprintf(expr + len, "%d-(", i);
+	}
+	len += sprintf(expr + len, "y^2/y");
+	for(i = 1; i <= 20; ++i)
+	{
+		expr[len++] = ')';
+	}
+	expr[len] = '\0';
+	CalcCompile(expr, &program);
+	eval = CalcJit(program);
+	CalcSetVariable(program, "y", 3);
+	CalcEval(program, &expected);
+	TEST("Status success", eval(program, &result), SUCCESS);
+	TEST("Same as eval", IsMatch(result, expected), 1);
+	CalcSetVariable(program, "y", 0);
+	TEST("Division by zero", eval(program, &result), MATH_ERROR);
+	CalcProgramDestroy(program);
+}
+
+static void TestWorkbook(void)
+{
+	calc_workbook_t* workbook = CalcWorkbookCreate();
+	status_t status = SUCCESS;
+	double result = 0;
+	char name[16];
+	char expr[32];
+	int i = 0;
+
+	TEST("Workbook created", workbook != NULL, 1);
+	status = CalcWorkbookSet(workbook, "margin", "revenue - cost");
+	TEST("Forward references", status, SUCCESS);
+	CalcWorkbookSetValue(workbook, "revenue", 120);
+	CalcWorkbookSetValue(workbook, "cost", 80);
+	CalcWorkbookSet(workbook, "ratio", "margin / revenue");
+	TEST("Bad formula", CalcWorkbookSet(workbook, "ratio", "margin /"),
+														INVALID_SYNTAX);
+	status = CalcWorkbookEvaluate(workbook, 2);
+	TEST("Evaluate success", status, SUCCESS);
+	CalcWorkbookGet(workbook, "margin", &result);
+	TEST("Correct result", IsMatch(result, 40), 1);
+	status = CalcWorkbookGet(workbook, "ratio", &result);
+	TEST("Bad formula kept the old one", status, SUCCESS);
+	TEST("Correct result", IsMatch(result, 40.0 / 120), 1);
+
+	CalcWorkbookSetValue(workbook, "cost", 120);
+	CalcWorkbookEvaluate(workbook, 2);
+	status = CalcWorkbookGet(workbook, "ratio", &result);
+	TEST("Recomputed downstream", IsMatch(result, 0), 1);
+	CalcWorkbookSetValue(workbook, "revenue", 0);
+	CalcWorkbookEvaluate(workbook, 2);
+	status = CalcWorkbookGet(workbook, "ratio", &result);
+	TEST("Math error", status, MATH_ERROR);
+	TEST("Undefined cell", CalcWorkbookGet(workbook, "tax", &result),
+														INVALID_SYNTAX);
+	CalcWorkbookSet(workbook, "net", "margin - tax");
+	CalcWorkbookEvaluate(workbook, 2);
+	TEST("Undefined reference", CalcWorkbookGet(workbook, "net", &result),
+														INVALID_SYNTAX);
+
+	CalcWorkbookSet(workbook, "a", "b + 1");
+	CalcWorkbookSet(workbook, "b", "c * 2");
+	CalcWorkbookSet(workbook, "c", "a - revenue");
+	CalcWorkbookSet(workbook, "d", "c + 1");
+	status = CalcWorkbookEvaluate(workbook, 2);
+	TEST("Cycle detected", status, CYCLIC_REFERENCE);
+	TEST("In the cycle", CalcWorkbookGet(workbook, "b", &result),
+														CYCLIC_REFERENCE);
+	TEST("After the cycle", CalcWorkbookGet(workbook, "d", &result),
+														CYCLIC_REFERENCE);
+	TEST("Outside the cycle", CalcWorkbookGet(workbook, "margin", &result),
+																	SUCCESS);
+	CalcWorkbookSet(workbook, "c", "revenue + 5");
+	status = CalcWorkbookEvaluate(workbook, 2);
+	TEST("Cycle broken", status, SUCCESS);
+	CalcWorkbookGet(workbook, "a", &result);
+	TEST("Correct result", IsMatch(result, 11), 1);
+
+	/* a chain as long as the sheet, and a level of many independent cells */
+	CalcWorkbookSetValue(workbook, "x0", 1);
+	for(i = 1; i < 1000; ++i)
+	{
+		sprintf(name, "x%d", i);
+		sprintf(expr, "x%d + 1", i - 1);
+		CalcWorkbookSet(workbook, name, expr);
+		sprintf(name, "y%d", i);
+		sprintf(expr, "x0 * %d", i);
+		CalcWorkbookSet(workbook, name, expr);
+	}
+	status = CalcWorkbookEvaluate(workbook, 4);
+	TEST("Evaluate success", status, SUCCESS);
+	CalcWorkbookGet(workbook, "x999", &result);
+	TEST("Correct result", IsMatch(result, 1000), 1);
+	CalcWorkbookSetValue(workbook, "x0", 2);
+	CalcWorkbookEvaluate(workbook, 0);
+	CalcWorkbookGet(workbook, "x999", &result);
+	TEST("Correct result", IsMatch(result, 1001), 1);
+	CalcWorkbookGet(workbook, "y500", &result);
+	TEST("Correct result", IsMatch(result, 1000), 1);
+	CalcWorkbookDestroy(workbook);
+
+	/* formulas given to cells that already exist without one */
+	workbook = CalcWorkbookCreate();
+	CalcWorkbookSet(workbook, "x", "y + 1");
+	CalcWorkbookEvaluate(workbook, 2);
+	CalcWorkbookSet(workbook, "y", "x + 1");
+	status = CalcWorkbookEvaluate(workbook, 2);
+	TEST("Cycle through an undefined cell", status, CYCLIC_REFERENCE);
+	CalcWorkbookDestroy(workbook);
+
+	workbook = CalcWorkbookCreate();
+	CalcWorkbookSetValue(workbook, "p", 1);
+	CalcWorkbookSetValue(workbook, "q", 0);
+	CalcWorkbookSet(workbook, "r", "p + 1");
+	CalcWorkbookEvaluate(workbook, 2);
+	CalcWorkbookSet(workbook, "q", "r * 2");
+	CalcWorkbookSetValue(workbook, "p", 10);
+	status = CalcWorkbookEvaluate(workbook, 2);
+	TEST("Evaluate success", status, SUCCESS);
+	CalcWorkbookGet(workbook, "q", &result);
+	TEST("Value cell turned formula", IsMatch(result, 22), 1);
+	CalcWorkbookDestroy(workbook);
+}
+
+static void TestExact(void)
+{
+	calc_number_t result;
+	status_t status = SUCCESS;
+
+	status = CalculateExact("2^62 + 1 - 2^62", &result);
+	TEST("Status success", status, SUCCESS);
+	TEST("Integer result", result.is_integer, 1);
+	TEST("Exact past 2^53", result.integer, 1);
+	CalculateExact("9007199254740993 * 1", &result);
+	TEST("Exact literal", result.integer == 9007199254740993L, 1);
+	CalculateExact("(-2)^63", &result);
+	TEST("Smallest long", result.is_integer && result.integer < 0, 1);
+	TEST("Same real", IsMatch(result.real, -9223372036854775808.0), 1);
+	CalculateExact("84 / -7 - 1e2", &result);
+	TEST("Exact division", result.integer, -112);
+
+	CalculateExact("7 / 2 * 4", &result);
+	TEST("Remainder falls back", result.is_integer, 0);
+	TEST("Correct result", IsMatch(result.real, 14), 1);
+	CalculateExact("2^63 - 1", &result);
+	TEST("Overflow falls back", result.is_integer, 0);
+	TEST("Correct result", IsMatch(result.real, 9223372036854775807.0), 1);
+	CalculateExact("2^-1 + 1.5", &result);
+	TEST("Correct result", IsMatch(result.real, 2), 1);
+	TEST("Division by zero", CalculateExact("1 / (2 - 2)", &result),
+																MATH_ERROR);
+	TEST("Invalid syntax", CalculateExact("2 +* 3", &result),
+															INVALID_SYNTAX);
+}
+
+static void TestFunctions(void)
+{
+	calc_program_t* program = NULL;
+	calc_number_t number;
+	status_t statuses[3];
+	double x[3] = {4, -1, 100};
+	double y[3] = {1, 2, 3};
+	const double* columns[2];
+	double results[3];
+	double result = 0;
+
+	Calculate("sqrt(16) + max(1, 3, 2) - min(3, 1, 2)", &result);
+	TEST("Correct result", IsMatch(result, 6), 1);
+	Calculate("-exp(log(2)) ^ 2 + sin(0) * cos(0)", &result);
+	TEST("Correct result", IsMatch(result, -4), 1);
+	TEST("Too few arguments", Calculate("max(1)", &result), INVALID_SYNTAX);
+	TEST("Too many arguments", Calculate("sqrt(1, 2)", &result),
+															INVALID_SYNTAX);
+	TEST("No brackets", Calculate("sqrt 4", &result), INVALID_SYNTAX);
+	TEST("No argument", Calculate("sqrt()", &result), INVALID_SYNTAX);
+	TEST("Comma outside a call", Calculate("1, 2", &result), INVALID_SYNTAX);
+	TEST("Square root of negative", Calculate("sqrt(-1)", &result),
+																MATH_ERROR);
+	TEST("Log of zero", Calculate("log(0)", &result), MATH_ERROR);
+	TEST("Exp overflow", Calculate("exp(1000)", &result), MATH_ERROR);
+
+	CalculateExact("max(2^62, 3) + min(1, 2)", &number);
+	TEST("Exact min and max", number.is_integer &&
+								number.integer == 4611686018427387905L, 1);
+	CalculateExact("sqrt(4)", &number);
+	TEST("Other functions fall back", number.is_integer, 0);
+
+	CalcCompile("sqrt(x) * max(x, y)", &program);
+	TEST("Function names are not variables", CalcVariableCount(program), 2);
+	CalcSetVariable(program, "x", 4);
+	CalcSetVariable(program, "y", 1);
+	TEST("Eval success", CalcEval(program, &result), SUCCESS);
+	TEST("Correct result", IsMatch(result, 8), 1);
+	TEST("Jit success", CalcJit(program)(program, &result), SUCCESS);
+	TEST("Correct result", IsMatch(result, 8), 1);
+	CalcSetVariable(program, "x", -1);
+	TEST("Eval math error", CalcEval(program, &result), MATH_ERROR);
+	TEST("Jit math error", CalcJit(program)(program, &result), MATH_ERROR);
+
+	columns[0] = x;
+	columns[1] = y;
+	TEST("Columns math error", CalcEvalColumns(program, columns, 3, results,
+														statuses), MATH_ERROR);
+	TEST("Correct result", IsMatch(results[0], 8), 1);
+	TEST("Failed row", statuses[1], MATH_ERROR);
+	TEST("Correct result", IsMatch(results[2], 1000), 1);
+	TEST("Row success", statuses[2], SUCCESS);
+	CalcProgramDestroy(program);
+}
+
+static void TestValidate(void)
+{
+	const char* exprs[4] = {"max(1, 2)", "1 +", "x * (y - 1", "sin(x)"};
+	size_t lens[4] = {9, 3, 10, 3};
+	size_t offsets[4];
+	char deep[8192];
+	char* deeper = NULL;
+	size_t len = 0;
+	int i = 0;
+
+	TEST("Valid", CalcValidate("-2 ^ (3 + x) * sqrt(4)", 22), CALC_VALID);
+	TEST("Only the span", CalcValidate("5 * 2)", 5), CALC_VALID);
+	TEST("Unexpected token", CalcValidate("4 * 5 // 4", 10), 7);
+	TEST("Ends too early", CalcValidate("(5 + 3", 6), 6);
+	TEST("Empty", CalcValidate("", 0), 0);
+	TEST("Unmatched bracket", CalcValidate("1 + 2) * 3", 10), 5);
+	TEST("Too few arguments", CalcValidate("max(1)", 6), 5);
+	TEST("Comma in a unary call", CalcValidate("sqrt(1, 2)", 10), 6);
+	TEST("Comma in brackets", CalcValidate("(1, 2)", 6), 2);
+	TEST("No call", CalcValidate("cos + 1", 7), 4);
+	TEST("Bad character", CalcValidate("1 + 2 $", 7), 6);
+	TEST("NUL in the span", CalcValidate("1 +\0 2", 6), 3);
+
+	TEST("Invalid count", CalcValidateBatch(exprs, NULL, 4, offsets), 2);
+	TEST("Valid", offsets[0], CALC_VALID);
+	TEST("Ends too early", offsets[1], 3);
+	TEST("Ends too early", offsets[2], 10);
+	TEST("With lengths", CalcValidateBatch(exprs, lens, 4, offsets), 3);
+	TEST("Ends too early", offsets[3], 3);
+
+	/* deeper than the brackets kept */
+	for(i = 0; i < 1500; ++i)
+	{
+		len += sprintf(deep + len, i % 2 ? "(" : "max(1,");
+	}
+	deep[len++] = '1';
+	for(i = 0; i < 1500; ++i)
+	{
+		deep[len++] = ')';
+	}
+	TEST("Deep valid", CalcValidate(deep, len), CALC_VALID);
+	deep[len - 1500 + 100] = ',';
+	TEST("Comma in deep brackets", CalcValidate(deep, len), len - 1400);
+
+	/* as deep as it takes, and one bracket too deep */
+	deeper = (char*)malloc(2 * CALC_VALIDATE_MAX_DEPTH + 3);
+	memset(deeper, '(', CALC_VALIDATE_MAX_DEPTH + 1);
+	deeper[CALC_VALIDATE_MAX_DEPTH + 1] = '1';
+	memset(deeper + CALC_VALIDATE_MAX_DEPTH + 2, ')',
+												CALC_VALIDATE_MAX_DEPTH + 1);
+	TEST("Deepest valid", CalcValidate(deeper + 1, 2 * CALC_VALIDATE_MAX_DEPTH
+													+ 1), CALC_VALID);
+	TEST("Too deep", CalcValidate(deeper, 2 * CALC_VALIDATE_MAX_DEPTH + 3),
+												CALC_VALIDATE_MAX_DEPTH);
+	free(deeper);
+}
+
+static void TestLibrary(void)
+{
+	const char* path = "/tmp/test_calculator.calclib";
+	calc_library_builder_t* builder = CalcLibraryBuilderCreate();
+	calc_library_t* library = NULL;
+	double vars[2] = {10, 4};
+	double result = 0;
+	size_t index = 0;
+	FILE* file = NULL;
+
+	TEST("Add success", CalcLibraryBuilderAdd(builder, "margin",
+										"revenue - cost"), SUCCESS);
+	TEST("Add success", CalcLibraryBuilderAdd(builder, "area",
+										"3 * r ^ 2"), SUCCESS);
+	TEST("Add invalid", CalcLibraryBuilderAdd(builder, "bad", "1 +"),
+															INVALID_SYNTAX);
+	TEST("Replace success", CalcLibraryBuilderAdd(builder, "margin",
+							"(revenue - cost) / revenue"), SUCCESS);
+	TEST("Write success", CalcLibraryBuilderWrite(builder, path), SUCCESS);
+	CalcLibraryBuilderDestroy(builder);
+
+	TEST("Open success", CalcLibraryOpen(path, &library), SUCCESS);
+	TEST("Replaced once", CalcLibraryCount(library), 2);
+	TEST("Sorted by name", strcmp(CalcLibraryName(library, 0), "area"), 0);
+	TEST("Missing name", CalcLibraryFind(library, "bad"), 2);
+	index = CalcLibraryFind(library, "margin");
+	TEST("Found", index, 1);
+	TEST("Variables", CalcLibraryVariableCount(library, index), 2);
+	TEST("Variable name", strcmp(CalcLibraryVariableName(library, index, 1),
+																"cost"), 0);
+	TEST("Eval success", CalcLibraryEval(library, index, vars, &result),
+																	SUCCESS);
+	TEST("Correct result", IsMatch(result, 0.6), 1);
+	vars[0] = 0;
+	TEST("Eval math error", CalcLibraryEval(library, index, vars, &result),
+																MATH_ERROR);
+	CalcLibraryClose(library);
+
+	/* a flipped byte past the header fails the checksum */
+	file = fopen(path, "r+b");
+	fseek(file, 100, SEEK_SET);
+	fputc(0x55, file);
+	fclose(file);
+	TEST("Corrupted", CalcLibraryOpen(path, &library), INVALID_LIBRARY);
+	TEST("No library", library == NULL, 1);
+	remove(path);
+	TEST("Missing file", CalcLibraryOpen(path, &library), INVALID_LIBRARY);
+}
+
+static void TestCsv(void)
+{
+	const char* rows = "id,price, qty ,discount\n"
+						"1,10,3,0.1\n"
+						"2,\"2.5\",4,-0.5\n"
+						"\n"
+						"3,x,1,0\r\n"
+						"4,1e2,2\n"
+						"5,-0.25,\"1\",0";
+	const char* expected = "id,price, qty ,discount,total\n"
+						"1,10,3,0.1,27\n"
+						"2,\"2.5\",4,-0.5,15\n"
+						"3,x,1,0,nan\n"
+						"4,1e2,2,nan\n"
+						"5,-0.25,\"1\",0,-0.25\n";
+	calc_program_t* program = NULL;
+	calc_csv_options_t options;
+	calc_csv_report_t report;
+	FILE* input = tmpfile();
+	FILE* output = tmpfile();
+	char text[256];
+	size_t len = 0;
+
+	fputs(rows, input);
+	memset(&options, 0, sizeof(options));
+	options.result_name = "total";
+	options.chunk_rows = 2;
+
+	CalcCompile("price * qty * (1 - discount)", &program);
+	rewind(input);
+	TEST("Failed rows", CalcEvalCsv(program, input, output, &options,
+														&report), MATH_ERROR);
+	TEST("Rows", report.rows, 5);
+	TEST("Failed rows", report.failed_rows, 2);
+	rewind(output);
+	len = fread(text, 1, sizeof(text) - 1, output);
+	text[len] = '\0';
+	TEST("Appended column", strcmp(text, expected), 0);
+	CalcProgramDestroy(program);
+
+	fclose(input);
+	fclose(output);
+	input = tmpfile();
+	output = tmpfile();
+	fputs("1;3\n4;2\n0;1\n", input);
+
+	CalcCompile("c2 / c1", &program);
+	options.no_header = 1;
+	options.only_result = 1;
+	options.delimiter = ';';
+	rewind(input);
+	TEST("Column numbers", CalcEvalCsv(program, input, output, &options,
+														&report), MATH_ERROR);
+	rewind(output);
+	len = fread(text, 1, sizeof(text) - 1, output);
+	text[len] = '\0';
+	TEST("Result column", strcmp(text, "3\n0.5\nnan\n"), 0);
+	CalcProgramDestroy(program);
+
+	CalcCompile("price * volume", &program);
+	rewind(input);
+	TEST("No column", CalcEvalCsv(program, input, output, NULL, NULL),
+															INVALID_SYNTAX);
+	CalcProgramDestroy(program);
+
+	fclose(input);
+	fclose(output);
+}
+
+static void TestGradient(void)
+{
+	calc_program_t* program = NULL;
+	calc_program_t* optimized = NULL;
+	status_t statuses[300];
+	double x[300];
+	double y[300];
+	double results[300];
+	double dx[300];
+	double dy[300];
+	const double* columns[2];
+	double* gradients[2];
+	double gradient[2];
+	double result = 0;
+	double expected[2];
+	size_t i = 0;
+	int mismatches = 0;
+
+	CalcCompile("x^2*y - 3*x/y + -y", &program);
+	CalcSetVariable(program, "x", 3);
+	CalcSetVariable(program, "y", 2);
+	TEST("Gradient success", CalcEvalGradient(program, &result, gradient),
+																	SUCCESS);
+	TEST("Correct result", IsMatch(result, 11.5), 1);
+	TEST("Partial by x", IsMatch(gradient[0], 10.5), 1);
+	TEST("Partial by y", IsMatch(gradient[1], 10.25), 1);
+
+	/* many rows, past one block, agree with one point at a time */
+	for( ; i < 300; ++i)
+	{
+		x[i] = (double)i / 7 - 20;
+		y[i] = (double)(i % 11) - 5;
+	}
+	columns[0] = x;
+	columns[1] = y;
+	gradients[0] = dx;
+	gradients[1] = dy;
+	TEST("Columns math error", CalcEvalGradientColumns(program, columns, 300,
+									results, gradients, statuses), MATH_ERROR);
+	for(i = 0; i < 300; ++i)
+	{
+		CalcSetVariable(program, "x", x[i]);
+		CalcSetVariable(program, "y", y[i]);
+		if(statuses[i] != CalcEvalGradient(program, &result, gradient) ||
+			(SUCCESS == statuses[i] && (results[i] != result ||
+					dx[i] != gradient[0] || dy[i] != gradient[1])))
+		{
+			++mismatches;
+		}
+	}
+	TEST("Rows agree", mismatches, 0);
+	TEST("Failed row", statuses[5], MATH_ERROR);
+	CalcProgramDestroy(program);
+
+	CalcCompile("x^y + sin(x)*exp(y) - log(x)*cos(y) + sqrt(y)", &program);
+	CalcSetVariable(program, "x", 2);
+	CalcSetVariable(program, "y", 4);
+	CalcEvalGradient(program, &result, gradient);
+	expected[0] = 32 - 0.41615 * 54.59815 - 0.5 * -0.65364;
+	expected[1] = 11.09035 + 0.90930 * 54.59815 + 0.69315 * -0.75680 + 0.25;
+	TEST("Partial by x", IsMatch(gradient[0], expected[0]), 1);
+	TEST("Partial by y", IsMatch(gradient[1], expected[1]), 1);
+	CalcProgramDestroy(program);
+
+	CalcCompile("max(x, y) - min(x, 2*y)", &program);
+	CalcSetVariable(program, "x", 3);
+	CalcSetVariable(program, "y", 1);
+	CalcEvalGradient(program, &result, gradient);
+	TEST("Partial of the operand chosen", gradient[0] == 1 &&
+												gradient[1] == -2, 1);
+	CalcProgramDestroy(program);
+
+	/* shared subexpressions are duplicated and stored with their partials */
+	CalcCompile("(x+y)*(y+x)-(x+y)", &program);
+	CompileOptimized("(x+y)*(y+x)-(x+y)", &optimized, NULL);
+	CalcSetVariable(program, "x", 1);
+	CalcSetVariable(program, "y", 2);
+	CalcSetVariable(optimized, "x", 1);
+	CalcSetVariable(optimized, "y", 2);
+	CalcEvalGradient(program, &result, expected);
+	CalcEvalGradient(optimized, &result, gradient);
+	TEST("Optimized gradient", IsMatch(result, 6) && expected[0] == 5 &&
+				gradient[0] == expected[0] && gradient[1] == expected[1], 1);
+	CalcProgramDestroy(program);
+	CalcProgramDestroy(optimized);
+
+	CalcCompile("1/(x-y)", &program);
+	CalcSetVariable(program, "x", 1);
+	CalcSetVariable(program, "y", 1);
+	TEST("Gradient math error", CalcEvalGradient(program, &result, gradient),
+																MATH_ERROR);
+	CalcProgramDestroy(program);
 }
 
 int main(void)
 {
 	TestCalculator();
+	TestLength();
+	TestBlocks();
+	TestNumbers();
+	TestContext();
+	TestStats();
+	TestBatch();
+	TestCache();
+	TestCompile();
+	TestOptimize();
+	TestIncremental();
+	TestJit();
+	TestWorkbook();
+	TestExact();
+	TestFunctions();
+	TestValidate();
+	TestLibrary();
+	TestCsv();
+	TestGradient();
 	PASS;
 	return 0;
 }
@@ -0,0 +1,243 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>      /* fprintf, sprintf, perror */
+#include <stdlib.h>     /* malloc, free */
+#include <string.h>     /* memchr, memcpy, strcmp */
+#include <time.h>       /* clock_gettime */
+#include <fcntl.h>      /* open */
+#include <unistd.h>     /* write, close */
+#include <sys/mman.h>   /* mmap, munmap, posix_madvise */
+#include <sys/stat.h>   /* fstat */
+
+#include "calculator.h"
+
+#define OUTPUT_BUFFER_SIZE (1 << 20)
+#define MAX_RECORD_SIZE 64
+
+typedef struct output
+{
+    int fd;
+    char* buffer;
+    size_t used;
+    int failed;
+} output_t;
+
+static double NowSeconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void Flush(output_t* out)
+{
+    size_t written = 0;
+    ssize_t ret = 0;
+
+    while(written < out->used && !out->failed)
+    {
+        ret = write(out->fd, out->buffer + written, out->used - written);
+        if(ret < 0)
+        {
+            perror("write");
+            out->failed = 1;
+            break;
+        }
+
+        written += ret;
+    }
+
+    out->used = 0;
+}
+
+/* text record: "<result> <status>\n", result is nan on failure */
+static void WriteText(output_t* out, double ans, status_t status)
+{
+    if(out->used + MAX_RECORD_SIZE > OUTPUT_BUFFER_SIZE)
+    {
+        Flush(out);
+    }
+
+    if(SUCCESS == status)
+    {
+        out->used += sprintf(out->buffer + out->used, "%.17g %d\n", ans,
+                                                                (int)status);
+    }
+    else
+    {
+        out->used += sprintf(out->buffer + out->used, "nan %d\n", (int)status);
+    }
+}
+
+/* binary record: native-endian double (NaN on failure) followed by one
+   status byte */
+static void WriteBinary(output_t* out, double ans, status_t status)
+{
+    double zero = 0;
+
+    if(out->used + sizeof(double) + 1 > OUTPUT_BUFFER_SIZE)
+    {
+        Flush(out);
+    }
+
+    if(SUCCESS != status)
+    {
+        ans = zero / zero;
+    }
+
+    memcpy(out->buffer + out->used, &ans, sizeof(double));
+    out->buffer[out->used + sizeof(double)] = (char)status;
+    out->used += sizeof(double) + 1;
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [--binary] [--output FILE] [--quiet] INPUT\n"
+        "  evaluates each line of INPUT, writing \"<result> <status>\" lines\n"
+        "  or, with --binary, packed records of a double and a status byte\n",
+                                                                        name);
+}
+
+int main(int argc, char* argv[])
+{
+    output_t out;
+    calc_ctx_t* ctx = NULL;
+    const char* input_path = NULL;
+    const char* output_path = NULL;
+    void (*write_record)(output_t*, double, status_t) = WriteText;
+    int quiet = 0;
+    int fd = -1;
+    struct stat st;
+    const char* map = NULL;
+    const char* line = NULL;
+    const char* end = NULL;
+    const char* newline = NULL;
+    size_t lines = 0;
+    size_t failures = 0;
+    double ans = 0;
+    double start = 0;
+    double elapsed = 0;
+    status_t status = SUCCESS;
+    int i = 1;
+
+    for( ; i < argc; ++i)
+    {
+        if(0 == strcmp(argv[i], "--binary"))
+        {
+            write_record = WriteBinary;
+        }
+        else if(0 == strcmp(argv[i], "--quiet"))
+        {
+            quiet = 1;
+        }
+        else if(0 == strcmp(argv[i], "--output") && i + 1 < argc)
+        {
+            output_path = argv[++i];
+        }
+        else if(NULL == input_path && '-' != argv[i][0])
+        {
+            input_path = argv[i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(NULL == input_path)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    fd = open(input_path, O_RDONLY);
+    if(fd < 0 || fstat(fd, &st) < 0)
+    {
+        perror(input_path);
+        return 1;
+    }
+
+    /* lines are evaluated in place, as slices of a read-only mapping */
+    if(st.st_size > 0)
+    {
+        map = (const char*)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE,
+                                                                        fd, 0);
+        if(MAP_FAILED == (void*)map)
+        {
+            perror("mmap");
+            close(fd);
+            return 1;
+        }
+
+        posix_madvise((void*)map, st.st_size, POSIX_MADV_SEQUENTIAL);
+    }
+
+    out.fd = STDOUT_FILENO;
+    if(NULL != output_path)
+    {
+        out.fd = open(output_path, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if(out.fd < 0)
+        {
+            perror(output_path);
+            return 1;
+        }
+    }
+
+    out.buffer = (char*)malloc(OUTPUT_BUFFER_SIZE);
+    out.used = 0;
+    out.failed = 0;
+    ctx = CalcCtxCreate(NULL);
+    if(NULL == out.buffer || NULL == ctx)
+    {
+        fprintf(stderr, "out of memory\n");
+        return 1;
+    }
+
+    start = NowSeconds();
+    line = map;
+    end = map + st.st_size;
+
+    while(line < end && !out.failed)
+    {
+        newline = (const char*)memchr(line, '\n', end - line);
+        if(NULL == newline)
+        {
+            newline = end;
+        }
+
+        status = CalculateCtxN(ctx, line, newline - line, &ans);
+
+        write_record(&out, ans, status);
+        failures += SUCCESS != status;
+        ++lines;
+        line = newline + 1;
+    }
+
+    Flush(&out);
+    elapsed = NowSeconds() - start;
+
+    if(!quiet)
+    {
+        fprintf(stderr, "%lu lines (%lu failed), %lu bytes in %.3f s: "
+                "%.0f lines/s, %.1f MB/s\n", (unsigned long)lines,
+                (unsigned long)failures, (unsigned long)st.st_size, elapsed,
+                lines / elapsed, st.st_size / elapsed / 1e6);
+    }
+
+    CalcCtxDestroy(ctx);
+    free(out.buffer);
+    if(NULL != map)
+    {
+        munmap((void*)map, st.st_size);
+    }
+    close(fd);
+    if(NULL != output_path)
+    {
+        close(out.fd);
+    }
+
+    return out.failed;
+}
@@ -0,0 +1,154 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>      /* fprintf, fopen, fclose, perror */
+#include <stdlib.h>     /* strtoul */
+#include <string.h>     /* memset, strcmp */
+#include <time.h>       /* clock_gettime */
+
+#include "calculator.h"
+#include "calc_csv.h"
+
+static double NowSeconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [--delimiter C] [--no-header] [--only-result]"
+                " [--name NAME] [--chunk ROWS] [--output FILE] [--quiet]\n"
+        "       EXPRESSION [INPUT]\n"
+        "  evaluates EXPRESSION on every row of the CSV file INPUT (default\n"
+        "  stdin), each variable being the column of the same name in the\n"
+        "  header, or cN for column N with --no-header, and writes each row\n"
+        "  with the result appended as a column named NAME (default\n"
+        "  \"result\"), or the result column alone with --only-result\n",
+                                                                        name);
+}
+
+int main(int argc, char* argv[])
+{
+    calc_csv_options_t options;
+    calc_csv_report_t report;
+    calc_program_t* program = NULL;
+    const char* expr = NULL;
+    const char* input_path = NULL;
+    const char* output_path = NULL;
+    FILE* input = stdin;
+    FILE* output = stdout;
+    int quiet = 0;
+    double start = 0;
+    double elapsed = 0;
+    status_t status = SUCCESS;
+    int i = 1;
+
+    memset(&options, 0, sizeof(options));
+    for( ; i < argc; ++i)
+    {
+        if(0 == strcmp(argv[i], "--delimiter") && i + 1 < argc)
+        {
+            options.delimiter = argv[++i][0];
+        }
+        else if(0 == strcmp(argv[i], "--no-header"))
+        {
+            options.no_header = 1;
+        }
+        else if(0 == strcmp(argv[i], "--only-result"))
+        {
+            options.only_result = 1;
+        }
+        else if(0 == strcmp(argv[i], "--name") && i + 1 < argc)
+        {
+            options.result_name = argv[++i];
+        }
+        else if(0 == strcmp(argv[i], "--chunk") && i + 1 < argc)
+        {
+            options.chunk_rows = strtoul(argv[++i], NULL, 10);
+        }
+        else if(0 == strcmp(argv[i], "--output") && i + 1 < argc)
+        {
+            output_path = argv[++i];
+        }
+        else if(0 == strcmp(argv[i], "--quiet"))
+        {
+            quiet = 1;
+        }
+        else if(NULL == expr)
+        {
+            expr = argv[i];
+        }
+        else if(NULL == input_path)
+        {
+            input_path = argv[i];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(NULL == expr)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    status = CalcCompile(expr, &program);
+    if(SUCCESS != status)
+    {
+        fprintf(stderr, "%s: %s\n", expr, INVALID_SYNTAX == status ?
+                                        "invalid syntax" : "out of memory");
+        return 1;
+    }
+    CalcOptimize(program, NULL);
+
+    if(NULL != input_path && NULL == (input = fopen(input_path, "rb")))
+    {
+        perror(input_path);
+        return 1;
+    }
+    if(NULL != output_path && NULL == (output = fopen(output_path, "wb")))
+    {
+        perror(output_path);
+        return 1;
+    }
+
+    start = NowSeconds();
+    status = CalcEvalCsv(program, input, output, &options, &report);
+    elapsed = NowSeconds() - start;
+
+    if(INVALID_SYNTAX == status)
+    {
+        fprintf(stderr, "%s: a variable has no column\n", expr);
+    }
+    else if(STREAM_ERROR == status || FAILED_ALLOCATION == status)
+    {
+        fprintf(stderr, "%s\n", STREAM_ERROR == status ?
+                            "cannot read or write the CSV" : "out of memory");
+    }
+    else if(!quiet)
+    {
+        fprintf(stderr, "%lu rows (%lu failed) in %.3f s: %.0f rows/s, "
+                    "%.1f MB/s\n", (unsigned long)report.rows,
+                    (unsigned long)report.failed_rows, elapsed,
+                    report.rows / elapsed, report.bytes / elapsed / 1e6);
+    }
+
+    if(NULL != input_path)
+    {
+        fclose(input);
+    }
+    if(NULL != output_path && 0 != fclose(output))
+    {
+        perror(output_path);
+        status = STREAM_ERROR;
+    }
+    CalcProgramDestroy(program);
+
+    return SUCCESS != status && MATH_ERROR != status;
+}
@@ -0,0 +1,867 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>      /* fprintf, perror */
+#include <stdlib.h>     /* malloc, realloc, calloc, free, strtoul */
+#include <string.h>     /* memcpy, memmove, memset, strcmp, strlen, strcpy */
+#include <errno.h>      /* errno */
+#include <signal.h>     /* sigaction, signal */
+#include <pthread.h>    /* pthread_create, pthread_join, pthread_mutex_t */
+#include <unistd.h>     /* read, write, close, pipe, unlink, sysconf */
+#include <fcntl.h>      /* fcntl */
+#include <sys/socket.h> /* socket, bind, listen, accept */
+#include <sys/un.h>     /* sockaddr_un */
+#include <sys/epoll.h>  /* epoll_create1, epoll_ctl, epoll_wait */
+
+#include "calculator.h"
+#include "calcd.h"
+
+#define MAX_EVENTS 256
+#define DEFAULT_BATCH_SIZE 256
+#define READ_SIZE 65536
+
+/* a request on its way through a worker and back */
+typedef struct item
+{
+    int fd;
+    unsigned int generation;    /* of the connection, fds are reused */
+    size_t seq;
+    size_t offset;              /* of the expression in the batch */
+    size_t length;
+    double result;
+    status_t status;
+} item_t;
+
+typedef struct batch
+{
+    item_t* items;
+    size_t count;
+    char* exprs;
+    size_t exprs_used;
+    size_t exprs_capacity;
+    struct batch* next;
+} batch_t;
+
+typedef struct pool
+{
+    pthread_mutex_t lock;
+    pthread_cond_t ready;
+    batch_t* queue;             /* waiting for a worker, oldest first */
+    batch_t* queue_tail;
+    batch_t* done;              /* evaluated, waiting for the event loop */
+    int wake_fds[2];            /* a byte is written when done fills */
+    int stopping;
+    pthread_t* threads;
+    unsigned num_threads;
+} pool_t;
+
+/* Responses are kept in request order in a ring: [head, ready) are
+   evaluated and not fully written yet, [ready, tail) are still being
+   evaluated (some may be done, out of order) */
+typedef struct connection
+{
+    int fd;
+    unsigned int generation;
+    unsigned int events;        /* registered with epoll */
+    int eof;
+    int dirty;
+    char* in;
+    size_t in_used;
+    size_t in_capacity;
+    calcd_response_t responses[CALCD_MAX_IN_FLIGHT];
+    unsigned char done[CALCD_MAX_IN_FLIGHT];
+    size_t head;
+    size_t head_written;        /* bytes of the head response */
+    size_t ready;
+    size_t tail;
+} connection_t;
+
+typedef struct loop
+{
+    int epoll_fd;
+    int listen_fd;
+    connection_t** connections; /* by fd */
+    connection_t** dirty;       /* with new responses or room to read */
+    size_t num_slots;
+    size_t num_dirty;
+    unsigned int generation;
+    batch_t* batch;             /* being filled */
+    batch_t* free_batches;
+    size_t batch_size;
+    unsigned long requests;
+    unsigned long accepted;
+    pool_t pool;
+} loop_t;
+
+static volatile sig_atomic_t stopped = 0;
+static int signal_fd = -1;
+
+/* a full pipe means the loop has a wake-up pending already */
+static void Wake(int fd)
+{
+    char byte = 0;
+    ssize_t ret = write(fd, &byte, 1);
+
+    (void)ret;
+}
+
+static void OnSignal(int sig)
+{
+    (void)sig;
+    stopped = 1;
+    Wake(signal_fd);
+}
+
+static int SetNonBlocking(int fd)
+{
+    int flags = fcntl(fd, F_GETFL);
+
+    return flags >= 0 && fcntl(fd, F_SETFL, flags | O_NONBLOCK) >= 0;
+}
+
+static void* Worker(void* arg)
+{
+    pool_t* pool = (pool_t*)arg;
+    calc_ctx_t* ctx = CalcCtxCreate(NULL);
+    batch_t* batch = NULL;
+    item_t* item = NULL;
+    int wake = 0;
+    size_t i = 0;
+
+    for( ; ; )
+    {
+        pthread_mutex_lock(&pool->lock);
+        while(NULL == pool->queue && !pool->stopping)
+        {
+            pthread_cond_wait(&pool->ready, &pool->lock);
+        }
+        batch = pool->queue;
+        if(NULL != batch)
+        {
+            pool->queue = batch->next;
+        }
+        pthread_mutex_unlock(&pool->lock);
+
+        if(NULL == batch)
+        {
+            break;
+        }
+
+        for(i = 0; i < batch->count; ++i)
+        {
+            item = &batch->items[i];
+            item->status = NULL == ctx ? FAILED_ALLOCATION :
+                        CalculateCtxN(ctx, batch->exprs + item->offset,
+                                                item->length, &item->result);
+        }
+
+        pthread_mutex_lock(&pool->lock);
+        wake = NULL == pool->done;
+        batch->next = pool->done;
+        pool->done = batch;
+        pthread_mutex_unlock(&pool->lock);
+
+        /* the loop takes the whole list at once, so it is woken only when
+           the list stops being empty */
+        if(wake)
+        {
+            Wake(pool->wake_fds[1]);
+        }
+    }
+
+    CalcCtxDestroy(ctx);
+
+    return NULL;
+}
+
+static int StartPool(pool_t* pool, unsigned num_threads)
+{
+    unsigned i = 0;
+
+    memset(pool, 0, sizeof(*pool));
+    if(0 != pipe(pool->wake_fds) || !SetNonBlocking(pool->wake_fds[0]) ||
+                                        !SetNonBlocking(pool->wake_fds[1]))
+    {
+        return 0;
+    }
+
+    pool->threads = (pthread_t*)malloc(num_threads * sizeof(pthread_t));
+    if(NULL == pool->threads)
+    {
+        return 0;
+    }
+
+    pthread_mutex_init(&pool->lock, NULL);
+    pthread_cond_init(&pool->ready, NULL);
+    for( ; i < num_threads; ++i)
+    {
+        if(0 != pthread_create(&pool->threads[i], NULL, Worker, pool))
+        {
+            break;
+        }
+    }
+    pool->num_threads = i;
+
+    return 0 < i;
+}
+
+static void StopPool(pool_t* pool)
+{
+    unsigned i = 0;
+
+    pthread_mutex_lock(&pool->lock);
+    pool->stopping = 1;
+    pthread_cond_broadcast(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    for( ; i < pool->num_threads; ++i)
+    {
+        pthread_join(pool->threads[i], NULL);
+    }
+
+    pthread_mutex_destroy(&pool->lock);
+    pthread_cond_destroy(&pool->ready);
+    free(pool->threads);
+    close(pool->wake_fds[0]);
+    close(pool->wake_fds[1]);
+}
+
+static void FreeBatches(batch_t* batch)
+{
+    batch_t* next = NULL;
+
+    for( ; NULL != batch; batch = next)
+    {
+        next = batch->next;
+        free(batch->items);
+        free(batch->exprs);
+        free(batch);
+    }
+}
+
+/* the batch being filled, taken from the free list or allocated */
+static batch_t* CurrentBatch(loop_t* loop)
+{
+    batch_t* batch = loop->batch;
+
+    if(NULL != batch)
+    {
+        return batch;
+    }
+
+    batch = loop->free_batches;
+    if(NULL != batch)
+    {
+        loop->free_batches = batch->next;
+    }
+    else
+    {
+        batch = (batch_t*)calloc(1, sizeof(batch_t));
+        if(NULL == batch)
+        {
+            return NULL;
+        }
+
+        batch->items = (item_t*)malloc(loop->batch_size * sizeof(item_t));
+        if(NULL == batch->items)
+        {
+            free(batch);
+            return NULL;
+        }
+    }
+
+    batch->count = 0;
+    batch->exprs_used = 0;
+    batch->next = NULL;
+    loop->batch = batch;
+
+    return batch;
+}
+
+static void Dispatch(loop_t* loop)
+{
+    batch_t* batch = loop->batch;
+    pool_t* pool = &loop->pool;
+
+    if(NULL == batch || 0 == batch->count)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    if(NULL == pool->queue)
+    {
+        pool->queue = batch;
+    }
+    else
+    {
+        pool->queue_tail->next = batch;
+    }
+    pool->queue_tail = batch;
+    pthread_cond_signal(&pool->ready);
+    pthread_mutex_unlock(&pool->lock);
+
+    loop->batch = NULL;
+}
+
+static void MarkDirty(loop_t* loop, connection_t* conn)
+{
+    if(!conn->dirty)
+    {
+        conn->dirty = 1;
+        loop->dirty[loop->num_dirty++] = conn;
+    }
+}
+
+static void Complete(loop_t* loop, connection_t* conn, size_t seq,
+                                            double result, status_t status)
+{
+    calcd_response_t* response = &conn->responses[seq % CALCD_MAX_IN_FLIGHT];
+    double zero = 0;
+
+    response->result = SUCCESS == status ? result : zero / zero;
+    response->status = status;
+    conn->done[seq % CALCD_MAX_IN_FLIGHT] = 1;
+
+    while(conn->ready < conn->tail &&
+                                conn->done[conn->ready % CALCD_MAX_IN_FLIGHT])
+    {
+        ++conn->ready;
+    }
+
+    MarkDirty(loop, conn);
+}
+
+static void AddRequest(loop_t* loop, connection_t* conn, unsigned int id,
+                                            const char* expr, size_t length)
+{
+    batch_t* batch = CurrentBatch(loop);
+    item_t* item = NULL;
+    char* exprs = NULL;
+    size_t capacity = 0;
+    size_t seq = conn->tail++;
+
+    conn->responses[seq % CALCD_MAX_IN_FLIGHT].id = id;
+    conn->done[seq % CALCD_MAX_IN_FLIGHT] = 0;
+    ++loop->requests;
+
+    if(NULL != batch && batch->exprs_used + length > batch->exprs_capacity)
+    {
+        capacity = 2 * batch->exprs_capacity;
+        if(capacity < batch->exprs_used + length)
+        {
+            capacity = batch->exprs_used + length;
+        }
+
+        exprs = (char*)realloc(batch->exprs, capacity);
+        if(NULL == exprs)
+        {
+            batch = NULL;
+        }
+        else
+        {
+            batch->exprs = exprs;
+            batch->exprs_capacity = capacity;
+        }
+    }
+
+    if(NULL == batch)
+    {
+        Complete(loop, conn, seq, 0, FAILED_ALLOCATION);
+        return;
+    }
+
+    item = &batch->items[batch->count++];
+    item->fd = conn->fd;
+    item->generation = conn->generation;
+    item->seq = seq;
+    item->offset = batch->exprs_used;
+    item->length = length;
+    memcpy(batch->exprs + batch->exprs_used, expr, length);
+    batch->exprs_used += length;
+
+    if(batch->count == loop->batch_size)
+    {
+        Dispatch(loop);
+    }
+}
+
+/* hands every complete request that fits in the ring to the current batch;
+   0 on a protocol error */
+static int Parse(loop_t* loop, connection_t* conn)
+{
+    calcd_request_t request;
+    size_t pos = 0;
+
+    while(conn->tail - conn->head < CALCD_MAX_IN_FLIGHT &&
+                                    conn->in_used - pos >= sizeof(request))
+    {
+        memcpy(&request, conn->in + pos, sizeof(request));
+        if(request.length > CALCD_MAX_EXPR)
+        {
+            return 0;
+        }
+        if(conn->in_used - pos - sizeof(request) < request.length)
+        {
+            break;
+        }
+
+        pos += sizeof(request);
+        AddRequest(loop, conn, request.id, conn->in + pos, request.length);
+        pos += request.length;
+    }
+
+    memmove(conn->in, conn->in + pos, conn->in_used - pos);
+    conn->in_used -= pos;
+
+    return 1;
+}
+
+/* 0 on an error other than a full socket */
+static int Read(connection_t* conn)
+{
+    char* in = NULL;
+    ssize_t ret = 0;
+
+    if(conn->in_capacity - conn->in_used < READ_SIZE)
+    {
+        in = (char*)realloc(conn->in, conn->in_used + READ_SIZE);
+        if(NULL == in)
+        {
+            return 0;
+        }
+
+        conn->in = in;
+        conn->in_capacity = conn->in_used + READ_SIZE;
+    }
+
+    ret = read(conn->fd, conn->in + conn->in_used, READ_SIZE);
+    if(ret > 0)
+    {
+        conn->in_used += ret;
+    }
+    else if(0 == ret)
+    {
+        conn->eof = 1;
+    }
+    else if(EAGAIN != errno && EWOULDBLOCK != errno && EINTR != errno)
+    {
+        return 0;
+    }
+
+    return 1;
+}
+
+/* writes the ready responses until the socket is full; 0 on an error */
+static int Write(connection_t* conn)
+{
+    const size_t size = sizeof(calcd_response_t);
+    size_t slot = 0;
+    size_t count = 0;
+    ssize_t ret = 0;
+
+    while(conn->head < conn->ready)
+    {
+        slot = conn->head % CALCD_MAX_IN_FLIGHT;
+        count = conn->ready - conn->head;
+        if(count > CALCD_MAX_IN_FLIGHT - slot)
+        {
+            count = CALCD_MAX_IN_FLIGHT - slot;
+        }
+
+        ret = write(conn->fd, (char*)&conn->responses[slot] +
+                    conn->head_written, count * size - conn->head_written);
+        if(ret < 0)
+        {
+            if(EINTR == errno)
+            {
+                continue;
+            }
+
+            return EAGAIN == errno || EWOULDBLOCK == errno;
+        }
+
+        conn->head_written += ret;
+        conn->head += conn->head_written / size;
+        conn->head_written %= size;
+    }
+
+    return 1;
+}
+
+static void Close(loop_t* loop, connection_t* conn)
+{
+    size_t i = 0;
+
+    if(conn->dirty)
+    {
+        for( ; loop->dirty[i] != conn; ++i)
+        {
+        }
+        loop->dirty[i] = loop->dirty[--loop->num_dirty];
+    }
+
+    loop->connections[conn->fd] = NULL;
+    close(conn->fd);
+    free(conn->in);
+    free(conn);
+}
+
+/* Writes what is ready, takes the requests that now fit, and closes the
+   connection once the peer has closed and has every response. Reading
+   stops while the ring is full, so a client that never reads cannot make
+   the daemon buffer without bound */
+static void Settle(loop_t* loop, connection_t* conn)
+{
+    struct epoll_event event;
+
+    if(!Write(conn) || !Parse(loop, conn) ||
+                                    (conn->eof && conn->head == conn->tail))
+    {
+        Close(loop, conn);
+        return;
+    }
+
+    event.events = 0;
+    if(!conn->eof && conn->tail - conn->head < CALCD_MAX_IN_FLIGHT)
+    {
+        event.events |= EPOLLIN;
+    }
+    if(conn->head < conn->ready)
+    {
+        event.events |= EPOLLOUT;
+    }
+
+    if(event.events != conn->events)
+    {
+        event.data.fd = conn->fd;
+        if(0 != epoll_ctl(loop->epoll_fd, EPOLL_CTL_MOD, conn->fd, &event))
+        {
+            Close(loop, conn);
+            return;
+        }
+        conn->events = event.events;
+    }
+}
+
+static int GrowSlots(loop_t* loop, size_t fd)
+{
+    connection_t** connections = NULL;
+    connection_t** dirty = NULL;
+    size_t num_slots = 0 == loop->num_slots ? 64 : loop->num_slots;
+
+    while(num_slots <= fd)
+    {
+        num_slots *= 2;
+    }
+
+    connections = (connection_t**)realloc(loop->connections,
+                                        num_slots * sizeof(connection_t*));
+    if(NULL == connections)
+    {
+        return 0;
+    }
+    loop->connections = connections;
+
+    dirty = (connection_t**)realloc(loop->dirty,
+                                        num_slots * sizeof(connection_t*));
+    if(NULL == dirty)
+    {
+        return 0;
+    }
+    loop->dirty = dirty;
+
+    memset(connections + loop->num_slots, 0,
+                        (num_slots - loop->num_slots) * sizeof(connection_t*));
+    loop->num_slots = num_slots;
+
+    return 1;
+}
+
+static void Accept(loop_t* loop)
+{
+    struct epoll_event event;
+    connection_t* conn = NULL;
+    int fd = -1;
+
+    for( ; ; )
+    {
+        fd = accept(loop->listen_fd, NULL, NULL);
+        if(fd < 0)
+        {
+            if(EINTR == errno)
+            {
+                continue;
+            }
+            if(EAGAIN != errno && EWOULDBLOCK != errno &&
+                                                    ECONNABORTED != errno)
+            {
+                perror("accept");
+            }
+            return;
+        }
+
+        conn = NULL;
+        if(!SetNonBlocking(fd) || ((size_t)fd >= loop->num_slots &&
+                                            !GrowSlots(loop, (size_t)fd)) ||
+            NULL == (conn = (connection_t*)calloc(1, sizeof(connection_t))))
+        {
+            close(fd);
+            continue;
+        }
+
+        conn->fd = fd;
+        conn->generation = ++loop->generation;
+        conn->events = EPOLLIN;
+        loop->connections[fd] = conn;
+        ++loop->accepted;
+
+        event.events = EPOLLIN;
+        event.data.fd = fd;
+        if(0 != epoll_ctl(loop->epoll_fd, EPOLL_CTL_ADD, fd, &event))
+        {
+            Close(loop, conn);
+        }
+    }
+}
+
+/* hands the evaluated batches back to their connections */
+static void TakeDone(loop_t* loop)
+{
+    pool_t* pool = &loop->pool;
+    batch_t* batch = NULL;
+    batch_t* next = NULL;
+    connection_t* conn = NULL;
+    item_t* item = NULL;
+    char bytes[64];
+    size_t i = 0;
+
+    while(read(pool->wake_fds[0], bytes, sizeof(bytes)) > 0)
+    {
+    }
+
+    pthread_mutex_lock(&pool->lock);
+    batch = pool->done;
+    pool->done = NULL;
+    pthread_mutex_unlock(&pool->lock);
+
+    for( ; NULL != batch; batch = next)
+    {
+        next = batch->next;
+        for(i = 0; i < batch->count; ++i)
+        {
+            item = &batch->items[i];
+            conn = loop->connections[item->fd];
+            if(NULL != conn && conn->generation == item->generation)
+            {
+                Complete(loop, conn, item->seq, item->result, item->status);
+            }
+        }
+
+        batch->next = loop->free_batches;
+        loop->free_batches = batch;
+    }
+}
+
+static void HandleEvent(loop_t* loop, connection_t* conn,
+                                                        unsigned int events)
+{
+    if((events & (EPOLLERR | EPOLLHUP)) ||
+                                        ((events & EPOLLIN) && !Read(conn)))
+    {
+        Close(loop, conn);
+        return;
+    }
+
+    MarkDirty(loop, conn);
+}
+
+static int Listen(const char* path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(fd < 0 || strlen(path) >= sizeof(addr.sun_path))
+    {
+        fprintf(stderr, "%s: cannot create the socket\n", path);
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    unlink(path);
+
+    if(0 != bind(fd, (struct sockaddr*)&addr, sizeof(addr)) ||
+                        0 != listen(fd, SOMAXCONN) || !SetNonBlocking(fd))
+    {
+        perror(path);
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int Register(int epoll_fd, int fd)
+{
+    struct epoll_event event;
+
+    event.events = EPOLLIN;
+    event.data.fd = fd;
+
+    return 0 == epoll_ctl(epoll_fd, EPOLL_CTL_ADD, fd, &event);
+}
+
+static void Run(loop_t* loop)
+{
+    struct epoll_event events[MAX_EVENTS];
+    connection_t* conn = NULL;
+    int num_events = 0;
+    int fd = -1;
+    int i = 0;
+
+    while(!stopped)
+    {
+        num_events = epoll_wait(loop->epoll_fd, events, MAX_EVENTS, -1);
+        if(num_events < 0)
+        {
+            if(EINTR == errno)
+            {
+                continue;
+            }
+
+            perror("epoll_wait");
+            return;
+        }
+
+        for(i = 0; i < num_events; ++i)
+        {
+            fd = events[i].data.fd;
+            if(fd == loop->listen_fd)
+            {
+                Accept(loop);
+            }
+            else if(fd == loop->pool.wake_fds[0])
+            {
+                TakeDone(loop);
+            }
+            else if((size_t)fd < loop->num_slots &&
+                                    NULL != (conn = loop->connections[fd]))
+            {
+                HandleEvent(loop, conn, events[i].events);
+            }
+        }
+
+        /* every request read in this round goes to the workers in as few
+           batches as possible, whichever connection it came from */
+        while(0 < loop->num_dirty)
+        {
+            conn = loop->dirty[--loop->num_dirty];
+            conn->dirty = 0;
+            Settle(loop, conn);
+        }
+        Dispatch(loop);
+    }
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [--socket PATH] [--threads N] [--batch N]\n"
+        "  evaluates length-prefixed requests on a Unix-domain socket\n"
+        "  (default " CALCD_SOCKET ") with N worker threads (default one\n"
+        "  per CPU), up to N requests per batch (default %d)\n",
+                                                name, DEFAULT_BATCH_SIZE);
+}
+
+int main(int argc, char* argv[])
+{
+    loop_t loop;
+    struct sigaction action;
+    const char* path = CALCD_SOCKET;
+    unsigned long threads = 0;
+    unsigned long batch_size = DEFAULT_BATCH_SIZE;
+    size_t fd = 0;
+    int i = 1;
+
+    for( ; i < argc; ++i)
+    {
+        if(0 == strcmp(argv[i], "--socket") && i + 1 < argc)
+        {
+            path = argv[++i];
+        }
+        else if(0 == strcmp(argv[i], "--threads") && i + 1 < argc)
+        {
+            threads = strtoul(argv[++i], NULL, 10);
+        }
+        else if(0 == strcmp(argv[i], "--batch") && i + 1 < argc)
+        {
+            batch_size = strtoul(argv[++i], NULL, 10);
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if(0 == threads)
+    {
+        threads = (unsigned long)sysconf(_SC_NPROCESSORS_ONLN);
+        threads = 0 == threads ? 1 : threads;
+    }
+    if(0 == batch_size)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    memset(&loop, 0, sizeof(loop));
+    loop.batch_size = batch_size;
+    loop.listen_fd = Listen(path);
+    loop.epoll_fd = epoll_create1(0);
+    if(loop.listen_fd < 0 || loop.epoll_fd < 0 ||
+                                    !StartPool(&loop.pool, threads) ||
+                                    !Register(loop.epoll_fd, loop.listen_fd) ||
+                            !Register(loop.epoll_fd, loop.pool.wake_fds[0]))
+    {
+        fprintf(stderr, "cannot start\n");
+        return 1;
+    }
+
+    /* a signal writes to the wake pipe, so the loop never sleeps past it */
+    signal_fd = loop.pool.wake_fds[1];
+    memset(&action, 0, sizeof(action));
+    action.sa_handler = OnSignal;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGINT, &action, NULL);
+    sigaction(SIGTERM, &action, NULL);
+    signal(SIGPIPE, SIG_IGN);
+
+    fprintf(stderr, "listening on %s with %u workers\n", path,
+                                                    loop.pool.num_threads);
+    Run(&loop);
+
+    StopPool(&loop.pool);
+    FreeBatches(loop.pool.queue);
+    FreeBatches(loop.pool.done);
+    FreeBatches(loop.free_batches);
+    FreeBatches(loop.batch);
+    for( ; fd < loop.num_slots; ++fd)
+    {
+        if(NULL != loop.connections[fd])
+        {
+            loop.connections[fd]->dirty = 0;
+            Close(&loop, loop.connections[fd]);
+        }
+    }
+    free(loop.connections);
+    free(loop.dirty);
+    close(loop.epoll_fd);
+    close(loop.listen_fd);
+    unlink(path);
+
+    fprintf(stderr, "%lu requests on %lu connections\n", loop.requests,
+                                                            loop.accepted);
+
+    return 0;
+}
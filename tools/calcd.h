@@ -0,0 +1,29 @@
+#ifndef __CALCD_H__
+#define __CALCD_H__
+
+/* Protocol of calcd, the evaluation daemon. A client sends requests on a
+   Unix-domain stream socket, each a calcd_request_t followed by length
+   bytes of expression (not NUL-terminated). Every request gets one
+   calcd_response_t, in the order the requests were sent, so a client may
+   pipeline up to CALCD_MAX_IN_FLIGHT requests before reading. Both sides
+   are on the same host, so fields are in its byte order */
+
+#define CALCD_SOCKET "/tmp/calcd.sock"
+#define CALCD_MAX_EXPR (1 << 20)        /* longer requests close the socket */
+#define CALCD_MAX_IN_FLIGHT 1024        /* per connection, beyond it the
+                                           daemon stops reading */
+
+typedef struct calcd_request
+{
+    unsigned int length;
+    unsigned int id;                    /* echoed in the response */
+} calcd_request_t;
+
+typedef struct calcd_response
+{
+    double result;                      /* NaN on failure */
+    unsigned int id;
+    unsigned int status;                /* status_t */
+} calcd_response_t;
+
+#endif      /* calcd.h */
@@ -0,0 +1,261 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>      /* printf, fprintf, fopen, fgets */
+#include <stdlib.h>     /* malloc, free, strtod */
+#include <string.h>     /* strchr, strcmp, strlen */
+#include <time.h>       /* clock_gettime */
+
+#include "calculator.h"
+#include "calc_library.h"
+
+#define MAX_LINE 65536
+
+static double NowSeconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static char* Trim(char* str)
+{
+    char* end = str + strlen(str);
+
+    while(' ' == *str || '\t' == *str)
+    {
+        ++str;
+    }
+    while(end > str && (' ' == end[-1] || '\t' == end[-1] ||
+                                    '\n' == end[-1] || '\r' == end[-1]))
+    {
+        --end;
+    }
+    *end = '\0';
+
+    return str;
+}
+
+/* lines "name = expression"; blank lines and lines starting with '#' are
+   skipped */
+static int Build(const char* input_path, const char* library_path)
+{
+    calc_library_builder_t* builder = CalcLibraryBuilderCreate();
+    FILE* input = fopen(input_path, "r");
+    char* line = (char*)malloc(MAX_LINE);
+    char* equals = NULL;
+    char* name = NULL;
+    size_t line_number = 0;
+    size_t formulas = 0;
+    size_t errors = 0;
+    status_t status = SUCCESS;
+
+    if(NULL == builder || NULL == input || NULL == line)
+    {
+        perror(input_path);
+        CalcLibraryBuilderDestroy(builder);
+        free(line);
+        if(NULL != input)
+        {
+            fclose(input);
+        }
+        return 1;
+    }
+
+    while(NULL != fgets(line, MAX_LINE, input))
+    {
+        ++line_number;
+        name = Trim(line);
+        if('\0' == *name || '#' == *name)
+        {
+            continue;
+        }
+
+        equals = strchr(name, '=');
+        if(NULL == equals)
+        {
+            fprintf(stderr, "%s:%lu: expected \"name = expression\"\n",
+                                    input_path, (unsigned long)line_number);
+            ++errors;
+            continue;
+        }
+
+        *equals = '\0';
+        status = CalcLibraryBuilderAdd(builder, Trim(name), equals + 1);
+        if(SUCCESS != status)
+        {
+            fprintf(stderr, "%s:%lu: %s\n", input_path,
+                        (unsigned long)line_number, INVALID_SYNTAX == status ?
+                                        "invalid syntax" : "out of memory");
+            ++errors;
+            continue;
+        }
+        ++formulas;
+    }
+
+    fclose(input);
+    free(line);
+
+    status = 0 == errors ? CalcLibraryBuilderWrite(builder, library_path) :
+                                                                    SUCCESS;
+    CalcLibraryBuilderDestroy(builder);
+    if(SUCCESS != status)
+    {
+        fprintf(stderr, "%s: cannot be written\n", library_path);
+        return 1;
+    }
+
+    if(0 == errors)
+    {
+        fprintf(stderr, "%lu formulas written to %s\n",
+                                    (unsigned long)formulas, library_path);
+    }
+
+    return 0 != errors;
+}
+
+static int Open(const char* path, calc_library_t** library)
+{
+    double start = NowSeconds();
+    status_t status = CalcLibraryOpen(path, library);
+
+    if(SUCCESS != status)
+    {
+        fprintf(stderr, "%s: %s\n", path, INVALID_LIBRARY == status ?
+                            "not a valid formula library" : "out of memory");
+        return 0;
+    }
+
+    fprintf(stderr, "%lu formulas opened and checked in %.3f ms\n",
+                (unsigned long)CalcLibraryCount(*library),
+                                            (NowSeconds() - start) * 1e3);
+
+    return 1;
+}
+
+static int List(const char* path)
+{
+    calc_library_t* library = NULL;
+    size_t count = 0;
+    size_t i = 0;
+    size_t var = 0;
+
+    if(!Open(path, &library))
+    {
+        return 1;
+    }
+
+    count = CalcLibraryCount(library);
+    for( ; i < count; ++i)
+    {
+        printf("%s", CalcLibraryName(library, i));
+        for(var = 0; var < CalcLibraryVariableCount(library, i); ++var)
+        {
+            printf("%c%s", 0 == var ? '(' : ',',
+                                    CalcLibraryVariableName(library, i, var));
+        }
+        printf("%s\n", 0 == var ? "" : ")");
+    }
+
+    CalcLibraryClose(library);
+
+    return 0;
+}
+
+/* bindings "variable=value"; unbound variables are 0 */
+static int Eval(const char* path, const char* name, char** bindings,
+                                                            int num_bindings)
+{
+    calc_library_t* library = NULL;
+    double* vars = NULL;
+    char* equals = NULL;
+    size_t num_vars = 0;
+    size_t index = 0;
+    size_t var = 0;
+    double ans = 0;
+    status_t status = SUCCESS;
+    int i = 0;
+
+    if(!Open(path, &library))
+    {
+        return 1;
+    }
+
+    index = CalcLibraryFind(library, name);
+    if(index == CalcLibraryCount(library))
+    {
+        fprintf(stderr, "%s: no formula named %s\n", path, name);
+        CalcLibraryClose(library);
+        return 1;
+    }
+
+    num_vars = CalcLibraryVariableCount(library, index);
+    vars = (double*)calloc(num_vars + 1, sizeof(double));
+    for( ; NULL != vars && i < num_bindings; ++i)
+    {
+        equals = strchr(bindings[i], '=');
+        if(NULL == equals)
+        {
+            continue;
+        }
+
+        *equals = '\0';
+        for(var = 0; var < num_vars; ++var)
+        {
+            if(0 == strcmp(bindings[i],
+                                CalcLibraryVariableName(library, index, var)))
+            {
+                vars[var] = strtod(equals + 1, NULL);
+            }
+        }
+    }
+
+    status = NULL == vars ? FAILED_ALLOCATION :
+                            CalcLibraryEval(library, index, vars, &ans);
+    if(SUCCESS == status)
+    {
+        printf("%.17g\n", ans);
+    }
+    else
+    {
+        fprintf(stderr, "%s: status %d\n", name, (int)status);
+    }
+
+    free(vars);
+    CalcLibraryClose(library);
+
+    return SUCCESS != status;
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr, "usage: %s build INPUT LIBRARY\n"
+        "       %s list LIBRARY\n"
+        "       %s eval LIBRARY NAME [VARIABLE=VALUE]...\n"
+        "  build compiles the \"name = expression\" lines of INPUT into a\n"
+        "  formula library file, which list and eval map and check\n",
+                                                        name, name, name);
+}
+
+int main(int argc, char* argv[])
+{
+    if(4 == argc && 0 == strcmp(argv[1], "build"))
+    {
+        return Build(argv[2], argv[3]);
+    }
+
+    if(3 == argc && 0 == strcmp(argv[1], "list"))
+    {
+        return List(argv[2]);
+    }
+
+    if(4 <= argc && 0 == strcmp(argv[1], "eval"))
+    {
+        return Eval(argv[2], argv[3], argv + 4, argc - 4);
+    }
+
+    Usage(argv[0]);
+
+    return 1;
+}
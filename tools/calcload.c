@@ -0,0 +1,415 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>      /* printf, fprintf, fopen, fgets, perror */
+#include <stdlib.h>     /* malloc, calloc, free, qsort, strtoul */
+#include <string.h>     /* memcpy, memmove, memset, strcmp, strcpy, strlen */
+#include <errno.h>      /* errno */
+#include <time.h>       /* clock_gettime */
+#include <pthread.h>    /* pthread_create, pthread_join */
+#include <unistd.h>     /* read, write, close */
+#include <sys/socket.h> /* socket, connect */
+#include <sys/un.h>     /* sockaddr_un */
+
+#include "calculator.h"
+#include "calcd.h"
+
+#define MAX_LINE 65536
+
+typedef struct workload
+{
+    char** exprs;
+    size_t* lens;
+    double* results;            /* evaluated locally, to check the daemon */
+    status_t* statuses;
+    size_t count;
+    size_t max_len;
+} workload_t;
+
+typedef struct client
+{
+    const workload_t* workload;
+    const char* path;
+    size_t first;               /* expression of the first request */
+    size_t requests;
+    size_t depth;
+    double* latencies;          /* of every request, in seconds */
+    size_t wrong;               /* results, statuses or ids that differ */
+    int failed;
+    pthread_t thread;
+} client_t;
+
+static const char* default_exprs[] =
+{
+    "1 + 2 * 3",
+    "(4 - 1) ^ 2 / 3",
+    "-2 ^ 0.5 * (1.5e3 - 7) / 11",
+    "sqrt(16) + max(1, 2, 3) - min(4, 5)",
+    "exp(1) * log(10) + sin(0.5) * cos(0.5)",
+    "((((1 + 2) * 3 - 4) / 5) ^ 2 + 6) * 7 - 8 / 9",
+    "1 / 0",
+    "2 *"
+};
+
+static double NowSeconds(void)
+{
+    struct timespec now;
+
+    clock_gettime(CLOCK_MONOTONIC, &now);
+
+    return now.tv_sec + now.tv_nsec / 1e9;
+}
+
+static int CompareDoubles(const void* a, const void* b)
+{
+    double x = *(const double*)a;
+    double y = *(const double*)b;
+
+    return (x > y) - (x < y);
+}
+
+static double Percentile(const double* sorted, size_t count, double fraction)
+{
+    size_t index = (size_t)(fraction * (count - 1) + 0.5);
+
+    return sorted[index];
+}
+
+static int AddExpr(workload_t* workload, const char* expr, size_t capacity)
+{
+    size_t len = strlen(expr);
+
+    if(workload->count == capacity)
+    {
+        return 0;
+    }
+
+    workload->exprs[workload->count] = (char*)malloc(len + 1);
+    if(NULL == workload->exprs[workload->count])
+    {
+        return 0;
+    }
+
+    strcpy(workload->exprs[workload->count], expr);
+    workload->lens[workload->count] = len;
+    workload->statuses[workload->count] = CalculateN(expr, len,
+                                        &workload->results[workload->count]);
+    workload->max_len = len > workload->max_len ? len : workload->max_len;
+    ++workload->count;
+
+    return 1;
+}
+
+/* the lines of path (without their newlines, empty ones skipped, no more
+   than can be sent), or the default expressions */
+static int LoadWorkload(workload_t* workload, const char* path,
+                                                            size_t capacity)
+{
+    FILE* input = NULL;
+    char* line = NULL;
+    size_t len = 0;
+    size_t i = 0;
+
+    workload->exprs = (char**)calloc(capacity, sizeof(char*));
+    workload->lens = (size_t*)malloc(capacity * sizeof(size_t));
+    workload->results = (double*)malloc(capacity * sizeof(double));
+    workload->statuses = (status_t*)malloc(capacity * sizeof(status_t));
+    if(NULL == workload->exprs || NULL == workload->lens ||
+                    NULL == workload->results || NULL == workload->statuses)
+    {
+        return 0;
+    }
+
+    if(NULL == path)
+    {
+        for( ; i < sizeof(default_exprs) / sizeof(default_exprs[0]); ++i)
+        {
+            AddExpr(workload, default_exprs[i], capacity);
+        }
+        return 1;
+    }
+
+    input = fopen(path, "r");
+    line = (char*)malloc(MAX_LINE);
+    if(NULL == input || NULL == line)
+    {
+        perror(path);
+        free(line);
+        return 0;
+    }
+
+    while(NULL != fgets(line, MAX_LINE, input))
+    {
+        len = strlen(line);
+        while(0 < len && ('\n' == line[len - 1] || '\r' == line[len - 1]))
+        {
+            line[--len] = '\0';
+        }
+
+        if(0 < len && !AddExpr(workload, line, capacity))
+        {
+            break;
+        }
+    }
+
+    fclose(input);
+    free(line);
+
+    return 0 < workload->count;
+}
+
+static int Connect(const char* path)
+{
+    struct sockaddr_un addr;
+    int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+
+    if(fd < 0 || strlen(path) >= sizeof(addr.sun_path))
+    {
+        return -1;
+    }
+
+    memset(&addr, 0, sizeof(addr));
+    addr.sun_family = AF_UNIX;
+    strcpy(addr.sun_path, path);
+    if(0 != connect(fd, (struct sockaddr*)&addr, sizeof(addr)))
+    {
+        close(fd);
+        return -1;
+    }
+
+    return fd;
+}
+
+static int WriteAll(int fd, const char* buffer, size_t size)
+{
+    ssize_t ret = 0;
+
+    while(0 < size)
+    {
+        ret = write(fd, buffer, size);
+        if(ret < 0 && EINTR != errno)
+        {
+            return 0;
+        }
+
+        ret = ret < 0 ? 0 : ret;
+        buffer += ret;
+        size -= ret;
+    }
+
+    return 1;
+}
+
+/* Keeps depth requests in flight on one connection: tops the pipeline up,
+   then reads whatever responses have arrived. A response's latency runs
+   from the write of its request to the read that completes it */
+static void* RunClient(void* arg)
+{
+    client_t* client = (client_t*)arg;
+    const workload_t* workload = client->workload;
+    const size_t size = sizeof(calcd_response_t);
+    calcd_request_t request;
+    calcd_response_t response;
+    double* sent_at = (double*)malloc(client->depth * sizeof(double));
+    char* out = (char*)malloc(client->depth *
+                                    (sizeof(request) + workload->max_len));
+    char* in = (char*)malloc(client->depth * size);
+    int fd = Connect(client->path);
+    size_t sent = 0;
+    size_t received = 0;
+    size_t first = 0;
+    size_t used = 0;
+    size_t in_used = 0;
+    size_t expr = 0;
+    size_t i = 0;
+    ssize_t ret = 0;
+    double now = 0;
+
+    client->failed = fd < 0 || NULL == sent_at || NULL == out || NULL == in;
+    while(!client->failed && received < client->requests)
+    {
+        for(first = sent, used = 0; sent < client->requests &&
+                                    sent - received < client->depth; ++sent)
+        {
+            expr = (client->first + sent) % workload->count;
+            request.length = (unsigned int)workload->lens[expr];
+            request.id = (unsigned int)sent;
+            memcpy(out + used, &request, sizeof(request));
+            memcpy(out + used + sizeof(request), workload->exprs[expr],
+                                                            request.length);
+            used += sizeof(request) + request.length;
+        }
+
+        now = NowSeconds();
+        for(i = first; i < sent; ++i)
+        {
+            sent_at[i % client->depth] = now;
+        }
+
+        if(!WriteAll(fd, out, used))
+        {
+            client->failed = 1;
+            break;
+        }
+
+        ret = read(fd, in + in_used, client->depth * size - in_used);
+        if(ret <= 0)
+        {
+            client->failed = 0 == ret || EINTR != errno;
+            continue;
+        }
+
+        in_used += ret;
+        now = NowSeconds();
+        for(i = 0; i + size <= in_used; i += size, ++received)
+        {
+            memcpy(&response, in + i, size);
+            expr = (client->first + received) % workload->count;
+            client->wrong += response.id != (unsigned int)received ||
+                            response.status != workload->statuses[expr] ||
+                            (SUCCESS == workload->statuses[expr] &&
+                                response.result != workload->results[expr]);
+            client->latencies[received] = now -
+                                            sent_at[received % client->depth];
+        }
+
+        memmove(in, in + i, in_used - i);
+        in_used -= i;
+    }
+
+    if(0 <= fd)
+    {
+        close(fd);
+    }
+    free(sent_at);
+    free(out);
+    free(in);
+
+    return NULL;
+}
+
+static void Usage(const char* name)
+{
+    fprintf(stderr, "usage: %s [--socket PATH] [--connections N] "
+                                "[--depth N] [--requests N] [INPUT]\n"
+        "  sends N requests on each of N connections to calcd, with up to\n"
+        "  --depth requests in flight on each, cycling through the lines of\n"
+        "  INPUT (or built-in expressions), and reports the throughput and\n"
+        "  the latency percentiles; every result is checked\n", name);
+}
+
+int main(int argc, char* argv[])
+{
+    workload_t workload;
+    client_t* clients = NULL;
+    double* latencies = NULL;
+    const char* path = CALCD_SOCKET;
+    const char* input_path = NULL;
+    unsigned long connections = 4;
+    unsigned long depth = 32;
+    unsigned long requests = 100000;
+    unsigned long i = 0;
+    size_t total = 0;
+    size_t wrong = 0;
+    int failed = 0;
+    double start = 0;
+    double elapsed = 0;
+    int arg = 1;
+
+    for( ; arg < argc; ++arg)
+    {
+        if(0 == strcmp(argv[arg], "--socket") && arg + 1 < argc)
+        {
+            path = argv[++arg];
+        }
+        else if(0 == strcmp(argv[arg], "--connections") && arg + 1 < argc)
+        {
+            connections = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--depth") && arg + 1 < argc)
+        {
+            depth = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(0 == strcmp(argv[arg], "--requests") && arg + 1 < argc)
+        {
+            requests = strtoul(argv[++arg], NULL, 10);
+        }
+        else if(NULL == input_path && '-' != argv[arg][0])
+        {
+            input_path = argv[arg];
+        }
+        else
+        {
+            Usage(argv[0]);
+            return 1;
+        }
+    }
+
+    /* the daemon stops reading a connection past CALCD_MAX_IN_FLIGHT */
+    if(0 == connections || 0 == depth || depth > CALCD_MAX_IN_FLIGHT ||
+                                                            0 == requests)
+    {
+        Usage(argv[0]);
+        return 1;
+    }
+
+    memset(&workload, 0, sizeof(workload));
+    clients = (client_t*)calloc(connections, sizeof(client_t));
+    latencies = (double*)malloc(connections * requests * sizeof(double));
+    if(NULL == clients || NULL == latencies ||
+            !LoadWorkload(&workload, input_path, connections * requests))
+    {
+        fprintf(stderr, "cannot load the expressions\n");
+        return 1;
+    }
+
+    start = NowSeconds();
+    for( ; i < connections; ++i)
+    {
+        clients[i].workload = &workload;
+        clients[i].path = path;
+        clients[i].first = i * workload.count / connections;
+        clients[i].requests = requests;
+        clients[i].depth = depth;
+        clients[i].latencies = latencies + i * requests;
+        pthread_create(&clients[i].thread, NULL, RunClient, &clients[i]);
+    }
+
+    for(i = 0; i < connections; ++i)
+    {
+        pthread_join(clients[i].thread, NULL);
+        failed |= clients[i].failed;
+        wrong += clients[i].wrong;
+    }
+    elapsed = NowSeconds() - start;
+
+    if(failed)
+    {
+        fprintf(stderr, "%s: connection failed\n", path);
+        return 1;
+    }
+
+    total = connections * requests;
+    qsort(latencies, total, sizeof(double), CompareDoubles);
+    printf("%lu requests on %lu connections, %lu in flight on each: "
+                "%.0f requests/s\n", (unsigned long)total, connections, depth,
+                                                            total / elapsed);
+    printf("latency p50 %.1f us, p99 %.1f us, p999 %.1f us, max %.1f us\n",
+                    Percentile(latencies, total, 0.5) * 1e6,
+                    Percentile(latencies, total, 0.99) * 1e6,
+                    Percentile(latencies, total, 0.999) * 1e6,
+                                                latencies[total - 1] * 1e6);
+    printf("%lu wrong responses\n", (unsigned long)wrong);
+
+    for(i = 0; i < workload.count; ++i)
+    {
+        free(workload.exprs[i]);
+    }
+    free(workload.exprs);
+    free(workload.lens);
+    free(workload.results);
+    free(workload.statuses);
+    free(clients);
+    free(latencies);
+
+    return 0 != wrong;
+}